@@ -0,0 +1,172 @@
+// Aggregate Ascon-AEAD128 decrypt throughput of the multi-buffer API against
+// one packet at a time, as a collector receiving from many senders (one key
+// each) would see it:
+//   ascon_batch_bench [-n packets] [-o file.csv]
+// The baseline is ascon_aead128_decrypt(), i.e. ascon-c through
+// ascon_wrapper.c, when the submodule is checked out (ASCON_BATCH_ASCONC),
+// and the incremental sponge otherwise; the sponge column is always there.
+// Rows: fixed payload sizes, then "mixed" with random sizes up to 1400 bytes
+// so the scheduler has to group packets by length.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "ascon/aead_batch.h"
+
+#define MAX_PAYLOAD 1400
+#define AD_LEN 8
+#define MIN_NS 200000000ull
+
+typedef struct {
+    uint8_t key[ASCON_AEAD_KEY_LEN], nonce[ASCON_AEAD_NONCE_LEN], ad[AD_LEN];
+    uint8_t ct[MAX_PAYLOAD + ASCON_AEAD_TAG_LEN], pt[MAX_PAYLOAD];
+    size_t ctlen;
+} packet_t;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static void make_packets(packet_t* pk, size_t n, size_t len)
+{
+    for (size_t i = 0; i < n; ++i) {
+        size_t mlen = len ? len : (size_t)rand() % (MAX_PAYLOAD + 1);
+        for (size_t b = 0; b < sizeof(pk[i].key); ++b) pk[i].key[b] = (uint8_t)rand();
+        memset(pk[i].nonce, 0, sizeof(pk[i].nonce));
+        pk[i].nonce[7] = (uint8_t)i;
+        memcpy(pk[i].ad, pk[i].nonce, AD_LEN);
+        for (size_t b = 0; b < mlen; ++b) pk[i].pt[b] = (uint8_t)rand();
+        ascon_aead128_state_t s;
+        ascon_aead128_start(&s, pk[i].nonce, pk[i].key);
+        ascon_aead128_update_ad(&s, pk[i].ad, AD_LEN);
+        ascon_aead128_encrypt_update(&s, pk[i].ct, pk[i].pt, mlen);
+        ascon_aead128_finish(&s, pk[i].ct + mlen);
+        pk[i].ctlen = mlen + ASCON_AEAD_TAG_LEN;
+    }
+}
+
+static int decrypt_single(packet_t* pk, size_t n)
+{
+    int bad = 0;
+    for (size_t i = 0; i < n; ++i) {
+        size_t mlen = pk[i].ctlen - ASCON_AEAD_TAG_LEN;
+        uint8_t tag[ASCON_AEAD_TAG_LEN];
+        ascon_aead128_state_t s;
+        ascon_aead128_start(&s, pk[i].nonce, pk[i].key);
+        ascon_aead128_update_ad(&s, pk[i].ad, AD_LEN);
+        ascon_aead128_decrypt_update(&s, pk[i].pt, pk[i].ct, mlen);
+        ascon_aead128_finish(&s, tag);
+        bad += memcmp(tag, pk[i].ct + mlen, sizeof(tag)) != 0;
+    }
+    return bad;
+}
+
+#ifdef ASCON_BATCH_ASCONC
+// What the collector runs today: one ascon-c call per packet
+static int decrypt_asconc(packet_t* pk, size_t n)
+{
+    int bad = 0;
+    for (size_t i = 0; i < n; ++i) {
+        size_t mlen;
+        bad += ascon_aead128_decrypt(pk[i].pt, &mlen, pk[i].ct, pk[i].ctlen,
+                                     pk[i].ad, AD_LEN, pk[i].nonce, pk[i].key) != 0;
+    }
+    return bad;
+}
+#endif
+
+static int decrypt_batch(packet_t* pk, ascon_aead128_job_t* jobs, size_t n)
+{
+    for (size_t i = 0; i < n; ++i) {
+        jobs[i] = (ascon_aead128_job_t){ .out = pk[i].pt, .in = pk[i].ct, .inlen = pk[i].ctlen,
+                                         .ad = pk[i].ad, .adlen = AD_LEN,
+                                         .npub = pk[i].nonce, .k = pk[i].key };
+    }
+    return (int)ascon_aead128_decrypt_batch(jobs, n);
+}
+
+enum { RUN_BASELINE, RUN_SPONGE, RUN_BATCH };
+
+// Nanoseconds per packet, repeating the whole set for at least MIN_NS
+static double run(int which, packet_t* pk, ascon_aead128_job_t* jobs, size_t n, int* bad)
+{
+    uint64_t t0 = now_ns(), t;
+    size_t reps = 0;
+    do {
+        switch (which) {
+#ifdef ASCON_BATCH_ASCONC
+        case RUN_BASELINE: *bad += decrypt_asconc(pk, n); break;
+#endif
+        case RUN_SPONGE: *bad += decrypt_single(pk, n); break;
+        default: *bad += decrypt_batch(pk, jobs, n); break;
+        }
+        ++reps;
+    } while ((t = now_ns()) - t0 < MIN_NS);
+    return (double)(t - t0) / (double)(reps * n);
+}
+
+int main(int argc, char** argv)
+{
+    static const size_t sizes[] = { 16, 64, 256, 1024, MAX_PAYLOAD, 0 };
+    size_t n = 1024;
+    const char* path = NULL;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:o:")) != -1) {
+        switch (opt) {
+        case 'n': n = strtoul(optarg, NULL, 10); break;
+        case 'o': path = optarg; break;
+        default:
+            fprintf(stderr, "usage: %s [-n packets] [-o file.csv]\n", argv[0]);
+            return 2;
+        }
+    }
+    FILE* out = stdout;
+    if (path && !(out = fopen(path, "w"))) {
+        perror(path);
+        return 2;
+    }
+    packet_t* pk = malloc(n * sizeof(*pk));
+    ascon_aead128_job_t* jobs = malloc(n * sizeof(*jobs));
+    if (!pk || !jobs) return 2;
+
+    fprintf(out, "# %zu lanes\n", ascon_aead128_batch_lanes());
+#ifdef ASCON_BATCH_ASCONC
+    fprintf(out, "# baseline: ascon-c %s via ascon_aead128_decrypt()\n", ASCON_BATCH_ASCONC);
+#else
+    fprintf(out, "# baseline: ascon_sponge.c (ascon-c not built)\n");
+#endif
+    fprintf(out, "msg_bytes,packets,baseline_ns_per_packet,sponge_ns_per_packet,batch_ns_per_packet,"
+                 "baseline_mb_per_s,batch_mb_per_s,speedup\n");
+    int bad = 0;
+    srand(1);
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s) {
+        make_packets(pk, n, sizes[s]);
+        size_t bytes = 0;
+        for (size_t i = 0; i < n; ++i) bytes += pk[i].ctlen - ASCON_AEAD_TAG_LEN;
+        double single = run(RUN_SPONGE, pk, jobs, n, &bad);
+#ifdef ASCON_BATCH_ASCONC
+        double baseline = run(RUN_BASELINE, pk, jobs, n, &bad);
+#else
+        double baseline = single;
+#endif
+        double batch = run(RUN_BATCH, pk, jobs, n, &bad);
+        double per_packet = (double)bytes / (double)n;
+        if (sizes[s]) {
+            fprintf(out, "%zu,", sizes[s]);
+        } else {
+            fprintf(out, "mixed,");
+        }
+        fprintf(out, "%zu,%.1f,%.1f,%.1f,%.1f,%.1f,%.2f\n", n, baseline, single, batch,
+                per_packet * 1e3 / baseline, per_packet * 1e3 / batch, baseline / batch);
+    }
+    if (bad) fprintf(out, "# %d packets failed to verify\n", bad);
+    if (out != stdout) fclose(out);
+    free(pk);
+    free(jobs);
+    return bad ? 1 : 0;
+}
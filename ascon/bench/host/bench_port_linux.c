@@ -0,0 +1,87 @@
+// Linux host hooks for aead_bench.c. Heap use is tracked by interposing the
+// allocator, which also catches allocations made inside a shared libmbedcrypto.
+#define _GNU_SOURCE
+#include "aead_bench.h"
+
+#include <malloc.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t n, size_t size);
+void* __libc_realloc(void* p, size_t size);
+void __libc_free(void* p);
+
+static size_t s_in_use;
+static size_t s_mark;
+static size_t s_peak;
+
+static void track_alloc(void* p)
+{
+    if (!p) return;
+    s_in_use += malloc_usable_size(p);
+    if (s_in_use > s_peak) s_peak = s_in_use;
+}
+
+static void track_free(void* p)
+{
+    if (p) s_in_use -= malloc_usable_size(p);
+}
+
+void* malloc(size_t size)
+{
+    void* p = __libc_malloc(size);
+    track_alloc(p);
+    return p;
+}
+
+void* calloc(size_t n, size_t size)
+{
+    void* p = __libc_calloc(n, size);
+    track_alloc(p);
+    return p;
+}
+
+void* realloc(void* old, size_t size)
+{
+    track_free(old);
+    void* p = __libc_realloc(old, size);
+    track_alloc(p ? p : (size ? old : NULL));
+    return p;
+}
+
+void free(void* p)
+{
+    track_free(p);
+    __libc_free(p);
+}
+
+uint64_t bench_time_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+// TSC ticks on x86 (constant rate, close to but not always the core clock)
+uint64_t bench_cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+void bench_heap_mark(void)
+{
+    s_mark = s_in_use;
+    s_peak = s_in_use;
+}
+
+size_t bench_heap_peak(void)
+{
+    return s_peak - s_mark;
+}
@@ -0,0 +1,43 @@
+// Linux host build of the AEAD and hash benchmarks:
+//   aead_bench [-t aead|hash] [-o file.csv] [-p provider] [-n max_payload]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "aead_bench.h"
+#include "hash_bench.h"
+
+int main(int argc, char** argv)
+{
+    const char* filter = NULL;
+    const char* path = NULL;
+    const char* type = "aead";
+    size_t max_payload = 65536;
+    int opt;
+    while ((opt = getopt(argc, argv, "t:o:p:n:")) != -1) {
+        switch (opt) {
+        case 't': type = optarg; break;
+        case 'o': path = optarg; break;
+        case 'p': filter = optarg; break;
+        case 'n': max_payload = strtoul(optarg, NULL, 10); break;
+        default:
+            fprintf(stderr, "usage: %s [-t aead|hash] [-o file.csv] [-p provider] [-n max_payload]\n",
+                    argv[0]);
+            return 2;
+        }
+    }
+    if (strcmp(type, "aead") != 0 && strcmp(type, "hash") != 0) {
+        fprintf(stderr, "unknown benchmark type %s\n", type);
+        return 2;
+    }
+    FILE* out = stdout;
+    if (path && !(out = fopen(path, "w"))) {
+        perror(path);
+        return 2;
+    }
+    int ret = strcmp(type, "hash") == 0 ? hash_bench_run(out, filter, max_payload)
+                                        : aead_bench_run(out, filter, max_payload);
+    if (out != stdout) fclose(out);
+    return ret == 0 ? 0 : 1;
+}
@@ -0,0 +1,219 @@
+#include "aead_bench.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "crypto_aead/crypto_aead.h"
+
+// Sweep. AD sizes are crossed with every payload size.
+static const size_t s_payload_sizes[] = { 0, 16, 64, 256, 1024, 4096, 16384, 65536 };
+static const size_t s_ad_sizes[] = { 0, 16, 64, 256 };
+
+// Each measurement processes about this many bytes, with at least MIN_REPS
+// and at most MAX_REPS operations
+#define BYTES_PER_RUN  (256 * 1024)
+#define MIN_REPS       8
+#define MAX_REPS       2000
+#define KEY_SETUP_REPS 200
+
+// Stack use is measured by painting STACK_PROBE bytes below the caller's
+// frame and checking how deep one operation overwrote it
+#define STACK_PROBE 8192
+#define STACK_PAINT 0xA5
+
+typedef struct {
+    const aead_provider_t* p;
+    aead_ctx_t ctx;
+    uint8_t nonce[AEAD_MAX_NONCE_LEN];
+    uint8_t* m;
+    uint8_t* c;
+    uint8_t* out;
+    uint8_t* ad;
+    size_t mlen;
+    size_t adlen;
+    size_t clen;
+} bench_op_t;
+
+typedef struct {
+    uint64_t ns;
+    uint64_t cycles;
+    unsigned reps;
+    size_t stack;
+    size_t heap;
+} bench_result_t;
+
+typedef int (*bench_fn_t)(bench_op_t* op);
+
+static int op_encrypt(bench_op_t* op)
+{
+    return aead_ctx_encrypt(&op->ctx, op->c, &op->clen, op->m, op->mlen,
+                            op->ad, op->adlen, op->nonce);
+}
+
+static int op_decrypt(bench_op_t* op)
+{
+    size_t mlen = 0;
+    return aead_ctx_decrypt(&op->ctx, op->out, &mlen, op->c, op->clen,
+                            op->ad, op->adlen, op->nonce);
+}
+
+static const uint8_t s_key[AEAD_MAX_KEY_LEN] = {
+    0x00,0x01,0x02,0x03, 0x04,0x05,0x06,0x07, 0x08,0x09,0x0A,0x0B, 0x0C,0x0D,0x0E,0x0F,
+    0x10,0x11,0x12,0x13, 0x14,0x15,0x16,0x17, 0x18,0x19,0x1A,0x1B, 0x1C,0x1D,0x1E,0x1F,
+};
+
+static int op_key_setup(bench_op_t* op)
+{
+    aead_ctx_t ctx;
+    int ret = aead_ctx_init_with(&ctx, op->p, s_key);
+    if (ret == 0) aead_ctx_free(&ctx);
+    return ret;
+}
+
+static uintptr_t s_probe;    // lowest painted address
+
+// Paints STACK_PROBE bytes just below the caller's frame
+static __attribute__((noinline)) void stack_paint(void)
+{
+    volatile uint8_t probe[STACK_PROBE];
+    for (size_t i = 0; i < sizeof(probe); ++i) probe[i] = STACK_PAINT;
+    s_probe = (uintptr_t)probe;
+}
+
+// Depth of the deepest overwritten byte of the painted area. The stack grows
+// down on both platforms, so untouched paint is at the low end. The area is
+// scanned by address: the caller's stack pointer may differ by a few bytes
+// from when it was painted.
+static __attribute__((noinline)) size_t stack_used(void)
+{
+    const volatile uint8_t* probe = (const volatile uint8_t*)s_probe;
+    size_t untouched = 0;
+    while (untouched < STACK_PROBE && probe[untouched] == STACK_PAINT) untouched++;
+    return STACK_PROBE - untouched;
+}
+
+static int measure(bench_op_t* op, bench_fn_t fn, unsigned reps, bench_result_t* res)
+{
+    // One instrumented call for memory, then the timed loop
+    bench_heap_mark();
+    stack_paint();
+    int ret = fn(op);
+    res->stack = stack_used();
+    res->heap = bench_heap_peak();
+    if (ret != 0) return ret;
+
+    uint64_t c0 = bench_cycles();
+    uint64_t t0 = bench_time_ns();
+    for (unsigned i = 0; i < reps && ret == 0; ++i) {
+        ret = fn(op);
+    }
+    res->ns = bench_time_ns() - t0;
+    res->cycles = bench_cycles() - c0;
+    res->reps = reps;
+    return ret;
+}
+
+static void print_row(FILE* out, const char* provider, const char* op,
+                      size_t mlen, size_t adlen, const bench_result_t* r)
+{
+    double ns_per_op = (double)r->ns / r->reps;
+    double cycles_per_op = (double)r->cycles / r->reps;
+    fprintf(out, "%s,%s,%u,%u,%u,%.3f,%.1f,",
+            provider, op, (unsigned)mlen, (unsigned)adlen, r->reps,
+            ns_per_op / 1000.0, ns_per_op > 0 ? 1e9 / ns_per_op : 0.0);
+    if (r->cycles) {
+        fprintf(out, "%.0f,", cycles_per_op);
+        if (mlen + adlen) {
+            fprintf(out, "%.2f", cycles_per_op / (double)(mlen + adlen));
+        }
+    } else {
+        fputc(',', out);
+    }
+    fprintf(out, ",%u,%u\n", (unsigned)r->stack, (unsigned)r->heap);
+}
+
+static unsigned reps_for(size_t bytes)
+{
+    size_t reps = BYTES_PER_RUN / (bytes + 1);
+    if (reps < MIN_REPS) reps = MIN_REPS;
+    if (reps > MAX_REPS) reps = MAX_REPS;
+    return (unsigned)reps;
+}
+
+static int bench_provider(FILE* out, bench_op_t* op, size_t max_payload)
+{
+    const aead_provider_t* p = op->p;
+    bench_result_t r;
+    int ret = measure(op, op_key_setup, KEY_SETUP_REPS, &r);
+    if (ret != 0) {
+        fprintf(out, "# %s: key setup failed (%d)\n", p->name, ret);
+        return -1;
+    }
+    print_row(out, p->name, "key_setup", 0, 0, &r);
+
+    if (aead_ctx_init_with(&op->ctx, p, s_key) != 0) return -1;
+    for (size_t i = 0; i < sizeof(s_payload_sizes) / sizeof(s_payload_sizes[0]); ++i) {
+        if (s_payload_sizes[i] > max_payload) break;
+        for (size_t j = 0; j < sizeof(s_ad_sizes) / sizeof(s_ad_sizes[0]); ++j) {
+            op->mlen = s_payload_sizes[i];
+            op->adlen = s_ad_sizes[j];
+            unsigned reps = reps_for(op->mlen + op->adlen);
+
+            ret = measure(op, op_encrypt, reps, &r);
+            if (ret != 0) break;
+            print_row(out, p->name, "encrypt", op->mlen, op->adlen, &r);
+
+            ret = measure(op, op_decrypt, reps, &r);
+            if (ret != 0 || memcmp(op->out, op->m, op->mlen) != 0) {
+                ret = -1;
+                break;
+            }
+            print_row(out, p->name, "decrypt", op->mlen, op->adlen, &r);
+        }
+        if (ret != 0) break;
+    }
+    aead_ctx_free(&op->ctx);
+    if (ret != 0) {
+        fprintf(out, "# %s: round trip failed at %u bytes, AD %u\n",
+                p->name, (unsigned)op->mlen, (unsigned)op->adlen);
+        return -1;
+    }
+    return 0;
+}
+
+int aead_bench_run(FILE* out, const char* filter, size_t max_payload)
+{
+    static bench_op_t op;
+    size_t ad_max = s_ad_sizes[sizeof(s_ad_sizes) / sizeof(s_ad_sizes[0]) - 1];
+    size_t requested = max_payload;
+    for (;;) {
+        op.m = malloc(max_payload + 1);
+        op.out = malloc(max_payload + 1);
+        op.c = malloc(max_payload + AEAD_MAX_TAG_LEN);
+        op.ad = malloc(ad_max);
+        if (op.m && op.out && op.c && op.ad) break;
+        free(op.m); free(op.out); free(op.c); free(op.ad);
+        if (max_payload < 1024) {
+            fprintf(out, "# cannot allocate benchmark buffers\n");
+            return -1;
+        }
+        max_payload /= 2;
+    }
+    if (max_payload < requested) {
+        fprintf(out, "# payloads limited to %u bytes by free heap\n", (unsigned)max_payload);
+    }
+    for (size_t i = 0; i < max_payload; ++i) op.m[i] = (uint8_t)(i * 31 + 7);
+    for (size_t i = 0; i < ad_max; ++i) op.ad[i] = (uint8_t)(i ^ 0x5A);
+    for (size_t i = 0; i < sizeof(op.nonce); ++i) op.nonce[i] = (uint8_t)i;
+
+    fprintf(out, "provider,op,msg_bytes,ad_bytes,reps,us_per_op,ops_per_s,"
+                 "cycles_per_op,cycles_per_byte,stack_bytes,heap_bytes\n");
+    int ret = 0;
+    for (size_t i = 0; i < aead_provider_count(); ++i) {
+        op.p = aead_provider_at(i);
+        if (filter && !strstr(op.p->name, filter)) continue;
+        if (bench_provider(out, &op, max_payload) != 0) ret = -1;
+    }
+    free(op.m); free(op.out); free(op.c); free(op.ad);
+    return ret;
+}
@@ -0,0 +1,19 @@
+// Cross-provider AEAD benchmark, shared by the ESP32 app and the Linux host build
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// Platform hooks: bench_port_esp.c on the target, host/bench_port_linux.c on Linux
+uint64_t bench_time_ns(void);
+uint64_t bench_cycles(void);        // CPU cycles, or 0 without a cycle source
+void bench_heap_mark(void);         // starts a heap measurement window
+size_t bench_heap_peak(void);       // peak heap use above the mark, in bytes
+
+// Sweeps every compiled-in provider whose name contains filter (NULL: all)
+// over the payload and AD sizes and writes one CSV row per measurement to out.
+// Payloads larger than max_payload are skipped. Returns 0, or -1 if a
+// provider failed a round trip or buffers could not be allocated.
+int aead_bench_run(FILE* out, const char* filter, size_t max_payload);
@@ -0,0 +1,33 @@
+#include "aead_bench.h"
+
+#include "sdkconfig.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+
+static size_t s_free_at_mark;
+
+uint64_t bench_time_ns(void)
+{
+    return (uint64_t)esp_timer_get_time() * 1000;
+}
+
+// The CPU clock is fixed while the benchmark runs, so elapsed cycles follow
+// from the microsecond timer without the 32-bit CCOUNT wrapping every ~18 s
+uint64_t bench_cycles(void)
+{
+    return (uint64_t)esp_timer_get_time() * CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ;
+}
+
+// Needs ESP-IDF v5.3+ for the local minimum free size monitor
+void bench_heap_mark(void)
+{
+    heap_caps_monitor_local_minimum_free_size_stop();
+    heap_caps_monitor_local_minimum_free_size_start();
+    s_free_at_mark = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+}
+
+size_t bench_heap_peak(void)
+{
+    size_t min_free = heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT);
+    return s_free_at_mark > min_free ? s_free_at_mark - min_free : 0;
+}
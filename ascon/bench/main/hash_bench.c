@@ -0,0 +1,116 @@
+#include "hash_bench.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "crypto_hash/crypto_hash.h"
+#ifdef ESP_PLATFORM
+#include "crypto_hash/hash_partition.h"
+#endif
+
+static const size_t s_sizes[] = { 0, 16, 64, 256, 1024, 4096, 16384, 65536 };
+
+// Each measurement processes about this many bytes, with at least MIN_REPS
+// and at most MAX_REPS operations
+#define BYTES_PER_RUN (256 * 1024)
+#define MIN_REPS      8
+#define MAX_REPS      2000
+
+static const uint8_t s_key[HASH_MAX_KEY_LEN] = {
+    0x00,0x01,0x02,0x03, 0x04,0x05,0x06,0x07, 0x08,0x09,0x0A,0x0B, 0x0C,0x0D,0x0E,0x0F,
+};
+
+static unsigned reps_for(size_t bytes)
+{
+    size_t reps = BYTES_PER_RUN / (bytes + 1);
+    if (reps < MIN_REPS) reps = MIN_REPS;
+    if (reps > MAX_REPS) reps = MAX_REPS;
+    return (unsigned)reps;
+}
+
+static void print_row(FILE* out, const char* provider, const char* op, size_t len,
+                      unsigned reps, uint64_t ns, uint64_t cycles)
+{
+    double ns_per_op = (double)ns / reps;
+    fprintf(out, "%s,%s,%u,%u,%.3f,%.3f,", provider, op, (unsigned)len, reps,
+            ns_per_op / 1000.0, ns_per_op > 0 ? (double)len * 1000.0 / ns_per_op : 0.0);
+    if (cycles) {
+        double cycles_per_op = (double)cycles / reps;
+        fprintf(out, "%.0f,", cycles_per_op);
+        if (len) fprintf(out, "%.2f", cycles_per_op / (double)len);
+    } else {
+        fputc(',', out);
+    }
+    fputc('\n', out);
+}
+
+static void print_header(FILE* out)
+{
+    fprintf(out, "provider,op,msg_bytes,reps,us_per_op,mb_per_s,cycles_per_op,cycles_per_byte\n");
+}
+
+int hash_bench_run(FILE* out, const char* filter, size_t max_payload)
+{
+    uint8_t digest[HASH_MAX_DIGEST_LEN];
+    uint8_t* m;
+    while (!(m = malloc(max_payload + 1))) {
+        if (max_payload < 1024) {
+            fprintf(out, "# cannot allocate benchmark buffer\n");
+            return -1;
+        }
+        max_payload /= 2;
+    }
+    for (size_t i = 0; i < max_payload; ++i) m[i] = (uint8_t)(i * 31 + 7);
+
+    print_header(out);
+    int ret = 0;
+    for (size_t i = 0; i < hash_provider_count(); ++i) {
+        const hash_provider_t* p = hash_provider_at(i);
+        if (filter && !strstr(p->name, filter)) continue;
+        for (size_t j = 0; j < sizeof(s_sizes) / sizeof(s_sizes[0]); ++j) {
+            size_t len = s_sizes[j];
+            if (len > max_payload) break;
+            unsigned reps = reps_for(len);
+            int err = 0;
+            uint64_t c0 = bench_cycles();
+            uint64_t t0 = bench_time_ns();
+            for (unsigned r = 0; r < reps && err == 0; ++r) {
+                err = hash_compute(p, s_key, m, len, digest, p->digest_len);
+            }
+            uint64_t ns = bench_time_ns() - t0;
+            uint64_t cycles = bench_cycles() - c0;
+            if (err != 0) {
+                fprintf(out, "# %s: failed at %u bytes (%d)\n", p->name, (unsigned)len, err);
+                ret = -1;
+                break;
+            }
+            print_row(out, p->name, "digest", len, reps, ns, cycles);
+        }
+    }
+    free(m);
+    return ret;
+}
+
+#ifdef ESP_PLATFORM
+int hash_bench_partition(FILE* out, const esp_partition_t* part)
+{
+    uint8_t digest[HASH_MAX_DIGEST_LEN];
+    print_header(out);
+    int ret = 0;
+    for (size_t i = 0; i < hash_provider_count(); ++i) {
+        const hash_provider_t* p = hash_provider_at(i);
+        uint64_t c0 = bench_cycles();
+        uint64_t t0 = bench_time_ns();
+        esp_err_t err = hash_partition(p, s_key, part, digest, p->digest_len);
+        uint64_t ns = bench_time_ns() - t0;
+        uint64_t cycles = bench_cycles() - c0;
+        if (err != ESP_OK) {
+            fprintf(out, "# %s: partition %s failed (%s)\n", p->name, part->label, esp_err_to_name(err));
+            ret = -1;
+            continue;
+        }
+        print_row(out, p->name, "partition", part->size, 1, ns, cycles);
+    }
+    return ret;
+}
+#endif
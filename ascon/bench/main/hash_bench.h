@@ -0,0 +1,23 @@
+// Hash benchmark over the crypto_hash providers, shared by the ESP32 app and
+// the Linux host build. Uses the platform hooks declared in aead_bench.h.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdio.h>
+
+#include "aead_bench.h"
+
+// Hashes messages of every size up to max_payload with each compiled-in
+// provider whose name contains filter (NULL: all) and writes one CSV row per
+// measurement to out. Returns 0, or -1 if buffers could not be allocated or a
+// provider failed.
+int hash_bench_run(FILE* out, const char* filter, size_t max_payload);
+
+#ifdef ESP_PLATFORM
+#include "esp_partition.h"
+
+// Hashes the whole of part through the flash cache with each provider, as a
+// firmware fingerprint would, and writes one CSV row per provider
+int hash_bench_partition(FILE* out, const esp_partition_t* part);
+#endif
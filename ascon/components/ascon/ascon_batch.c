@@ -0,0 +1,352 @@
+// Multi-buffer Ascon-AEAD128: the permutation of ascon_permutation.h on GCC
+// vector types, one message per lane. The compiler maps the vectors to AVX2,
+// AVX-512F, SSE2 or NEON registers (plain 64-bit operations elsewhere); with
+// AVX-512F the rotations become single vprorq instructions.
+
+#include <stdlib.h>
+#include <string.h>
+#include "ascon/aead_batch.h"
+#include "ascon_permutation.h"
+
+#define ASCON_AEAD128_IV 0x00001000808c0001ull
+#define ASCON_RATE 16
+#define ASCON_PA 12
+#define ASCON_PB 8
+
+// Lanes per permutation call: as many as the vector registers hold without
+// spilling the ten state vectors and temporaries (eight 64-bit lanes as four
+// AVX2 or two NEON vectors per word are slower than fewer lanes)
+#if defined(__AVX512F__)
+#define LANES 8
+#elif defined(__AVX2__)
+#define LANES 4
+#else
+#define LANES 2
+#endif
+
+// Jobs sorted by length at a time
+#define WINDOW 256
+
+typedef uint64_t lanes_t __attribute__((vector_size(8 * LANES)));
+
+// One 64-bit word per lane, as a vector or one lane at a time
+typedef union {
+    lanes_t v;
+    uint64_t w[LANES];
+} words_t;
+
+// LANES states, word-major: x[j][i] is word j of lane i
+typedef struct {
+    lanes_t x[5];
+    words_t k[2];
+} batch_state_t;
+
+typedef struct {
+    ascon_aead128_job_t* job;
+    size_t ad_blocks;   // AD blocks including the padded last one (0 without AD)
+    size_t msg_blocks;  // full message blocks
+} slot_t;
+
+// A macro rather than a function: without AVX, GCC warns about passing
+// 32-byte vectors by value (-Wpsabi)
+#define ror_lanes(x, n) ((x) >> (n) | (x) << (64 - (n)))
+
+// The last `rounds` rounds of Ascon-p[12] on all lanes
+static inline void permute_lanes(lanes_t s[5], int rounds)
+{
+    lanes_t x0 = s[0], x1 = s[1], x2 = s[2], x3 = s[3], x4 = s[4];
+    for (int r = 12 - rounds; r < 12; ++r) {
+        x2 ^= (uint64_t)(((0xf - r) << 4) | r);
+        x0 ^= x4; x4 ^= x3; x2 ^= x1;
+        lanes_t t0 = ~x0 & x1, t1 = ~x1 & x2, t2 = ~x2 & x3, t3 = ~x3 & x4, t4 = ~x4 & x0;
+        x0 ^= t1; x1 ^= t2; x2 ^= t3; x3 ^= t4; x4 ^= t0;
+        x1 ^= x0; x0 ^= x4; x3 ^= x2; x2 = ~x2;
+        x0 ^= ror_lanes(x0, 19) ^ ror_lanes(x0, 28);
+        x1 ^= ror_lanes(x1, 61) ^ ror_lanes(x1, 39);
+        x2 ^= ror_lanes(x2, 1) ^ ror_lanes(x2, 6);
+        x3 ^= ror_lanes(x3, 10) ^ ror_lanes(x3, 17);
+        x4 ^= ror_lanes(x4, 7) ^ ror_lanes(x4, 41);
+    }
+    s[0] = x0; s[1] = x1; s[2] = x2; s[3] = x3; s[4] = x4;
+}
+
+static size_t msg_len(const ascon_aead128_job_t* j, int decrypt)
+{
+    return decrypt ? j->inlen - ASCON_AEAD_TAG_LEN : j->inlen;
+}
+
+static uint64_t low_bytes(size_t n)
+{
+    return n >= 8 ? ~(uint64_t)0 : ((uint64_t)1 << (8 * n)) - 1;
+}
+
+// The last, partial block (len < ASCON_RATE) of p, padded
+static void load_tail(uint64_t* w0, uint64_t* w1, const uint8_t* p, size_t len)
+{
+    size_t n0 = len < 8 ? len : 8;
+    uint64_t w[2] = { ascon_load64(p, n0), ascon_load64(p + n0, len - n0) };
+    w[len / 8] ^= (uint64_t)0x01 << (8 * (len % 8));
+    *w0 = w[0];
+    *w1 = w[1];
+}
+
+static void encrypt_tail(batch_state_t* s, size_t i, uint8_t* c, const uint8_t* m, size_t len)
+{
+    size_t n0 = len < 8 ? len : 8;
+    uint64_t w0 = s->x[0][i] ^ ascon_load64(m, n0);
+    uint64_t w1 = s->x[1][i] ^ ascon_load64(m + n0, len - n0);
+    ascon_store64(c, w0, n0);
+    ascon_store64(c + n0, w1, len - n0);
+    s->x[0][i] = w0;
+    s->x[1][i] = w1;
+    s->x[len / 8][i] ^= (uint64_t)0x01 << (8 * (len % 8));
+}
+
+static void decrypt_tail(batch_state_t* s, size_t i, uint8_t* m, const uint8_t* c, size_t len)
+{
+    size_t n0 = len < 8 ? len : 8;
+    uint64_t c0 = ascon_load64(c, n0);
+    uint64_t c1 = ascon_load64(c + n0, len - n0);
+    uint64_t w0 = s->x[0][i], w1 = s->x[1][i];
+    ascon_store64(m, w0 ^ c0, n0);
+    ascon_store64(m + n0, w1 ^ c1, len - n0);
+    s->x[0][i] = (w0 & ~low_bytes(n0)) | c0;
+    s->x[1][i] = (w1 & ~low_bytes(len - n0)) | c1;
+    s->x[len / 8][i] ^= (uint64_t)0x01 << (8 * (len % 8));
+}
+
+static int verify_tag(const uint8_t* expected, const uint8_t* tag)
+{
+    uint8_t diff = 0;
+    for (size_t i = 0; i < ASCON_AEAD_TAG_LEN; ++i) diff |= expected[i] ^ tag[i];
+    return diff ? -1 : 0;
+}
+
+// Step of a group in which every lane absorbs a full message block: the
+// common case, without masks
+static inline void message_step(lanes_t x[5], const uint8_t* in[LANES], uint8_t* out[LANES],
+                                size_t n, int decrypt)
+{
+    words_t m0 = { 0 }, m1 = { 0 }, o0, o1;
+    for (size_t i = 0; i < n; ++i) {
+        m0.w[i] = ascon_load64(in[i], 8);
+        m1.w[i] = ascon_load64(in[i] + 8, 8);
+        in[i] += ASCON_RATE;
+    }
+    o0.v = x[0] ^ m0.v;
+    o1.v = x[1] ^ m1.v;
+    x[0] = decrypt ? m0.v : o0.v;
+    x[1] = decrypt ? m1.v : o1.v;
+    for (size_t i = 0; i < n; ++i) {
+        ascon_store64(out[i], o0.w[i], 8);
+        ascon_store64(out[i] + 8, o1.w[i], 8);
+        out[i] += ASCON_RATE;
+    }
+    permute_lanes(x, ASCON_PB);
+}
+
+// Step t of a group whose lanes are in different phases: absorbing AD,
+// passing from AD to message, in the message, or done and waiting for the
+// others
+static void mixed_step(lanes_t x[5], const slot_t* g, const uint8_t* in[LANES],
+                       uint8_t* out[LANES], size_t n, int decrypt, size_t t)
+{
+    words_t m0 = { 0 }, m1 = { 0 }, keep = { 0 }, replace = { 0 }, dsep = { 0 }, o0, o1;
+    uint8_t* dst[LANES] = { 0 };
+    for (size_t i = 0; i < n; ++i) {
+        const ascon_aead128_job_t* j = g[i].job;
+        size_t ab = g[i].ad_blocks;
+        if (t >= ab + g[i].msg_blocks) {
+            keep.w[i] = ~(uint64_t)0;
+        } else if (t < ab) {
+            size_t off = t * ASCON_RATE;
+            if (t + 1 < ab) {
+                m0.w[i] = ascon_load64(j->ad + off, 8);
+                m1.w[i] = ascon_load64(j->ad + off + 8, 8);
+            } else {
+                load_tail(&m0.w[i], &m1.w[i], j->ad + off, j->adlen - off);
+            }
+        } else {
+            if (t == ab) dsep.w[i] = (uint64_t)1 << 63;
+            m0.w[i] = ascon_load64(in[i], 8);
+            m1.w[i] = ascon_load64(in[i] + 8, 8);
+            replace.w[i] = decrypt ? ~(uint64_t)0 : 0;
+            dst[i] = out[i];
+            in[i] += ASCON_RATE;
+            out[i] += ASCON_RATE;
+        }
+    }
+    // AD and plaintext are absorbed as x ^= w; decryption outputs x ^ c and
+    // sets x = c
+    x[4] ^= dsep.v;
+    o0.v = x[0] ^ m0.v;
+    o1.v = x[1] ^ m1.v;
+    x[0] = (o0.v & ~replace.v) | (m0.v & replace.v);
+    x[1] = (o1.v & ~replace.v) | (m1.v & replace.v);
+    for (size_t i = 0; i < n; ++i) {
+        if (!dst[i]) continue;
+        ascon_store64(dst[i], o0.w[i], 8);
+        ascon_store64(dst[i] + 8, o1.w[i], 8);
+    }
+    lanes_t kept[5];
+    memcpy(kept, x, sizeof(kept));
+    permute_lanes(x, ASCON_PB);
+    for (int w = 0; w < 5; ++w) x[w] = (x[w] & ~keep.v) | (kept[w] & keep.v);
+}
+
+// Runs n <= LANES jobs in lockstep, sorted by ascending block count. All lanes
+// start and finalize together; in between, step t absorbs block t of every
+// lane (AD blocks first, then full message blocks) and permutes. A lane with
+// fewer blocks than the longest keeps its state through the last steps, so
+// lanes need similar, not equal, lengths. Unused lanes compute on zeros and
+// are ignored.
+static void run_lanes(const slot_t* g, size_t n, int decrypt)
+{
+    batch_state_t s;
+    const uint8_t* in[LANES];  // next full message block of each lane
+    uint8_t* out[LANES];
+    size_t ad_max = 0;
+    memset(&s, 0, sizeof(s));
+    for (size_t i = 0; i < n; ++i) {
+        const ascon_aead128_job_t* j = g[i].job;
+        in[i] = j->in;
+        out[i] = j->out;
+        if (g[i].ad_blocks > ad_max) ad_max = g[i].ad_blocks;
+        s.k[0].w[i] = ascon_load64(j->k, 8);
+        s.k[1].w[i] = ascon_load64(j->k + 8, 8);
+        s.x[0][i] = ASCON_AEAD128_IV;
+        s.x[1][i] = s.k[0].w[i];
+        s.x[2][i] = s.k[1].w[i];
+        s.x[3][i] = ascon_load64(j->npub, 8);
+        s.x[4][i] = ascon_load64(j->npub + 8, 8);
+    }
+    permute_lanes(s.x, ASCON_PA);
+    s.x[3] ^= s.k[0].v;
+    s.x[4] ^= s.k[1].v;
+
+    size_t steps = g[n - 1].ad_blocks + g[n - 1].msg_blocks;
+    size_t all_active = g[0].ad_blocks + g[0].msg_blocks;
+    for (size_t t = 0; t < steps; ++t) {
+        if (t > ad_max && t < all_active) {
+            message_step(s.x, in, out, n, decrypt);
+        } else {
+            mixed_step(s.x, g, in, out, n, decrypt, t);
+        }
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+        const ascon_aead128_job_t* j = g[i].job;
+        size_t len = msg_len(j, decrypt) - g[i].msg_blocks * ASCON_RATE;
+        // Lanes without full message blocks have not passed the end of the AD
+        if (g[i].msg_blocks == 0) s.x[4][i] ^= (uint64_t)1 << 63;
+        if (decrypt) {
+            decrypt_tail(&s, i, out[i], in[i], len);
+        } else {
+            encrypt_tail(&s, i, out[i], in[i], len);
+        }
+    }
+    s.x[2] ^= s.k[0].v;
+    s.x[3] ^= s.k[1].v;
+
+    permute_lanes(s.x, ASCON_PA);
+    s.x[3] ^= s.k[0].v;
+    s.x[4] ^= s.k[1].v;
+    for (size_t i = 0; i < n; ++i) {
+        ascon_aead128_job_t* j = g[i].job;
+        size_t mlen = msg_len(j, decrypt);
+        uint8_t tag[ASCON_AEAD_TAG_LEN];
+        ascon_store64(tag, s.x[3][i], 8);
+        ascon_store64(tag + 8, s.x[4][i], 8);
+        if (decrypt) {
+            j->status = verify_tag(tag, j->in + mlen);
+            if (j->status != 0) memset(j->out, 0, mlen);
+        } else {
+            memcpy(j->out + mlen, tag, ASCON_AEAD_TAG_LEN);
+            j->status = 0;
+        }
+    }
+
+    // The states are keyed
+    volatile lanes_t* p = (volatile lanes_t*)&s;
+    for (size_t i = 0; i < sizeof(s) / sizeof(lanes_t); ++i) p[i] = (lanes_t){ 0 };
+}
+
+// A job left alone at the end of a window costs less on the scalar sponge
+// than on a vector with one lane in use
+static void run_one(ascon_aead128_job_t* j, int decrypt)
+{
+    ascon_aead128_state_t s;
+    size_t mlen = msg_len(j, decrypt);
+    uint8_t tag[ASCON_AEAD_TAG_LEN];
+    ascon_aead128_start(&s, j->npub, j->k);
+    ascon_aead128_update_ad(&s, j->ad, j->adlen);
+    if (decrypt) {
+        ascon_aead128_decrypt_update(&s, j->out, j->in, mlen);
+        ascon_aead128_finish(&s, tag);
+        j->status = verify_tag(tag, j->in + mlen);
+        if (j->status != 0) memset(j->out, 0, mlen);
+    } else {
+        ascon_aead128_encrypt_update(&s, j->out, j->in, mlen);
+        ascon_aead128_finish(&s, j->out + mlen);
+        j->status = 0;
+    }
+}
+
+static int blocks_cmp(const void* a, const void* b)
+{
+    const slot_t* x = a;
+    const slot_t* y = b;
+    size_t bx = x->ad_blocks + x->msg_blocks, by = y->ad_blocks + y->msg_blocks;
+    return bx < by ? -1 : bx > by;
+}
+
+// Sorts each window of jobs by block count and runs them LANES at a time, so
+// every group holds jobs of similar length
+static size_t run_batch(ascon_aead128_job_t* jobs, size_t n, int decrypt)
+{
+    size_t failed = 0;
+    slot_t order[WINDOW];
+    for (size_t base = 0; base < n; base += WINDOW) {
+        size_t cnt = n - base < WINDOW ? n - base : WINDOW;
+        size_t used = 0;
+        for (size_t i = 0; i < cnt; ++i) {
+            ascon_aead128_job_t* j = &jobs[base + i];
+            if (decrypt && j->inlen < ASCON_AEAD_TAG_LEN) {
+                j->status = -1;
+                continue;
+            }
+            order[used].job = j;
+            order[used].ad_blocks = j->adlen ? j->adlen / ASCON_RATE + 1 : 0;
+            order[used].msg_blocks = msg_len(j, decrypt) / ASCON_RATE;
+            ++used;
+        }
+        qsort(order, used, sizeof(order[0]), blocks_cmp);
+        for (size_t i = 0; i < used; i += LANES) {
+            size_t g = used - i < LANES ? used - i : LANES;
+            if (g == 1) {
+                run_one(order[i].job, decrypt);
+            } else {
+                run_lanes(&order[i], g, decrypt);
+            }
+        }
+        for (size_t i = 0; i < cnt; ++i) {
+            if (jobs[base + i].status != 0) ++failed;
+        }
+    }
+    return failed;
+}
+
+size_t ascon_aead128_batch_lanes(void)
+{
+    return LANES;
+}
+
+void ascon_aead128_encrypt_batch(ascon_aead128_job_t* jobs, size_t n)
+{
+    run_batch(jobs, n, 0);
+}
+
+size_t ascon_aead128_decrypt_batch(ascon_aead128_job_t* jobs, size_t n)
+{
+    return run_batch(jobs, n, 1);
+}
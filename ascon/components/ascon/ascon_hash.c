@@ -0,0 +1,139 @@
+// Ascon-Hash256, Ascon-XOF128 and Ascon-CXOF128 (NIST SP 800-232) on the
+// portable permutation: 64-bit rate, 12 rounds between all blocks.
+
+#include "ascon/hash.h"
+#include "ascon_permutation.h"
+
+#define ASCON_HASH256_IV 0x0000080100cc0002ull
+#define ASCON_XOF128_IV 0x0000080000cc0003ull
+#define ASCON_CXOF128_IV 0x0000080000cc0004ull
+#define ASCON_HASH_RATE 8
+#define ASCON_PA 12
+
+static void start(ascon_hash_state_t* s, uint64_t iv)
+{
+    s->x[0] = iv;
+    s->x[1] = s->x[2] = s->x[3] = s->x[4] = 0;
+    ascon_permute(s->x, ASCON_PA);
+    s->pos = 0;
+    s->squeezing = 0;
+}
+
+// Pads the last block of the input absorbed so far and permutes, as at the
+// end of the customization string and of the message
+static void pad(ascon_hash_state_t* s)
+{
+    s->x[0] ^= (uint64_t)0x01 << (8 * s->pos);
+    ascon_permute(s->x, ASCON_PA);
+    s->pos = 0;
+}
+
+void ascon_hash256_start(ascon_hash_state_t* s)
+{
+    start(s, ASCON_HASH256_IV);
+}
+
+void ascon_xof128_start(ascon_hash_state_t* s)
+{
+    start(s, ASCON_XOF128_IV);
+}
+
+int ascon_cxof128_start(ascon_hash_state_t* s, const uint8_t* z, size_t zlen)
+{
+    if (zlen > ASCON_CXOF128_MAX_Z) return -1;
+    start(s, ASCON_CXOF128_IV);
+    // The length of Z in bits is a block of its own, then Z padded
+    s->x[0] ^= (uint64_t)zlen * 8;
+    ascon_permute(s->x, ASCON_PA);
+    ascon_hash_update(s, z, zlen);
+    pad(s);
+    return 0;
+}
+
+void ascon_hash_update(ascon_hash_state_t* s, const uint8_t* in, size_t len)
+{
+    if (s->squeezing) return;
+    while (len) {
+        if (s->pos == 0 && len >= ASCON_HASH_RATE) {
+            s->x[0] ^= ascon_load64(in, 8);
+            in += ASCON_HASH_RATE;
+            len -= ASCON_HASH_RATE;
+        } else {
+            s->x[0] ^= (uint64_t)*in++ << (8 * s->pos);
+            --len;
+            if (++s->pos < ASCON_HASH_RATE) continue;
+        }
+        ascon_permute(s->x, ASCON_PA);
+        s->pos = 0;
+    }
+}
+
+void ascon_hash_squeeze(ascon_hash_state_t* s, uint8_t* out, size_t len)
+{
+    if (!s->squeezing) {
+        pad(s);
+        s->squeezing = 1;
+    }
+    while (len) {
+        if (s->pos == ASCON_HASH_RATE) {
+            ascon_permute(s->x, ASCON_PA);
+            s->pos = 0;
+        }
+        if (s->pos == 0 && len >= ASCON_HASH_RATE) {
+            ascon_store64(out, s->x[0], 8);
+            out += ASCON_HASH_RATE;
+            len -= ASCON_HASH_RATE;
+            s->pos = ASCON_HASH_RATE;
+        } else {
+            *out++ = (uint8_t)(s->x[0] >> (8 * s->pos++));
+            --len;
+        }
+    }
+}
+
+void ascon_hash_wipe(ascon_hash_state_t* s)
+{
+    volatile uint8_t* p = (volatile uint8_t*)s;
+    for (size_t i = 0; i < sizeof(*s); ++i) p[i] = 0;
+}
+
+void ascon_hash256(uint8_t* out, const uint8_t* in, size_t len)
+{
+    ascon_hash_state_t s;
+    ascon_hash256_start(&s);
+    ascon_hash_update(&s, in, len);
+    ascon_hash_squeeze(&s, out, ASCON_HASH256_LEN);
+}
+
+void ascon_xof128(uint8_t* out, size_t outlen, const uint8_t* in, size_t len)
+{
+    ascon_hash_state_t s;
+    ascon_xof128_start(&s);
+    ascon_hash_update(&s, in, len);
+    ascon_hash_squeeze(&s, out, outlen);
+}
+
+void ascon_prf_start(ascon_hash_state_t* s, const uint8_t* key)
+{
+    ascon_cxof128_start(s, key, ASCON_PRF_KEY_LEN);
+}
+
+void ascon_mac(uint8_t* tag, const uint8_t* key, const uint8_t* in, size_t len)
+{
+    ascon_hash_state_t s;
+    ascon_prf_start(&s, key);
+    ascon_hash_update(&s, in, len);
+    ascon_hash_squeeze(&s, tag, ASCON_MAC_LEN);
+    ascon_hash_wipe(&s);
+}
+
+int ascon_mac_verify(const uint8_t* tag, const uint8_t* key, const uint8_t* in, size_t len)
+{
+    uint8_t expected[ASCON_MAC_LEN];
+    ascon_mac(expected, key, in, len);
+    uint8_t diff = 0;
+    for (size_t i = 0; i < ASCON_MAC_LEN; ++i) diff |= expected[i] ^ tag[i];
+    volatile uint8_t* p = expected;
+    for (size_t i = 0; i < sizeof(expected); ++i) p[i] = 0;
+    return diff ? -1 : 0;
+}
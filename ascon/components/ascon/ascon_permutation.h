@@ -0,0 +1,63 @@
+// Portable Ascon permutation (NIST SP 800-232) on five 64-bit words, used by
+// the incremental API in ascon_sponge.c. Bytes map to the words little-endian.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+static inline uint64_t ascon_ror(uint64_t x, int n)
+{
+    return x >> n | x << (64 - n);
+}
+
+static inline uint64_t ascon_load64(const uint8_t* p, size_t n)
+{
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    // Full words are one (possibly unaligned) load on little-endian targets
+    if (n == 8) {
+        uint64_t x;
+        memcpy(&x, p, 8);
+        return x;
+    }
+#endif
+    uint64_t x = 0;
+    for (size_t i = 0; i < n; ++i) x |= (uint64_t)p[i] << (8 * i);
+    return x;
+}
+
+static inline void ascon_store64(uint8_t* p, uint64_t x, size_t n)
+{
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    if (n == 8) {
+        memcpy(p, &x, 8);
+        return;
+    }
+#endif
+    for (size_t i = 0; i < n; ++i) p[i] = (uint8_t)(x >> (8 * i));
+}
+
+static inline void ascon_round(uint64_t s[5], uint8_t c)
+{
+    uint64_t x0 = s[0], x1 = s[1], x2 = s[2] ^ c, x3 = s[3], x4 = s[4];
+    // substitution layer (bitsliced 5-bit S-box)
+    x0 ^= x4; x4 ^= x3; x2 ^= x1;
+    uint64_t t0 = ~x0 & x1, t1 = ~x1 & x2, t2 = ~x2 & x3, t3 = ~x3 & x4, t4 = ~x4 & x0;
+    x0 ^= t1; x1 ^= t2; x2 ^= t3; x3 ^= t4; x4 ^= t0;
+    x1 ^= x0; x0 ^= x4; x3 ^= x2; x2 = ~x2;
+    // linear diffusion layer
+    s[0] = x0 ^ ascon_ror(x0, 19) ^ ascon_ror(x0, 28);
+    s[1] = x1 ^ ascon_ror(x1, 61) ^ ascon_ror(x1, 39);
+    s[2] = x2 ^ ascon_ror(x2, 1) ^ ascon_ror(x2, 6);
+    s[3] = x3 ^ ascon_ror(x3, 10) ^ ascon_ror(x3, 17);
+    s[4] = x4 ^ ascon_ror(x4, 7) ^ ascon_ror(x4, 41);
+}
+
+// The last `rounds` rounds of Ascon-p[12]
+static inline void ascon_permute(uint64_t s[5], int rounds)
+{
+    for (int r = 12 - rounds; r < 12; ++r) {
+        ascon_round(s, (uint8_t)(((0xf - r) << 4) | r));
+    }
+}
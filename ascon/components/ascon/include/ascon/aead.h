@@ -1,6 +1,7 @@
 // Ascon-128 AEAD API wrapper for ascon-c library.
-// This header provides a small, stable API used by the apps,
-// implemented by components/ascon/ascon_wrapper.c calling ascon-c.
+// This header provides a small, stable API used by the apps: one-shot
+// functions implemented by components/ascon/ascon_wrapper.c calling ascon-c,
+// and an incremental interface (see below).
 
 #pragma once
 
@@ -20,3 +21,42 @@ int ascon_aead128_decrypt(uint8_t* m, size_t* mlen,
                           const uint8_t* c, size_t clen,
                           const uint8_t* ad, size_t adlen,
                           const uint8_t* npub, const uint8_t* k);
+
+// Incremental Ascon-AEAD128, implemented in ascon_sponge.c on a portable
+// permutation. Same output as the one-shot functions, but the AD and the
+// message may be passed in pieces of any size:
+//
+//   ascon_aead128_start(&s, npub, k);
+//   ascon_aead128_update_ad(&s, ad, adlen);        // zero or more times
+//   ascon_aead128_encrypt_update(&s, c, m, mlen);  // zero or more times
+//   ascon_aead128_finish(&s, tag);                 // wipes s
+//
+// All AD must be passed before the first message byte. Decryption uses
+// ascon_aead128_decrypt_update() and compares the tag from finish() with the
+// received one. c == m is allowed.
+
+enum {
+    ASCON_AEAD128_PHASE_AD,
+    ASCON_AEAD128_PHASE_MSG,
+};
+
+typedef struct {
+    uint64_t x[5];  // permutation state
+    uint64_t k[2];  // key, needed again for finalization
+    uint8_t pos;    // bytes of the current 16-byte rate block already used
+    uint8_t phase;  // ASCON_AEAD128_PHASE_*
+    uint8_t has_ad;
+} ascon_aead128_state_t;
+
+void ascon_aead128_start(ascon_aead128_state_t* s, const uint8_t* npub, const uint8_t* k);
+
+void ascon_aead128_update_ad(ascon_aead128_state_t* s, const uint8_t* ad, size_t adlen);
+
+void ascon_aead128_encrypt_update(ascon_aead128_state_t* s, uint8_t* c,
+                                  const uint8_t* m, size_t mlen);
+
+void ascon_aead128_decrypt_update(ascon_aead128_state_t* s, uint8_t* m,
+                                  const uint8_t* c, size_t clen);
+
+// Writes the ASCON_AEAD_TAG_LEN byte tag
+void ascon_aead128_finish(ascon_aead128_state_t* s, uint8_t* tag);
@@ -0,0 +1,48 @@
+// Multi-buffer Ascon-AEAD128 for hosts that handle many independent packets
+// at once, e.g. a Linux collector receiving from many senders. Implemented in
+// components/ascon/ascon_batch.c; not part of the ESP-IDF component (the
+// ESP32 has no SIMD unit).
+//
+// Each SIMD lane carries one message: word j of the five-word Ascon state of
+// every lane sits in one vector, so the bitsliced permutation runs unchanged
+// on 8 lanes (AVX-512F), 4 lanes (AVX2) or 2 lanes (SSE2, NEON), chosen by the
+// compiler flags of ascon_batch.c. Lanes move in lockstep, so the batch
+// functions sort their jobs by length and run similar lengths together; a
+// lane that runs out of blocks waits for the longest one of its group. Output
+// is identical to ascon_aead128_encrypt()/ascon_aead128_decrypt().
+//
+//   ascon_aead128_job_t jobs[n];                   // one per received packet
+//   jobs[i] = (ascon_aead128_job_t){ .out = pt[i], .in = ct[i], .inlen = ctlen[i],
+//                                    .ad = ad[i], .adlen = adlen[i],
+//                                    .npub = nonce[i], .k = key_of(sender[i]) };
+//   size_t bad = ascon_aead128_decrypt_batch(jobs, n);
+//   // jobs[i].status == 0: pt[i] holds ctlen[i] - ASCON_AEAD_TAG_LEN bytes
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ascon/aead.h"
+
+typedef struct {
+    uint8_t* out;          // ciphertext and tag (encrypt) or plaintext (decrypt); may equal in
+    const uint8_t* in;     // plaintext (encrypt) or ciphertext and tag (decrypt)
+    size_t inlen;
+    const uint8_t* ad;
+    size_t adlen;
+    const uint8_t* npub;   // ASCON_AEAD_NONCE_LEN bytes
+    const uint8_t* k;      // ASCON_AEAD_KEY_LEN bytes
+    int status;            // set by the batch call: 0, or -1 if the tag did not verify
+} ascon_aead128_job_t;
+
+// Number of messages processed per permutation call in this build
+size_t ascon_aead128_batch_lanes(void);
+
+// Encrypts every job: out receives inlen bytes of ciphertext and the tag
+void ascon_aead128_encrypt_batch(ascon_aead128_job_t* jobs, size_t n);
+
+// Decrypts and verifies every job: out receives inlen - ASCON_AEAD_TAG_LEN
+// bytes of plaintext, zeroed if the tag does not verify. Returns the number of
+// jobs that failed.
+size_t ascon_aead128_decrypt_batch(ascon_aead128_job_t* jobs, size_t n);
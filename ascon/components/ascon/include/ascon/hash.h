@@ -0,0 +1,63 @@
+// Ascon-Hash256, Ascon-XOF128 and Ascon-CXOF128 (NIST SP 800-232), and a
+// keyed PRF/MAC built on Ascon-CXOF128, implemented in ascon_hash.c on the
+// same portable permutation as the incremental AEAD.
+//
+//   ascon_hash_state_t s;
+//   ascon_hash256_start(&s);                   // or ascon_xof128_start(), ...
+//   ascon_hash_update(&s, data, len);          // zero or more times
+//   ascon_hash_squeeze(&s, out, 32);           // XOF: any length, any number of calls
+//   ascon_hash_wipe(&s);
+//
+// Ascon-Hash256 output is ASCON_HASH256_LEN bytes; reading more is not
+// Ascon-Hash256. No update() after the first squeeze().
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define ASCON_HASH256_LEN 32
+#define ASCON_CXOF128_MAX_Z 256   // customization string limit, 2048 bits
+#define ASCON_PRF_KEY_LEN 16
+#define ASCON_MAC_LEN 16
+
+typedef struct {
+    uint64_t x[5];      // permutation state
+    uint8_t pos;        // bytes of the current 8-byte rate block already used
+    uint8_t squeezing;
+} ascon_hash_state_t;
+
+void ascon_hash256_start(ascon_hash_state_t* s);
+
+void ascon_xof128_start(ascon_hash_state_t* s);
+
+// Returns nonzero if zlen > ASCON_CXOF128_MAX_Z
+int ascon_cxof128_start(ascon_hash_state_t* s, const uint8_t* z, size_t zlen);
+
+void ascon_hash_update(ascon_hash_state_t* s, const uint8_t* in, size_t len);
+
+void ascon_hash_squeeze(ascon_hash_state_t* s, uint8_t* out, size_t len);
+
+void ascon_hash_wipe(ascon_hash_state_t* s);
+
+// One-shot forms
+void ascon_hash256(uint8_t* out, const uint8_t* in, size_t len);
+
+void ascon_xof128(uint8_t* out, size_t outlen, const uint8_t* in, size_t len);
+
+// Keyed PRF: Ascon-CXOF128 with the ASCON_PRF_KEY_LEN byte key as the
+// customization string, so any SP 800-232 implementation computes it. Output
+// of any length; a MAC is its first ASCON_MAC_LEN bytes.
+//
+// This is a construction of this repo, not a standardized MAC: it does not
+// interoperate with Ascon-Mac/Ascon-Prf of the Ascon v1.2 submission (ascon-c
+// crypto_auth asconmacv13/asconprfv13, rate 256 bits), which SP 800-232 does
+// not include, and it has no published test vectors. Both ends must use this
+// code. Fixed regression vectors are in crypto_hash/test.
+void ascon_prf_start(ascon_hash_state_t* s, const uint8_t* key);
+
+void ascon_mac(uint8_t* tag, const uint8_t* key, const uint8_t* in, size_t len);
+
+// Returns 0 if tag (ASCON_MAC_LEN bytes) is the MAC of in; constant time in
+// the tag contents
+int ascon_mac_verify(const uint8_t* tag, const uint8_t* key, const uint8_t* in, size_t len);
@@ -0,0 +1,136 @@
+#include "crypto_aead/crypto_aead.h"
+#include <string.h>
+
+// Streaming AEAD on the incremental provider interface, and the chunked
+// STREAM construction on top of the one-shot context functions
+
+static void wipe(void* p, size_t n)
+{
+    volatile uint8_t* v = p;
+    while (n--) *v++ = 0;
+}
+
+static void stream_end(aead_stream_t* s)
+{
+    wipe(&s->op, sizeof(s->op));
+    s->active = 0;
+}
+
+int aead_stream_init(aead_stream_t* s, aead_ctx_t* ctx, const uint8_t* npub, int mode)
+{
+    s->ctx = ctx;
+    s->mode = (uint8_t)mode;
+    s->in_msg = 0;
+    s->active = 0;
+    int ret = ctx->provider->start(&ctx->state, &s->op, npub, mode == AEAD_STREAM_DECRYPT);
+    if (ret == 0) s->active = 1;
+    return ret;
+}
+
+int aead_stream_update_ad(aead_stream_t* s, const uint8_t* ad, size_t adlen)
+{
+    if (!s->active || s->in_msg) return -1;
+    if (adlen == 0) return 0;
+    aead_ctx_t* ctx = s->ctx;
+    return ctx->provider->update_ad(&ctx->state, &s->op, ad, adlen);
+}
+
+int aead_stream_update(aead_stream_t* s, uint8_t* out, const uint8_t* in, size_t len)
+{
+    if (!s->active) return -1;
+    s->in_msg = 1;
+    if (len == 0) return 0;
+    aead_ctx_t* ctx = s->ctx;
+    return ctx->provider->update(&ctx->state, &s->op, out, in, len);
+}
+
+int aead_stream_final(aead_stream_t* s, uint8_t* tag)
+{
+    if (!s->active || s->mode != AEAD_STREAM_ENCRYPT) return -1;
+    aead_ctx_t* ctx = s->ctx;
+    int ret = ctx->provider->finish(&ctx->state, &s->op, tag);
+    stream_end(s);
+    return ret;
+}
+
+int aead_stream_verify(aead_stream_t* s, const uint8_t* tag)
+{
+    if (!s->active || s->mode != AEAD_STREAM_DECRYPT) return -1;
+    aead_ctx_t* ctx = s->ctx;
+    uint8_t expected[AEAD_MAX_TAG_LEN];
+    int ret = ctx->provider->finish(&ctx->state, &s->op, expected);
+    if (ret == 0) {
+        uint8_t diff = 0;
+        for (size_t i = 0; i < ctx->provider->tag_len; ++i) diff |= expected[i] ^ tag[i];
+        ret = diff ? -1 : 0;
+    }
+    wipe(expected, sizeof(expected));
+    stream_end(s);
+    return ret;
+}
+
+void aead_stream_abort(aead_stream_t* s)
+{
+    if (s->active && s->ctx->provider->abort) {
+        s->ctx->provider->abort(&s->ctx->state, &s->op);
+    }
+    stream_end(s);
+}
+
+// Chunked STREAM: chunk i is sealed on its own under the nonce
+// prefix | be32(i) | last, so chunks can't be reordered, dropped or
+// truncated at a chunk boundary without a failure
+
+// Sets the nonce of the next chunk. The counter must not wrap, so chunk
+// 2^32 - 1 can only be the last one.
+static int chunk_nonce(aead_chunked_t* cs, int last)
+{
+    if (cs->finished || (!last && cs->counter == UINT32_MAX)) return -1;
+    uint8_t* p = cs->nonce + cs->ctx->provider->nonce_len - AEAD_CHUNK_NONCE_SUFFIX;
+    p[0] = (uint8_t)(cs->counter >> 24);
+    p[1] = (uint8_t)(cs->counter >> 16);
+    p[2] = (uint8_t)(cs->counter >> 8);
+    p[3] = (uint8_t)cs->counter;
+    p[4] = last ? 1 : 0;
+    return 0;
+}
+
+static void chunk_done(aead_chunked_t* cs, int last)
+{
+    if (last) {
+        cs->finished = 1;
+    } else {
+        ++cs->counter;
+    }
+}
+
+int aead_chunked_init(aead_chunked_t* cs, aead_ctx_t* ctx, const uint8_t* prefix)
+{
+    size_t n = ctx->provider->nonce_len;
+    if (n <= AEAD_CHUNK_NONCE_SUFFIX) return -1;
+    cs->ctx = ctx;
+    memcpy(cs->nonce, prefix, n - AEAD_CHUNK_NONCE_SUFFIX);
+    cs->counter = 0;
+    cs->finished = 0;
+    return 0;
+}
+
+int aead_chunked_seal(aead_chunked_t* cs, uint8_t* c, size_t* clen,
+                      const uint8_t* m, size_t mlen,
+                      const uint8_t* ad, size_t adlen, int last)
+{
+    if (chunk_nonce(cs, last) != 0) return -1;
+    int ret = aead_ctx_encrypt(cs->ctx, c, clen, m, mlen, ad, adlen, cs->nonce);
+    if (ret == 0) chunk_done(cs, last);
+    return ret;
+}
+
+int aead_chunked_open(aead_chunked_t* cs, uint8_t* m, size_t* mlen,
+                      const uint8_t* c, size_t clen,
+                      const uint8_t* ad, size_t adlen, int last)
+{
+    if (chunk_nonce(cs, last) != 0) return -1;
+    int ret = aead_ctx_decrypt(cs->ctx, m, mlen, c, clen, ad, adlen, cs->nonce);
+    if (ret == 0) chunk_done(cs, last);
+    return ret;
+}
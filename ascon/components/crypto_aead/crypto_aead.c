@@ -0,0 +1,316 @@
+#include "crypto_aead/crypto_aead.h"
+#include <string.h>
+
+_Static_assert(AEAD_KEY_LEN <= AEAD_MAX_KEY_LEN && AEAD_NONCE_LEN <= AEAD_MAX_NONCE_LEN &&
+               AEAD_TAG_LEN <= AEAD_MAX_TAG_LEN, "AEAD_MAX_* too small");
+
+// Provider descriptors, defined in provider_*.c
+extern const aead_provider_t aead_provider_ascon;
+extern const aead_provider_t aead_provider_aes_gcm;
+extern const aead_provider_t aead_provider_chacha20_poly1305;
+extern const aead_provider_t aead_provider_mock;
+
+#if CONFIG_AEAD_IMPL_ASCON
+  #define AEAD_DEFAULT_PROVIDER aead_provider_ascon
+#elif CONFIG_AEAD_IMPL_AES_GCM
+  #define AEAD_DEFAULT_PROVIDER aead_provider_aes_gcm
+#elif CONFIG_AEAD_IMPL_CHACHA20_POLY1305
+  #define AEAD_DEFAULT_PROVIDER aead_provider_chacha20_poly1305
+#elif CONFIG_AEAD_IMPL_MOCK
+  #define AEAD_DEFAULT_PROVIDER aead_provider_mock
+#endif
+
+static const aead_provider_t* const s_providers[] = {
+#if CONFIG_AEAD_PROVIDER_ASCON
+    &aead_provider_ascon,
+#endif
+#if CONFIG_AEAD_PROVIDER_AES_GCM
+    &aead_provider_aes_gcm,
+#endif
+#if CONFIG_AEAD_PROVIDER_CHACHA20_POLY1305
+    &aead_provider_chacha20_poly1305,
+#endif
+#if CONFIG_AEAD_PROVIDER_MOCK
+    &aead_provider_mock,
+#endif
+};
+
+size_t aead_provider_count(void)
+{
+    return sizeof(s_providers) / sizeof(s_providers[0]);
+}
+
+const aead_provider_t* aead_provider_at(size_t i)
+{
+    return i < aead_provider_count() ? s_providers[i] : NULL;
+}
+
+const aead_provider_t* aead_provider_find(const char* name)
+{
+    for (size_t i = 0; i < aead_provider_count(); ++i) {
+        if (strcmp(s_providers[i]->name, name) == 0) return s_providers[i];
+    }
+    return NULL;
+}
+
+const aead_provider_t* aead_provider_default(void)
+{
+    return &AEAD_DEFAULT_PROVIDER;
+}
+
+int aead_ctx_init_with(aead_ctx_t* ctx, const aead_provider_t* p, const uint8_t* k)
+{
+    if (!p) return -1;
+    ctx->provider = p;
+    return p->init(&ctx->state, k);
+}
+
+int aead_ctx_init(aead_ctx_t* ctx, const uint8_t* k)
+{
+    return aead_ctx_init_with(ctx, &AEAD_DEFAULT_PROVIDER, k);
+}
+
+int aead_ctx_encrypt(aead_ctx_t* ctx, uint8_t* c, size_t* clen,
+                     const uint8_t* m, size_t mlen,
+                     const uint8_t* ad, size_t adlen,
+                     const uint8_t* npub)
+{
+    return ctx->provider->encrypt(&ctx->state, c, clen, m, mlen, ad, adlen, npub);
+}
+
+int aead_ctx_decrypt(aead_ctx_t* ctx, uint8_t* m, size_t* mlen,
+                     const uint8_t* c, size_t clen,
+                     const uint8_t* ad, size_t adlen,
+                     const uint8_t* npub)
+{
+    return ctx->provider->decrypt(&ctx->state, m, mlen, c, clen, ad, adlen, npub);
+}
+
+int aead_ctx_encrypt_inplace(aead_ctx_t* ctx, uint8_t* buf, size_t mlen, size_t* clen,
+                             const uint8_t* ad, size_t adlen,
+                             const uint8_t* npub)
+{
+    return ctx->provider->encrypt(&ctx->state, buf, clen, buf, mlen, ad, adlen, npub);
+}
+
+int aead_ctx_decrypt_inplace(aead_ctx_t* ctx, uint8_t* buf, size_t clen, size_t* mlen,
+                             const uint8_t* ad, size_t adlen,
+                             const uint8_t* npub)
+{
+    int ret = ctx->provider->decrypt(&ctx->state, buf, mlen, buf, clen, ad, adlen, npub);
+    // Some providers decrypt before the tag check; don't leave that behind
+    if (ret != 0 && clen > ctx->provider->tag_len) {
+        memset(buf, 0, clen - ctx->provider->tag_len);
+    }
+    return ret;
+}
+
+// Scatter-gather on top of the incremental provider interface
+
+// Read/write position in an array of segments
+typedef struct {
+    const aead_iov_t* iov;
+    size_t cnt;
+    size_t i;
+    size_t off;
+} iov_cursor_t;
+
+static size_t iov_total(const aead_iov_t* iov, size_t cnt)
+{
+    size_t n = 0;
+    for (size_t i = 0; i < cnt; ++i) n += iov[i].len;
+    return n;
+}
+
+// Contiguous bytes at the cursor, 0 at the end
+static size_t cursor_span(iov_cursor_t* cur, uint8_t** p)
+{
+    while (cur->i < cur->cnt && cur->off == cur->iov[cur->i].len) {
+        ++cur->i;
+        cur->off = 0;
+    }
+    if (cur->i == cur->cnt) return 0;
+    *p = (uint8_t*)cur->iov[cur->i].base + cur->off;
+    return cur->iov[cur->i].len - cur->off;
+}
+
+// Copies len bytes from src to the cursor, or zeroes them if src is NULL
+static void cursor_write(iov_cursor_t* cur, const uint8_t* src, size_t len)
+{
+    while (len) {
+        uint8_t* p = NULL;
+        size_t n = cursor_span(cur, &p);
+        if (n > len) n = len;
+        if (src) {
+            memcpy(p, src, n);
+            src += n;
+        } else {
+            memset(p, 0, n);
+        }
+        cur->off += n;
+        len -= n;
+    }
+}
+
+// Copies len bytes at the cursor to dst, or skips them if dst is NULL
+static void cursor_read(iov_cursor_t* cur, uint8_t* dst, size_t len)
+{
+    while (len) {
+        uint8_t* p = NULL;
+        size_t n = cursor_span(cur, &p);
+        if (n > len) n = len;
+        if (dst) {
+            memcpy(dst, p, n);
+            dst += n;
+        }
+        cur->off += n;
+        len -= n;
+    }
+}
+
+// Runs the stream over len bytes, in the largest pieces that are contiguous
+// in both input and output
+static int cursor_process(aead_stream_t* s, iov_cursor_t* out, iov_cursor_t* in, size_t len)
+{
+    while (len) {
+        uint8_t* o = NULL;
+        uint8_t* i = NULL;
+        size_t n = cursor_span(in, &i);
+        size_t avail = cursor_span(out, &o);
+        if (n > avail) n = avail;
+        if (n > len) n = len;
+        int ret = aead_stream_update(s, o, i, n);
+        if (ret != 0) return ret;
+        in->off += n;
+        out->off += n;
+        len -= n;
+    }
+    return 0;
+}
+
+static int stream_with_ad(aead_stream_t* s, aead_ctx_t* ctx, const uint8_t* npub, int mode,
+                          const aead_iov_t* ad, size_t adcnt)
+{
+    int ret = aead_stream_init(s, ctx, npub, mode);
+    for (size_t i = 0; ret == 0 && i < adcnt; ++i) {
+        ret = aead_stream_update_ad(s, ad[i].base, ad[i].len);
+    }
+    return ret;
+}
+
+int aead_ctx_encrypt_iov(aead_ctx_t* ctx,
+                         const aead_iov_t* c, size_t ccnt, size_t* clen,
+                         const aead_iov_t* m, size_t mcnt,
+                         const aead_iov_t* ad, size_t adcnt,
+                         const uint8_t* npub)
+{
+    size_t tag_len = ctx->provider->tag_len;
+    size_t mlen = iov_total(m, mcnt);
+    if (iov_total(c, ccnt) < mlen + tag_len) return -1;
+
+    aead_stream_t s;
+    uint8_t tag[AEAD_MAX_TAG_LEN];
+    iov_cursor_t in = { m, mcnt, 0, 0 };
+    iov_cursor_t out = { c, ccnt, 0, 0 };
+    int ret = stream_with_ad(&s, ctx, npub, AEAD_STREAM_ENCRYPT, ad, adcnt);
+    if (ret == 0) ret = cursor_process(&s, &out, &in, mlen);
+    if (ret == 0) ret = aead_stream_final(&s, tag);
+    aead_stream_abort(&s);
+    if (ret != 0) return ret;
+    cursor_write(&out, tag, tag_len);
+    if (clen) *clen = mlen + tag_len;
+    return 0;
+}
+
+int aead_ctx_decrypt_iov(aead_ctx_t* ctx,
+                         const aead_iov_t* m, size_t mcnt, size_t* mlen,
+                         const aead_iov_t* c, size_t ccnt,
+                         const aead_iov_t* ad, size_t adcnt,
+                         const uint8_t* npub)
+{
+    size_t tag_len = ctx->provider->tag_len;
+    size_t clen = iov_total(c, ccnt);
+    if (clen < tag_len) return -1;
+    size_t ct_only = clen - tag_len;
+    if (iov_total(m, mcnt) < ct_only) return -1;
+
+    // Take the received tag first: with m == c it is overwritten otherwise
+    uint8_t tag_in[AEAD_MAX_TAG_LEN];
+    iov_cursor_t in = { c, ccnt, 0, 0 };
+    cursor_read(&in, NULL, ct_only);
+    cursor_read(&in, tag_in, tag_len);
+
+    aead_stream_t s;
+    in = (iov_cursor_t){ c, ccnt, 0, 0 };
+    iov_cursor_t out = { m, mcnt, 0, 0 };
+    int ret = stream_with_ad(&s, ctx, npub, AEAD_STREAM_DECRYPT, ad, adcnt);
+    if (ret == 0) ret = cursor_process(&s, &out, &in, ct_only);
+    if (ret == 0) ret = aead_stream_verify(&s, tag_in);
+    aead_stream_abort(&s);
+    if (ret != 0) {
+        out = (iov_cursor_t){ m, mcnt, 0, 0 };
+        cursor_write(&out, NULL, ct_only);
+        return ret;
+    }
+    if (mlen) *mlen = ct_only;
+    return 0;
+}
+
+void aead_ctx_free(aead_ctx_t* ctx)
+{
+    ctx->provider->free(&ctx->state);
+}
+
+// Stateless API on top of the keyed context of the default provider
+
+int aead_encrypt(uint8_t* c, size_t* clen,
+                 const uint8_t* m, size_t mlen,
+                 const uint8_t* ad, size_t adlen,
+                 const uint8_t* npub, const uint8_t* k)
+{
+    aead_ctx_t ctx;
+    int ret = aead_ctx_init(&ctx, k);
+    if (ret != 0) return ret;
+    ret = aead_ctx_encrypt(&ctx, c, clen, m, mlen, ad, adlen, npub);
+    aead_ctx_free(&ctx);
+    return ret;
+}
+
+int aead_decrypt(uint8_t* m, size_t* mlen,
+                 const uint8_t* c, size_t clen,
+                 const uint8_t* ad, size_t adlen,
+                 const uint8_t* npub, const uint8_t* k)
+{
+    aead_ctx_t ctx;
+    int ret = aead_ctx_init(&ctx, k);
+    if (ret != 0) return ret;
+    ret = aead_ctx_decrypt(&ctx, m, mlen, c, clen, ad, adlen, npub);
+    aead_ctx_free(&ctx);
+    return ret;
+}
+
+int aead_encrypt_iov(const aead_iov_t* c, size_t ccnt, size_t* clen,
+                     const aead_iov_t* m, size_t mcnt,
+                     const aead_iov_t* ad, size_t adcnt,
+                     const uint8_t* npub, const uint8_t* k)
+{
+    aead_ctx_t ctx;
+    int ret = aead_ctx_init(&ctx, k);
+    if (ret != 0) return ret;
+    ret = aead_ctx_encrypt_iov(&ctx, c, ccnt, clen, m, mcnt, ad, adcnt, npub);
+    aead_ctx_free(&ctx);
+    return ret;
+}
+
+int aead_decrypt_iov(const aead_iov_t* m, size_t mcnt, size_t* mlen,
+                     const aead_iov_t* c, size_t ccnt,
+                     const aead_iov_t* ad, size_t adcnt,
+                     const uint8_t* npub, const uint8_t* k)
+{
+    aead_ctx_t ctx;
+    int ret = aead_ctx_init(&ctx, k);
+    if (ret != 0) return ret;
+    ret = aead_ctx_decrypt_iov(&ctx, m, mcnt, mlen, c, ccnt, ad, adcnt, npub);
+    aead_ctx_free(&ctx);
+    return ret;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+// Helpers between aead_iov_t and lwIP: segments of a pbuf chain, and the
+// iovec array of sendmsg()/recvmsg().
+
+#include <stddef.h>
+#include <sys/socket.h>
+#include "lwip/pbuf.h"
+#include "crypto_aead/crypto_aead.h"
+
+// Describes the payload of the pbuf chain p as one segment per pbuf. Returns
+// the number of segments, or 0 if the chain has more than max. Headers in
+// front of the AEAD data are dropped first with pbuf_remove_header().
+static inline size_t aead_iov_from_pbuf(struct pbuf* p, aead_iov_t* iov, size_t max)
+{
+    size_t n = 0;
+    for (; p; p = p->next) {
+        if (n == max) return 0;
+        iov[n].base = p->payload;
+        iov[n].len = p->len;
+        ++n;
+    }
+    return n;
+}
+
+// Copies cnt segments into an iovec array, e.g. the output of
+// aead_ctx_encrypt_iov() behind a nonce segment for sendmsg()
+static inline void aead_iov_to_iovec(struct iovec* out, const aead_iov_t* iov, size_t cnt)
+{
+    for (size_t i = 0; i < cnt; ++i) {
+        out[i].iov_base = iov[i].base;
+        out[i].iov_len = iov[i].len;
+    }
+}
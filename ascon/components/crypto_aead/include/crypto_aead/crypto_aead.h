@@ -4,7 +4,7 @@
 #include <stdint.h>
 #include "sdkconfig.h"
 
-// Algorithm-dependent sizes
+// Algorithm-dependent sizes of the provider selected by CONFIG_AEAD_IMPL
 #if CONFIG_AEAD_IMPL_ASCON
   #define AEAD_KEY_LEN   16
   #define AEAD_NONCE_LEN 16
@@ -25,6 +25,119 @@
   #error "No AEAD implementation selected"
 #endif
 
+// Packet layout used by the apps: nonce | ciphertext | tag. A buffer with
+// AEAD_HEADROOM bytes in front of the payload and AEAD_TAILROOM behind it is
+// encrypted in place and sent as is.
+#define AEAD_HEADROOM AEAD_NONCE_LEN
+#define AEAD_TAILROOM AEAD_TAG_LEN
+
+// Sizes of the largest compiled-in provider, for buffers shared by all of them
+#define AEAD_MAX_KEY_LEN   32
+#define AEAD_MAX_NONCE_LEN 16
+#define AEAD_MAX_TAG_LEN   16
+
+#if CONFIG_AEAD_PROVIDER_ASCON
+  #include "ascon/aead.h"
+#endif
+#if CONFIG_AEAD_PROVIDER_AES_GCM
+  #include "mbedtls/gcm.h"
+#endif
+#if CONFIG_AEAD_PROVIDER_CHACHA20_POLY1305
+  #include "mbedtls/chachapoly.h"
+#endif
+
+// Per-key state of any compiled-in provider: the expanded key (AES round keys
+// and GHASH table, ChaCha20 key state) so it is computed once per key instead
+// of per packet. Ascon has no key schedule beyond loading the key, so its
+// state is the key.
+typedef union {
+#if CONFIG_AEAD_PROVIDER_AES_GCM
+    mbedtls_gcm_context gcm;
+#endif
+#if CONFIG_AEAD_PROVIDER_CHACHA20_POLY1305
+    mbedtls_chachapoly_context chachapoly;
+#endif
+    uint8_t key[AEAD_MAX_KEY_LEN];
+} aead_state_t;
+
+// State of one incremental (multi-part) operation. The mbedTLS providers keep
+// theirs inside the mbedTLS context in aead_state_t, so a context runs one
+// such operation at a time.
+typedef union {
+#if CONFIG_AEAD_PROVIDER_ASCON
+    struct {
+        ascon_aead128_state_t sponge;
+        uint8_t decrypt;
+    } ascon;
+#endif
+#if CONFIG_AEAD_PROVIDER_MOCK
+    struct {
+        uint8_t acc[16];
+        uint8_t npub[16];
+        size_t adlen;
+        size_t mlen;
+        uint8_t decrypt;
+    } mock;
+#endif
+    uint8_t none;
+} aead_op_t;
+
+// Segment of a scatter-gather buffer, laid out like struct iovec
+typedef struct {
+    void* base;
+    size_t len;
+} aead_iov_t;
+
+// Provider descriptor. Each provider source exports one (aead_provider_ascon,
+// aead_provider_aes_gcm, ...); the functions have the contract of the
+// aead_ctx_*() functions below. encrypt and decrypt must accept output ==
+// input (exact overlap), which the in-place functions rely on.
+typedef struct {
+    const char* name;
+    size_t key_len;
+    size_t nonce_len;
+    size_t tag_len;
+    int (*init)(aead_state_t* st, const uint8_t* k);
+    int (*encrypt)(aead_state_t* st, uint8_t* c, size_t* clen,
+                   const uint8_t* m, size_t mlen,
+                   const uint8_t* ad, size_t adlen,
+                   const uint8_t* npub);
+    int (*decrypt)(aead_state_t* st, uint8_t* m, size_t* mlen,
+                   const uint8_t* c, size_t clen,
+                   const uint8_t* ad, size_t adlen,
+                   const uint8_t* npub);
+    void (*free)(aead_state_t* st);
+
+    // Incremental interface behind the segmented and streaming functions:
+    // start() with the nonce, update_ad() for each piece of AD, update() for
+    // each piece of the message (out == in allowed), then finish() writes the
+    // tag computed over everything passed. For decryption the caller compares
+    // it with the received tag.
+    int (*start)(aead_state_t* st, aead_op_t* op, const uint8_t* npub, int decrypt);
+    int (*update_ad)(aead_state_t* st, aead_op_t* op, const uint8_t* ad, size_t adlen);
+    int (*update)(aead_state_t* st, aead_op_t* op, uint8_t* out, const uint8_t* in, size_t len);
+    int (*finish)(aead_state_t* st, aead_op_t* op, uint8_t* tag);
+    // Ends an operation without finish(), leaving no state derived from its
+    // data in st. NULL for providers whose operation state is all in op.
+    void (*abort)(aead_state_t* st, aead_op_t* op);
+} aead_provider_t;
+
+// Keyed context, bound to one provider by aead_ctx_init()/aead_ctx_init_with()
+typedef struct {
+    const aead_provider_t* provider;
+    aead_state_t state;
+} aead_ctx_t;
+
+// Registry of the compiled-in providers (CONFIG_AEAD_PROVIDER_*). The
+// provider selected by CONFIG_AEAD_IMPL is always present and is the default.
+size_t aead_provider_count(void);
+const aead_provider_t* aead_provider_at(size_t i);          // NULL past the end
+const aead_provider_t* aead_provider_find(const char* name); // NULL if not compiled in
+const aead_provider_t* aead_provider_default(void);
+
+// One-shot functions: set up the key, process one message and wipe the key.
+// c receives mlen bytes of ciphertext followed by the AEAD_TAG_LEN byte tag.
+// Decryption returns nonzero if the tag does not verify.
 int aead_encrypt(uint8_t* c, size_t* clen,
                  const uint8_t* m, size_t mlen,
                  const uint8_t* ad, size_t adlen,
@@ -35,3 +148,153 @@ int aead_decrypt(uint8_t* m, size_t* mlen,
                  const uint8_t* ad, size_t adlen,
                  const uint8_t* npub, const uint8_t* k);
 
+// Sets up ctx for key k (AEAD_KEY_LEN bytes) with the default provider.
+// Returns 0 on success; ctx needs no aead_ctx_free() if this fails.
+int aead_ctx_init(aead_ctx_t* ctx, const uint8_t* k);
+
+// Same with provider p; k is p->key_len bytes
+int aead_ctx_init_with(aead_ctx_t* ctx, const aead_provider_t* p, const uint8_t* k);
+
+// Same contract as aead_encrypt()/aead_decrypt() with the key and provider of
+// ctx; npub is ctx->provider->nonce_len bytes and the tag tag_len bytes. A
+// context may be used for any number of messages, but not from two tasks at
+// once.
+int aead_ctx_encrypt(aead_ctx_t* ctx, uint8_t* c, size_t* clen,
+                     const uint8_t* m, size_t mlen,
+                     const uint8_t* ad, size_t adlen,
+                     const uint8_t* npub);
+
+int aead_ctx_decrypt(aead_ctx_t* ctx, uint8_t* m, size_t* mlen,
+                     const uint8_t* c, size_t clen,
+                     const uint8_t* ad, size_t adlen,
+                     const uint8_t* npub);
+
+// In place: buf holds mlen bytes of plaintext followed by room for the tag.
+// The ciphertext overwrites the plaintext and the tag is appended, so *clen =
+// mlen + tag_len.
+int aead_ctx_encrypt_inplace(aead_ctx_t* ctx, uint8_t* buf, size_t mlen, size_t* clen,
+                             const uint8_t* ad, size_t adlen,
+                             const uint8_t* npub);
+
+// In place: buf holds clen bytes of ciphertext and tag. On success buf starts
+// with the *mlen = clen - tag_len bytes of plaintext. On failure the
+// ciphertext part of buf is zeroed, so no unauthenticated plaintext is left.
+int aead_ctx_decrypt_inplace(aead_ctx_t* ctx, uint8_t* buf, size_t clen, size_t* mlen,
+                             const uint8_t* ad, size_t adlen,
+                             const uint8_t* npub);
+
+// Scatter-gather: the AD and the message are read from arrays of segments and
+// the output is written across an array of segments, so a frame held in
+// several buffers (header, record, trailer; a pbuf chain) is processed without
+// first copying it into one. Empty segments are allowed.
+//
+// Encryption writes mlen bytes of ciphertext followed by the tag across c;
+// the segments of c must hold at least mlen + tag_len bytes in total and
+// *clen receives mlen + tag_len. Decryption takes ciphertext and tag from c
+// (the tag is the last tag_len bytes, and may span segments) and writes the
+// plaintext across m, which must hold clen - tag_len bytes. If the tag does
+// not verify, the plaintext written to m is zeroed. Output and input may be
+// the same segments, but must not otherwise overlap.
+int aead_ctx_encrypt_iov(aead_ctx_t* ctx,
+                         const aead_iov_t* c, size_t ccnt, size_t* clen,
+                         const aead_iov_t* m, size_t mcnt,
+                         const aead_iov_t* ad, size_t adcnt,
+                         const uint8_t* npub);
+
+int aead_ctx_decrypt_iov(aead_ctx_t* ctx,
+                         const aead_iov_t* m, size_t mcnt, size_t* mlen,
+                         const aead_iov_t* c, size_t ccnt,
+                         const aead_iov_t* ad, size_t adcnt,
+                         const uint8_t* npub);
+
+// One-shot variants with the default provider and key k
+int aead_encrypt_iov(const aead_iov_t* c, size_t ccnt, size_t* clen,
+                     const aead_iov_t* m, size_t mcnt,
+                     const aead_iov_t* ad, size_t adcnt,
+                     const uint8_t* npub, const uint8_t* k);
+
+int aead_decrypt_iov(const aead_iov_t* m, size_t mcnt, size_t* mlen,
+                     const aead_iov_t* c, size_t ccnt,
+                     const aead_iov_t* ad, size_t adcnt,
+                     const uint8_t* npub, const uint8_t* k);
+
+// Streaming: one message processed in pieces, for payloads too large to hold
+// in RAM at once.
+//
+//   aead_stream_t s;
+//   aead_stream_init(&s, &ctx, npub, AEAD_STREAM_ENCRYPT);
+//   aead_stream_update_ad(&s, ad, adlen);      // zero or more times
+//   aead_stream_update(&s, out, in, len);      // zero or more times
+//   aead_stream_final(&s, tag);                // or aead_stream_verify(&s, tag)
+//
+// update() writes len bytes of output for every len bytes of input (out == in
+// allowed). All AD comes before the first update(). Decryption hands out
+// plaintext before verify() has checked the tag: it must not be acted upon
+// until verify() returns 0. When that is not acceptable (writing an OTA image,
+// replaying a log), use the chunked functions below. AES-GCM and
+// ChaCha20-Poly1305 keep the stream state in the context, so a context runs
+// one stream at a time and no other operation until the stream ends.
+// final()/verify() wipe the stream state; aead_stream_abort() does so for a
+// stream that is given up, including the provider's state in the context, and
+// returns the context to use for other operations. It may be called on a
+// stream that has already ended.
+#define AEAD_STREAM_ENCRYPT 0
+#define AEAD_STREAM_DECRYPT 1
+
+typedef struct {
+    aead_ctx_t* ctx;
+    aead_op_t op;
+    uint8_t mode;    // AEAD_STREAM_*
+    uint8_t in_msg;  // update() was called, no more AD
+    uint8_t active;
+} aead_stream_t;
+
+// npub is ctx->provider->nonce_len bytes
+int aead_stream_init(aead_stream_t* s, aead_ctx_t* ctx, const uint8_t* npub, int mode);
+int aead_stream_update_ad(aead_stream_t* s, const uint8_t* ad, size_t adlen);
+int aead_stream_update(aead_stream_t* s, uint8_t* out, const uint8_t* in, size_t len);
+
+// Encryption: writes the tag (ctx->provider->tag_len bytes)
+int aead_stream_final(aead_stream_t* s, uint8_t* tag);
+
+// Decryption: returns 0 if tag matches everything passed to the stream
+int aead_stream_verify(aead_stream_t* s, const uint8_t* tag);
+
+void aead_stream_abort(aead_stream_t* s);
+
+// Chunked STREAM (Hoang, Reyhanitabar, Rogaway, Vizar): a large payload is cut
+// into chunks, each sealed on its own with the nonce
+//
+//   prefix (nonce_len - 5 bytes) | be32(chunk index) | last flag (1 byte)
+//
+// so the receiver checks every chunk before using it, memory is one chunk
+// however large the payload, and reordered, dropped or duplicated chunks and a
+// payload truncated at a chunk boundary fail to open. The prefix must be
+// unique per payload under one key (e.g. a random or counter-based file ID).
+// Chunks may differ in size; the one marked last ends the sequence, and a
+// receiver opens the final chunk with last = 1, so a missing tail is
+// detected. Each chunk costs a tag (tag_len bytes) on the wire.
+#define AEAD_CHUNK_NONCE_SUFFIX 5
+
+typedef struct {
+    aead_ctx_t* ctx;
+    uint8_t nonce[AEAD_MAX_NONCE_LEN];
+    uint32_t counter;   // index of the next chunk
+    uint8_t finished;   // the last chunk was processed
+} aead_chunked_t;
+
+int aead_chunked_init(aead_chunked_t* cs, aead_ctx_t* ctx, const uint8_t* prefix);
+
+// Same contract as aead_ctx_encrypt()/aead_ctx_decrypt() for the next chunk;
+// ad is optional per-chunk AD. Fails once the last chunk is processed or
+// after 2^32 chunks. A chunk that fails to open leaves the position unchanged.
+int aead_chunked_seal(aead_chunked_t* cs, uint8_t* c, size_t* clen,
+                      const uint8_t* m, size_t mlen,
+                      const uint8_t* ad, size_t adlen, int last);
+
+int aead_chunked_open(aead_chunked_t* cs, uint8_t* m, size_t* mlen,
+                      const uint8_t* c, size_t clen,
+                      const uint8_t* ad, size_t adlen, int last);
+
+// Wipes the key material
+void aead_ctx_free(aead_ctx_t* ctx);
@@ -2,47 +2,107 @@
 #include <string.h>
 #include "mbedtls/gcm.h"
 
-_Static_assert(AEAD_KEY_LEN == 16, "AES-GCM provider requires 128-bit key");
-_Static_assert(AEAD_NONCE_LEN == 12, "AES-GCM provider requires 96-bit nonce");
-_Static_assert(AEAD_TAG_LEN == 16, "AES-GCM provider uses 128-bit tag");
+#define GCM_KEY_LEN   16
+#define GCM_NONCE_LEN 12
+#define GCM_TAG_LEN   16
 
-int aead_encrypt(uint8_t* c, size_t* clen,
-                 const uint8_t* m, size_t mlen,
-                 const uint8_t* ad, size_t adlen,
-                 const uint8_t* npub, const uint8_t* k)
+static int gcm_init(aead_state_t* st, const uint8_t* k)
 {
-    mbedtls_gcm_context ctx;
-    mbedtls_gcm_init(&ctx);
-    int ret = mbedtls_gcm_setkey(&ctx, MBEDTLS_CIPHER_ID_AES, k, AEAD_KEY_LEN * 8);
-    if (ret != 0) { mbedtls_gcm_free(&ctx); return ret; }
+    mbedtls_gcm_init(&st->gcm);
+    int ret = mbedtls_gcm_setkey(&st->gcm, MBEDTLS_CIPHER_ID_AES, k, GCM_KEY_LEN * 8);
+    if (ret != 0) mbedtls_gcm_free(&st->gcm);
+    return ret;
+}
 
+static int gcm_encrypt(aead_state_t* st, uint8_t* c, size_t* clen,
+                       const uint8_t* m, size_t mlen,
+                       const uint8_t* ad, size_t adlen,
+                       const uint8_t* npub)
+{
     uint8_t* ct = c;
     uint8_t* tag = c + mlen;
-    ret = mbedtls_gcm_crypt_and_tag(&ctx, MBEDTLS_GCM_ENCRYPT,
-                                     mlen, npub, AEAD_NONCE_LEN,
-                                     ad, adlen, m, ct, AEAD_TAG_LEN, tag);
-    if (ret == 0 && clen) *clen = mlen + AEAD_TAG_LEN;
-    mbedtls_gcm_free(&ctx);
+    int ret = mbedtls_gcm_crypt_and_tag(&st->gcm, MBEDTLS_GCM_ENCRYPT,
+                                         mlen, npub, GCM_NONCE_LEN,
+                                         ad, adlen, m, ct, GCM_TAG_LEN, tag);
+    if (ret == 0 && clen) *clen = mlen + GCM_TAG_LEN;
     return ret;
 }
 
-int aead_decrypt(uint8_t* m, size_t* mlen,
-                 const uint8_t* c, size_t clen,
-                 const uint8_t* ad, size_t adlen,
-                 const uint8_t* npub, const uint8_t* k)
+static int gcm_decrypt(aead_state_t* st, uint8_t* m, size_t* mlen,
+                       const uint8_t* c, size_t clen,
+                       const uint8_t* ad, size_t adlen,
+                       const uint8_t* npub)
 {
-    if (clen < AEAD_TAG_LEN) return -1;
-    size_t ct_only = clen - AEAD_TAG_LEN;
+    if (clen < GCM_TAG_LEN) return -1;
+    size_t ct_only = clen - GCM_TAG_LEN;
     const uint8_t* ct = c;
     const uint8_t* tag = c + ct_only;
-    mbedtls_gcm_context ctx;
-    mbedtls_gcm_init(&ctx);
-    int ret = mbedtls_gcm_setkey(&ctx, MBEDTLS_CIPHER_ID_AES, k, AEAD_KEY_LEN * 8);
-    if (ret != 0) { mbedtls_gcm_free(&ctx); return ret; }
-    ret = mbedtls_gcm_auth_decrypt(&ctx, ct_only, npub, AEAD_NONCE_LEN,
-                                   ad, adlen, tag, AEAD_TAG_LEN, ct, m);
+    int ret = mbedtls_gcm_auth_decrypt(&st->gcm, ct_only, npub, GCM_NONCE_LEN,
+                                       ad, adlen, tag, GCM_TAG_LEN, ct, m);
     if (ret == 0 && mlen) *mlen = ct_only;
-    mbedtls_gcm_free(&ctx);
     return ret;
 }
 
+// Incremental interface on the mbedTLS GCM streaming calls; the operation
+// state lives in st->gcm
+
+static int gcm_start(aead_state_t* st, aead_op_t* op, const uint8_t* npub, int decrypt)
+{
+    (void)op;
+    return mbedtls_gcm_starts(&st->gcm, decrypt ? MBEDTLS_GCM_DECRYPT : MBEDTLS_GCM_ENCRYPT,
+                              npub, GCM_NONCE_LEN);
+}
+
+static int gcm_update_ad(aead_state_t* st, aead_op_t* op, const uint8_t* ad, size_t adlen)
+{
+    (void)op;
+    return mbedtls_gcm_update_ad(&st->gcm, ad, adlen);
+}
+
+static int gcm_update(aead_state_t* st, aead_op_t* op, uint8_t* out, const uint8_t* in, size_t len)
+{
+    (void)op;
+    size_t olen = 0;
+    int ret = mbedtls_gcm_update(&st->gcm, in, len, out, len, &olen);
+    // GCM is a stream mode: every input byte is output right away
+    if (ret == 0 && olen != len) ret = -1;
+    return ret;
+}
+
+static int gcm_finish(aead_state_t* st, aead_op_t* op, uint8_t* tag)
+{
+    (void)op;
+    size_t olen = 0;
+    return mbedtls_gcm_finish(&st->gcm, NULL, 0, &olen, tag, GCM_TAG_LEN);
+}
+
+// mbedTLS has no call to drop a GCM operation. Starting a new one under a
+// fixed nonce overwrites the GHASH accumulator, counter block and buffered
+// keystream of the old one; the round keys are kept.
+static void gcm_abort(aead_state_t* st, aead_op_t* op)
+{
+    (void)op;
+    static const uint8_t zero_nonce[GCM_NONCE_LEN];
+    mbedtls_gcm_starts(&st->gcm, MBEDTLS_GCM_ENCRYPT, zero_nonce, GCM_NONCE_LEN);
+}
+
+static void gcm_free(aead_state_t* st)
+{
+    mbedtls_gcm_free(&st->gcm);
+}
+
+const aead_provider_t aead_provider_aes_gcm = {
+    .name = "aes-gcm-128",
+    .key_len = GCM_KEY_LEN,
+    .nonce_len = GCM_NONCE_LEN,
+    .tag_len = GCM_TAG_LEN,
+    .init = gcm_init,
+    .encrypt = gcm_encrypt,
+    .decrypt = gcm_decrypt,
+    .free = gcm_free,
+    .start = gcm_start,
+    .update_ad = gcm_update_ad,
+    .update = gcm_update,
+    .finish = gcm_finish,
+    .abort = gcm_abort,
+};
@@ -1,19 +1,83 @@
 #include "crypto_aead/crypto_aead.h"
+#include <string.h>
 #include "ascon/aead.h"
+#include "mbedtls/platform_util.h"
 
-int aead_encrypt(uint8_t* c, size_t* clen,
-                 const uint8_t* m, size_t mlen,
-                 const uint8_t* ad, size_t adlen,
-                 const uint8_t* npub, const uint8_t* k)
+// Ascon absorbs the key into the state together with the nonce, so there is
+// no per-key work to cache: the state only holds the key.
+
+static int ascon_init(aead_state_t* st, const uint8_t* k)
+{
+    memcpy(st->key, k, ASCON_AEAD_KEY_LEN);
+    return 0;
+}
+
+static int ascon_encrypt(aead_state_t* st, uint8_t* c, size_t* clen,
+                         const uint8_t* m, size_t mlen,
+                         const uint8_t* ad, size_t adlen,
+                         const uint8_t* npub)
+{
+    return ascon_aead128_encrypt(c, clen, m, mlen, ad, adlen, npub, st->key);
+}
+
+static int ascon_decrypt(aead_state_t* st, uint8_t* m, size_t* mlen,
+                         const uint8_t* c, size_t clen,
+                         const uint8_t* ad, size_t adlen,
+                         const uint8_t* npub)
+{
+    return ascon_aead128_decrypt(m, mlen, c, clen, ad, adlen, npub, st->key);
+}
+
+// Incremental interface on the portable sponge from ascon_sponge.c
+
+static int ascon_start(aead_state_t* st, aead_op_t* op, const uint8_t* npub, int decrypt)
+{
+    ascon_aead128_start(&op->ascon.sponge, npub, st->key);
+    op->ascon.decrypt = (uint8_t)decrypt;
+    return 0;
+}
+
+static int ascon_update_ad(aead_state_t* st, aead_op_t* op, const uint8_t* ad, size_t adlen)
+{
+    (void)st;
+    ascon_aead128_update_ad(&op->ascon.sponge, ad, adlen);
+    return 0;
+}
+
+static int ascon_update(aead_state_t* st, aead_op_t* op, uint8_t* out, const uint8_t* in, size_t len)
+{
+    (void)st;
+    if (op->ascon.decrypt) {
+        ascon_aead128_decrypt_update(&op->ascon.sponge, out, in, len);
+    } else {
+        ascon_aead128_encrypt_update(&op->ascon.sponge, out, in, len);
+    }
+    return 0;
+}
+
+static int ascon_finish(aead_state_t* st, aead_op_t* op, uint8_t* tag)
 {
-    return ascon_aead128_encrypt(c, clen, m, mlen, ad, adlen, npub, k);
+    (void)st;
+    ascon_aead128_finish(&op->ascon.sponge, tag);
+    return 0;
 }
 
-int aead_decrypt(uint8_t* m, size_t* mlen,
-                 const uint8_t* c, size_t clen,
-                 const uint8_t* ad, size_t adlen,
-                 const uint8_t* npub, const uint8_t* k)
+static void ascon_free(aead_state_t* st)
 {
-    return ascon_aead128_decrypt(m, mlen, c, clen, ad, adlen, npub, k);
+    mbedtls_platform_zeroize(st->key, ASCON_AEAD_KEY_LEN);
 }
 
+const aead_provider_t aead_provider_ascon = {
+    .name = "ascon-aead128",
+    .key_len = ASCON_AEAD_KEY_LEN,
+    .nonce_len = ASCON_AEAD_NONCE_LEN,
+    .tag_len = ASCON_AEAD_TAG_LEN,
+    .init = ascon_init,
+    .encrypt = ascon_encrypt,
+    .decrypt = ascon_decrypt,
+    .free = ascon_free,
+    .start = ascon_start,
+    .update_ad = ascon_update_ad,
+    .update = ascon_update,
+    .finish = ascon_finish,
+};
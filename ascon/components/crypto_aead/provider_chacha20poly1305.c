@@ -2,45 +2,100 @@
 #include <string.h>
 #include "mbedtls/chachapoly.h"
 
-_Static_assert(AEAD_KEY_LEN == 32, "ChaCha20-Poly1305 requires 256-bit key");
-_Static_assert(AEAD_NONCE_LEN == 12, "ChaCha20-Poly1305 requires 96-bit nonce");
-_Static_assert(AEAD_TAG_LEN == 16, "ChaCha20-Poly1305 uses 128-bit tag");
+#define CHACHAPOLY_KEY_LEN   32
+#define CHACHAPOLY_NONCE_LEN 12
+#define CHACHAPOLY_TAG_LEN   16
 
-int aead_encrypt(uint8_t* c, size_t* clen,
-                 const uint8_t* m, size_t mlen,
-                 const uint8_t* ad, size_t adlen,
-                 const uint8_t* npub, const uint8_t* k)
+static int chachapoly_init(aead_state_t* st, const uint8_t* k)
 {
-    mbedtls_chachapoly_context ctx;
-    mbedtls_chachapoly_init(&ctx);
-    int ret = mbedtls_chachapoly_setkey(&ctx, k);
-    if (ret != 0) { mbedtls_chachapoly_free(&ctx); return ret; }
+    mbedtls_chachapoly_init(&st->chachapoly);
+    int ret = mbedtls_chachapoly_setkey(&st->chachapoly, k);
+    if (ret != 0) mbedtls_chachapoly_free(&st->chachapoly);
+    return ret;
+}
 
+static int chachapoly_encrypt(aead_state_t* st, uint8_t* c, size_t* clen,
+                              const uint8_t* m, size_t mlen,
+                              const uint8_t* ad, size_t adlen,
+                              const uint8_t* npub)
+{
     uint8_t* ct = c;
     uint8_t* tag = c + mlen;
-    ret = mbedtls_chachapoly_encrypt_and_tag(&ctx, mlen, npub,
-                                             ad, adlen, m, ct, tag);
-    if (ret == 0 && clen) *clen = mlen + AEAD_TAG_LEN;
-    mbedtls_chachapoly_free(&ctx);
+    int ret = mbedtls_chachapoly_encrypt_and_tag(&st->chachapoly, mlen, npub,
+                                                 ad, adlen, m, ct, tag);
+    if (ret == 0 && clen) *clen = mlen + CHACHAPOLY_TAG_LEN;
     return ret;
 }
 
-int aead_decrypt(uint8_t* m, size_t* mlen,
-                 const uint8_t* c, size_t clen,
-                 const uint8_t* ad, size_t adlen,
-                 const uint8_t* npub, const uint8_t* k)
+static int chachapoly_decrypt(aead_state_t* st, uint8_t* m, size_t* mlen,
+                              const uint8_t* c, size_t clen,
+                              const uint8_t* ad, size_t adlen,
+                              const uint8_t* npub)
 {
-    if (clen < AEAD_TAG_LEN) return -1;
-    size_t ct_only = clen - AEAD_TAG_LEN;
+    if (clen < CHACHAPOLY_TAG_LEN) return -1;
+    size_t ct_only = clen - CHACHAPOLY_TAG_LEN;
     const uint8_t* ct = c;
     const uint8_t* tag = c + ct_only;
-    mbedtls_chachapoly_context ctx;
-    mbedtls_chachapoly_init(&ctx);
-    int ret = mbedtls_chachapoly_setkey(&ctx, k);
-    if (ret != 0) { mbedtls_chachapoly_free(&ctx); return ret; }
-    ret = mbedtls_chachapoly_auth_decrypt(&ctx, ct_only, npub, ad, adlen, tag, ct, m);
+    int ret = mbedtls_chachapoly_auth_decrypt(&st->chachapoly, ct_only, npub,
+                                              ad, adlen, tag, ct, m);
     if (ret == 0 && mlen) *mlen = ct_only;
-    mbedtls_chachapoly_free(&ctx);
     return ret;
 }
 
+// Incremental interface on the mbedTLS ChaChaPoly streaming calls; the
+// operation state lives in st->chachapoly
+
+static int chachapoly_start(aead_state_t* st, aead_op_t* op, const uint8_t* npub, int decrypt)
+{
+    (void)op;
+    return mbedtls_chachapoly_starts(&st->chachapoly, npub,
+                                     decrypt ? MBEDTLS_CHACHAPOLY_DECRYPT : MBEDTLS_CHACHAPOLY_ENCRYPT);
+}
+
+static int chachapoly_update_ad(aead_state_t* st, aead_op_t* op, const uint8_t* ad, size_t adlen)
+{
+    (void)op;
+    return mbedtls_chachapoly_update_aad(&st->chachapoly, ad, adlen);
+}
+
+static int chachapoly_update(aead_state_t* st, aead_op_t* op, uint8_t* out, const uint8_t* in, size_t len)
+{
+    (void)op;
+    return mbedtls_chachapoly_update(&st->chachapoly, len, in, out);
+}
+
+static int chachapoly_finish(aead_state_t* st, aead_op_t* op, uint8_t* tag)
+{
+    (void)op;
+    return mbedtls_chachapoly_finish(&st->chachapoly, tag);
+}
+
+// Same as for GCM: a restart under a fixed nonce replaces the keystream and
+// Poly1305 state of the dropped operation and leaves the key in place
+static void chachapoly_abort(aead_state_t* st, aead_op_t* op)
+{
+    (void)op;
+    static const uint8_t zero_nonce[CHACHAPOLY_NONCE_LEN];
+    mbedtls_chachapoly_starts(&st->chachapoly, zero_nonce, MBEDTLS_CHACHAPOLY_ENCRYPT);
+}
+
+static void chachapoly_free(aead_state_t* st)
+{
+    mbedtls_chachapoly_free(&st->chachapoly);
+}
+
+const aead_provider_t aead_provider_chacha20_poly1305 = {
+    .name = "chacha20-poly1305",
+    .key_len = CHACHAPOLY_KEY_LEN,
+    .nonce_len = CHACHAPOLY_NONCE_LEN,
+    .tag_len = CHACHAPOLY_TAG_LEN,
+    .init = chachapoly_init,
+    .encrypt = chachapoly_encrypt,
+    .decrypt = chachapoly_decrypt,
+    .free = chachapoly_free,
+    .start = chachapoly_start,
+    .update_ad = chachapoly_update_ad,
+    .update = chachapoly_update,
+    .finish = chachapoly_finish,
+    .abort = chachapoly_abort,
+};
@@ -3,48 +3,120 @@
 
 // Insecure mock; for plumbing/perf comparisons only
 
-static void fake_tag(uint8_t tag[AEAD_TAG_LEN], const uint8_t* c, size_t clen,
+#define MOCK_KEY_LEN   16
+#define MOCK_NONCE_LEN 16
+#define MOCK_TAG_LEN   16
+
+static void fake_tag(uint8_t tag[MOCK_TAG_LEN], const uint8_t* c, size_t clen,
                      const uint8_t* ad, size_t adlen,
                      const uint8_t* npub, const uint8_t* k)
 {
-    uint8_t acc[AEAD_TAG_LEN] = {0};
-    for (size_t i = 0; i < AEAD_TAG_LEN; ++i) acc[i] = k[i % AEAD_KEY_LEN] ^ npub[i % AEAD_NONCE_LEN];
-    for (size_t i = 0; i < clen; ++i) acc[i % AEAD_TAG_LEN] ^= c[i];
-    for (size_t i = 0; i < adlen; ++i) acc[i % AEAD_TAG_LEN] ^= ad[i];
-    memcpy(tag, acc, AEAD_TAG_LEN);
+    uint8_t acc[MOCK_TAG_LEN] = {0};
+    for (size_t i = 0; i < MOCK_TAG_LEN; ++i) acc[i] = k[i % MOCK_KEY_LEN] ^ npub[i % MOCK_NONCE_LEN];
+    for (size_t i = 0; i < clen; ++i) acc[i % MOCK_TAG_LEN] ^= c[i];
+    for (size_t i = 0; i < adlen; ++i) acc[i % MOCK_TAG_LEN] ^= ad[i];
+    memcpy(tag, acc, MOCK_TAG_LEN);
 }
 
-int aead_encrypt(uint8_t* c, size_t* clen,
-                 const uint8_t* m, size_t mlen,
-                 const uint8_t* ad, size_t adlen,
-                 const uint8_t* npub, const uint8_t* k)
+static int mock_init(aead_state_t* st, const uint8_t* k)
 {
-    (void)ad; (void)adlen;
+    memcpy(st->key, k, MOCK_KEY_LEN);
+    return 0;
+}
+
+static int mock_encrypt(aead_state_t* st, uint8_t* c, size_t* clen,
+                        const uint8_t* m, size_t mlen,
+                        const uint8_t* ad, size_t adlen,
+                        const uint8_t* npub)
+{
+    const uint8_t* k = st->key;
     for (size_t i = 0; i < mlen; ++i) {
-        c[i] = m[i] ^ k[i % AEAD_KEY_LEN] ^ npub[i % AEAD_NONCE_LEN];
+        c[i] = m[i] ^ k[i % MOCK_KEY_LEN] ^ npub[i % MOCK_NONCE_LEN];
     }
-    uint8_t tag[AEAD_TAG_LEN];
+    uint8_t tag[MOCK_TAG_LEN];
     fake_tag(tag, c, mlen, ad, adlen, npub, k);
-    memcpy(c + mlen, tag, AEAD_TAG_LEN);
-    if (clen) *clen = mlen + AEAD_TAG_LEN;
+    memcpy(c + mlen, tag, MOCK_TAG_LEN);
+    if (clen) *clen = mlen + MOCK_TAG_LEN;
     return 0;
 }
 
-int aead_decrypt(uint8_t* m, size_t* mlen,
-                 const uint8_t* c, size_t clen,
-                 const uint8_t* ad, size_t adlen,
-                 const uint8_t* npub, const uint8_t* k)
+static int mock_decrypt(aead_state_t* st, uint8_t* m, size_t* mlen,
+                        const uint8_t* c, size_t clen,
+                        const uint8_t* ad, size_t adlen,
+                        const uint8_t* npub)
 {
-    if (clen < AEAD_TAG_LEN) return -1;
-    size_t ct_only = clen - AEAD_TAG_LEN;
+    if (clen < MOCK_TAG_LEN) return -1;
+    const uint8_t* k = st->key;
+    size_t ct_only = clen - MOCK_TAG_LEN;
     const uint8_t* tag_in = c + ct_only;
-    uint8_t tag[AEAD_TAG_LEN];
+    uint8_t tag[MOCK_TAG_LEN];
     fake_tag(tag, c, ct_only, ad, adlen, npub, k);
-    if (memcmp(tag, tag_in, AEAD_TAG_LEN) != 0) return -1;
+    if (memcmp(tag, tag_in, MOCK_TAG_LEN) != 0) return -1;
     for (size_t i = 0; i < ct_only; ++i) {
-        m[i] = c[i] ^ k[i % AEAD_KEY_LEN] ^ npub[i % AEAD_NONCE_LEN];
+        m[i] = c[i] ^ k[i % MOCK_KEY_LEN] ^ npub[i % MOCK_NONCE_LEN];
     }
     if (mlen) *mlen = ct_only;
     return 0;
 }
 
+// Incremental form of the same construction: the tag accumulator is updated
+// at the running AD/message positions
+
+static int mock_start(aead_state_t* st, aead_op_t* op, const uint8_t* npub, int decrypt)
+{
+    for (size_t i = 0; i < MOCK_TAG_LEN; ++i) {
+        op->mock.acc[i] = st->key[i % MOCK_KEY_LEN] ^ npub[i % MOCK_NONCE_LEN];
+    }
+    memcpy(op->mock.npub, npub, MOCK_NONCE_LEN);
+    op->mock.adlen = 0;
+    op->mock.mlen = 0;
+    op->mock.decrypt = (uint8_t)decrypt;
+    return 0;
+}
+
+static int mock_update_ad(aead_state_t* st, aead_op_t* op, const uint8_t* ad, size_t adlen)
+{
+    (void)st;
+    for (size_t i = 0; i < adlen; ++i) {
+        op->mock.acc[op->mock.adlen++ % MOCK_TAG_LEN] ^= ad[i];
+    }
+    return 0;
+}
+
+static int mock_update(aead_state_t* st, aead_op_t* op, uint8_t* out, const uint8_t* in, size_t len)
+{
+    for (size_t i = 0; i < len; ++i) {
+        size_t pos = op->mock.mlen++;
+        uint8_t x = in[i];
+        out[i] = x ^ st->key[pos % MOCK_KEY_LEN] ^ op->mock.npub[pos % MOCK_NONCE_LEN];
+        op->mock.acc[pos % MOCK_TAG_LEN] ^= op->mock.decrypt ? x : out[i];
+    }
+    return 0;
+}
+
+static int mock_finish(aead_state_t* st, aead_op_t* op, uint8_t* tag)
+{
+    (void)st;
+    memcpy(tag, op->mock.acc, MOCK_TAG_LEN);
+    return 0;
+}
+
+static void mock_free(aead_state_t* st)
+{
+    memset(st->key, 0, MOCK_KEY_LEN);
+}
+
+const aead_provider_t aead_provider_mock = {
+    .name = "mock",
+    .key_len = MOCK_KEY_LEN,
+    .nonce_len = MOCK_NONCE_LEN,
+    .tag_len = MOCK_TAG_LEN,
+    .init = mock_init,
+    .encrypt = mock_encrypt,
+    .decrypt = mock_decrypt,
+    .free = mock_free,
+    .start = mock_start,
+    .update_ad = mock_update_ad,
+    .update = mock_update,
+    .finish = mock_finish,
+};
@@ -0,0 +1,79 @@
+#include "crypto_hash/crypto_hash.h"
+#include <string.h>
+
+// Provider descriptors, defined in provider_*.c
+extern const hash_provider_t hash_provider_ascon_hash256;
+extern const hash_provider_t hash_provider_ascon_xof128;
+extern const hash_provider_t hash_provider_ascon_prf;
+extern const hash_provider_t hash_provider_sha256;
+
+static const hash_provider_t* const s_providers[] = {
+#if CONFIG_HASH_PROVIDER_ASCON
+    &hash_provider_ascon_hash256,
+    &hash_provider_ascon_xof128,
+    &hash_provider_ascon_prf,
+#endif
+#if CONFIG_HASH_PROVIDER_SHA256
+    &hash_provider_sha256,
+#endif
+};
+
+size_t hash_provider_count(void)
+{
+    return sizeof(s_providers) / sizeof(s_providers[0]);
+}
+
+const hash_provider_t* hash_provider_at(size_t i)
+{
+    return i < hash_provider_count() ? s_providers[i] : NULL;
+}
+
+const hash_provider_t* hash_provider_find(const char* name)
+{
+    for (size_t i = 0; i < hash_provider_count(); ++i) {
+        if (strcmp(s_providers[i]->name, name) == 0) return s_providers[i];
+    }
+    return NULL;
+}
+
+int hash_init(hash_ctx_t* ctx, const hash_provider_t* p, const uint8_t* key)
+{
+    if (!p || (p->key_len && !key)) return -1;
+    ctx->provider = p;
+    return p->start(&ctx->state, key);
+}
+
+int hash_update(hash_ctx_t* ctx, const uint8_t* in, size_t len)
+{
+    if (len == 0) return 0;
+    return ctx->provider->update(&ctx->state, in, len);
+}
+
+int hash_final(hash_ctx_t* ctx, uint8_t* out, size_t outlen)
+{
+    const hash_provider_t* p = ctx->provider;
+    if (!p->xof && outlen != p->digest_len) {
+        hash_abort(ctx);
+        return -1;
+    }
+    return p->finish(&ctx->state, out, outlen);
+}
+
+void hash_abort(hash_ctx_t* ctx)
+{
+    ctx->provider->abort(&ctx->state);
+}
+
+int hash_compute(const hash_provider_t* p, const uint8_t* key,
+                 const uint8_t* in, size_t len, uint8_t* out, size_t outlen)
+{
+    hash_ctx_t ctx;
+    int ret = hash_init(&ctx, p, key);
+    if (ret != 0) return ret;
+    ret = hash_update(&ctx, in, len);
+    if (ret != 0) {
+        hash_abort(&ctx);
+        return ret;
+    }
+    return hash_final(&ctx, out, outlen);
+}
@@ -0,0 +1,35 @@
+#include "crypto_hash/hash_partition.h"
+
+#define WINDOW CONFIG_HASH_PARTITION_MMAP_SIZE
+
+esp_err_t hash_update_partition(hash_ctx_t* ctx, const esp_partition_t* part,
+                                size_t offset, size_t len)
+{
+    if (offset > part->size || len > part->size - offset) return ESP_ERR_INVALID_SIZE;
+    while (len) {
+        size_t n = len < WINDOW ? len : WINDOW;
+        const void* p;
+        esp_partition_mmap_handle_t handle;
+        esp_err_t err = esp_partition_mmap(part, offset, n, ESP_PARTITION_MMAP_DATA, &p, &handle);
+        if (err != ESP_OK) return err;
+        int ret = hash_update(ctx, p, n);
+        esp_partition_munmap(handle);
+        if (ret != 0) return ESP_FAIL;
+        offset += n;
+        len -= n;
+    }
+    return ESP_OK;
+}
+
+esp_err_t hash_partition(const hash_provider_t* p, const uint8_t* key,
+                         const esp_partition_t* part, uint8_t* out, size_t outlen)
+{
+    hash_ctx_t ctx;
+    if (hash_init(&ctx, p, key) != 0) return ESP_ERR_INVALID_ARG;
+    esp_err_t err = hash_update_partition(&ctx, part, 0, part->size);
+    if (err != ESP_OK) {
+        hash_abort(&ctx);
+        return err;
+    }
+    return hash_final(&ctx, out, outlen) == 0 ? ESP_OK : ESP_FAIL;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "sdkconfig.h"
+
+// Sizes of the largest compiled-in provider, for buffers shared by all of them
+#define HASH_MAX_KEY_LEN    16
+#define HASH_MAX_DIGEST_LEN 32
+
+#if CONFIG_HASH_PROVIDER_ASCON
+  #include "ascon/hash.h"
+#endif
+#if CONFIG_HASH_PROVIDER_SHA256
+  #include "mbedtls/sha256.h"
+#endif
+
+// State of one hash computation of any compiled-in provider
+typedef union {
+#if CONFIG_HASH_PROVIDER_ASCON
+    ascon_hash_state_t ascon;
+#endif
+#if CONFIG_HASH_PROVIDER_SHA256
+    mbedtls_sha256_context sha256;
+#endif
+    uint8_t none;
+} hash_state_t;
+
+// Provider descriptor. Each provider source exports its descriptors
+// (hash_provider_ascon_hash256, hash_provider_sha256, ...); the functions have
+// the contract of hash_init()/hash_update()/hash_final() below. finish() is
+// called with outlen == digest_len unless the provider is an XOF, and must
+// leave no secret state behind.
+typedef struct {
+    const char* name;
+    size_t key_len;     // 0 for unkeyed hashes
+    size_t digest_len;  // output length, or the default one of an XOF
+    uint8_t xof;        // any output length
+    int (*start)(hash_state_t* st, const uint8_t* key);
+    int (*update)(hash_state_t* st, const uint8_t* in, size_t len);
+    int (*finish)(hash_state_t* st, uint8_t* out, size_t outlen);
+    void (*abort)(hash_state_t* st);
+} hash_provider_t;
+
+// One hash computation bound to a provider by hash_init()
+typedef struct {
+    const hash_provider_t* provider;
+    hash_state_t state;
+} hash_ctx_t;
+
+// Registry of the compiled-in providers (CONFIG_HASH_PROVIDER_*). Names:
+// "ascon-hash256", "ascon-xof128", "ascon-prf", "sha256".
+size_t hash_provider_count(void);
+const hash_provider_t* hash_provider_at(size_t i);           // NULL past the end
+const hash_provider_t* hash_provider_find(const char* name); // NULL if not compiled in
+
+// Starts a computation with provider p; key is p->key_len bytes (NULL for
+// unkeyed providers). Returns 0 on success.
+int hash_init(hash_ctx_t* ctx, const hash_provider_t* p, const uint8_t* key);
+
+int hash_update(hash_ctx_t* ctx, const uint8_t* in, size_t len);
+
+// Writes outlen bytes of output: provider->digest_len, or any length for an
+// XOF. Ends the computation and wipes its state, also on failure.
+int hash_final(hash_ctx_t* ctx, uint8_t* out, size_t outlen);
+
+// Ends a computation without output
+void hash_abort(hash_ctx_t* ctx);
+
+// One-shot: init, update and final
+int hash_compute(const hash_provider_t* p, const uint8_t* key,
+                 const uint8_t* in, size_t len, uint8_t* out, size_t outlen);
@@ -0,0 +1,20 @@
+#pragma once
+
+// Hashing flash partitions (firmware and config fingerprints) through the
+// flash cache
+
+#include <stddef.h>
+#include "esp_err.h"
+#include "esp_partition.h"
+#include "crypto_hash/crypto_hash.h"
+
+// Passes len bytes of part from offset to hash_update(). The range is mapped
+// CONFIG_HASH_PARTITION_MMAP_SIZE bytes at a time with esp_partition_mmap()
+// and hashed in place, so no RAM buffer is needed and nothing is copied out
+// of flash. Encrypted partitions are read decrypted.
+esp_err_t hash_update_partition(hash_ctx_t* ctx, const esp_partition_t* part,
+                                size_t offset, size_t len);
+
+// Hash of the whole partition with provider p (key as for hash_init())
+esp_err_t hash_partition(const hash_provider_t* p, const uint8_t* key,
+                         const esp_partition_t* part, uint8_t* out, size_t outlen);
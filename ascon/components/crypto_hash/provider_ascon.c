@@ -0,0 +1,75 @@
+#include "crypto_hash/crypto_hash.h"
+#include "ascon/hash.h"
+
+// Ascon-Hash256, Ascon-XOF128 and the keyed PRF share one sponge state and
+// differ only in how it starts
+
+static int hash256_start(hash_state_t* st, const uint8_t* key)
+{
+    (void)key;
+    ascon_hash256_start(&st->ascon);
+    return 0;
+}
+
+static int xof128_start(hash_state_t* st, const uint8_t* key)
+{
+    (void)key;
+    ascon_xof128_start(&st->ascon);
+    return 0;
+}
+
+static int prf_start(hash_state_t* st, const uint8_t* key)
+{
+    ascon_prf_start(&st->ascon, key);
+    return 0;
+}
+
+static int ascon_update(hash_state_t* st, const uint8_t* in, size_t len)
+{
+    ascon_hash_update(&st->ascon, in, len);
+    return 0;
+}
+
+static int ascon_finish(hash_state_t* st, uint8_t* out, size_t outlen)
+{
+    ascon_hash_squeeze(&st->ascon, out, outlen);
+    ascon_hash_wipe(&st->ascon);
+    return 0;
+}
+
+static void ascon_abort(hash_state_t* st)
+{
+    ascon_hash_wipe(&st->ascon);
+}
+
+const hash_provider_t hash_provider_ascon_hash256 = {
+    .name = "ascon-hash256",
+    .digest_len = ASCON_HASH256_LEN,
+    .start = hash256_start,
+    .update = ascon_update,
+    .finish = ascon_finish,
+    .abort = ascon_abort,
+};
+
+const hash_provider_t hash_provider_ascon_xof128 = {
+    .name = "ascon-xof128",
+    .digest_len = 32,
+    .xof = 1,
+    .start = xof128_start,
+    .update = ascon_update,
+    .finish = ascon_finish,
+    .abort = ascon_abort,
+};
+
+// Its default output is a MAC tag. Non-standard (see ascon_prf_start() in
+// ascon/hash.h): not the ascon-c asconmacv13/asconprfv13 Ascon-Mac.
+const hash_provider_t hash_provider_ascon_prf = {
+    .name = "ascon-prf",
+    .key_len = ASCON_PRF_KEY_LEN,
+    .digest_len = ASCON_MAC_LEN,
+    .xof = 1,
+    .start = prf_start,
+    .update = ascon_update,
+    .finish = ascon_finish,
+    .abort = ascon_abort,
+};
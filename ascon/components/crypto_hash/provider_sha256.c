@@ -0,0 +1,39 @@
+#include "crypto_hash/crypto_hash.h"
+#include "mbedtls/sha256.h"
+
+static int sha256_start(hash_state_t* st, const uint8_t* key)
+{
+    (void)key;
+    mbedtls_sha256_init(&st->sha256);
+    int ret = mbedtls_sha256_starts(&st->sha256, 0);
+    if (ret != 0) mbedtls_sha256_free(&st->sha256);
+    return ret;
+}
+
+static int sha256_update(hash_state_t* st, const uint8_t* in, size_t len)
+{
+    return mbedtls_sha256_update(&st->sha256, in, len);
+}
+
+static int sha256_finish(hash_state_t* st, uint8_t* out, size_t outlen)
+{
+    (void)outlen;
+    int ret = mbedtls_sha256_finish(&st->sha256, out);
+    mbedtls_sha256_free(&st->sha256);
+    return ret;
+}
+
+// mbedtls_sha256_free() zeroizes the context
+static void sha256_abort(hash_state_t* st)
+{
+    mbedtls_sha256_free(&st->sha256);
+}
+
+const hash_provider_t hash_provider_sha256 = {
+    .name = "sha256",
+    .digest_len = 32,
+    .start = sha256_start,
+    .update = sha256_update,
+    .finish = sha256_finish,
+    .abort = sha256_abort,
+};
@@ -0,0 +1,77 @@
+// Unity tests for the ascon-prf provider (ESP-IDF unit-test-app layout).
+// The construction is this repo's own (see ascon/hash.h) and has no published
+// test vectors; the ones below were computed with ascon_hash.c and pin its
+// output so a change to it is noticed. Key and message bytes are 00 01 02 ...
+#include <string.h>
+#include "unity.h"
+#include "ascon/hash.h"
+#include "crypto_hash/crypto_hash.h"
+
+typedef struct {
+    size_t len;
+    const char* tag;
+} mac_vector_t;
+
+static const mac_vector_t s_mac[] = {
+    { 0, "CB0E21976AE9DD62C20FE3E027F619B5" },
+    { 1, "52C12E4682506064D77D83AB2177218D" },
+    { 15, "B15B8E5D1882B9E55D2582A5DB191705" },
+    { 16, "30B0682E8BEC6515DB72978A32F0A43A" },
+    { 17, "D6CEB09199D5961EF09D2F2BBCA4D50F" },
+    { 64, "AEA41E347ECD1DCEC08E22CC27CD8FE9" },
+};
+
+static const char s_prf32[] =
+    "30B0682E8BEC6515DB72978A32F0A43ACC0C119B5225405551F17C532451581C";
+
+static void unhex(uint8_t* out, const char* hex)
+{
+    for (size_t i = 0; hex[2 * i]; ++i) {
+        unsigned v = 0;
+        for (int j = 0; j < 2; ++j) {
+            char c = hex[2 * i + j];
+            v = v * 16 + (unsigned)(c <= '9' ? c - '0' : c - 'A' + 10);
+        }
+        out[i] = (uint8_t)v;
+    }
+}
+
+static void counting(uint8_t* p, size_t n)
+{
+    for (size_t i = 0; i < n; ++i) p[i] = (uint8_t)i;
+}
+
+TEST_CASE("ascon_mac matches the fixed vectors", "[crypto_hash]")
+{
+    uint8_t key[ASCON_PRF_KEY_LEN], msg[64], tag[ASCON_MAC_LEN], expected[ASCON_MAC_LEN];
+    counting(key, sizeof(key));
+    counting(msg, sizeof(msg));
+    for (size_t i = 0; i < sizeof(s_mac) / sizeof(s_mac[0]); ++i) {
+        unhex(expected, s_mac[i].tag);
+        ascon_mac(tag, key, msg, s_mac[i].len);
+        TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, tag, ASCON_MAC_LEN);
+        TEST_ASSERT_EQUAL(0, ascon_mac_verify(expected, key, msg, s_mac[i].len));
+        expected[ASCON_MAC_LEN - 1] ^= 1;
+        TEST_ASSERT_NOT_EQUAL(0, ascon_mac_verify(expected, key, msg, s_mac[i].len));
+    }
+}
+
+TEST_CASE("ascon-prf is Ascon-CXOF128 with the key as customization string", "[crypto_hash]")
+{
+    uint8_t key[ASCON_PRF_KEY_LEN], msg[16], out[32], expected[32];
+    counting(key, sizeof(key));
+    counting(msg, sizeof(msg));
+    unhex(expected, s_prf32);
+
+    const hash_provider_t* p = hash_provider_find("ascon-prf");
+    TEST_ASSERT_NOT_NULL(p);
+    TEST_ASSERT_EQUAL(0, hash_compute(p, key, msg, sizeof(msg), out, sizeof(out)));
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, out, sizeof(out));
+
+    ascon_hash_state_t s;
+    TEST_ASSERT_EQUAL(0, ascon_cxof128_start(&s, key, sizeof(key)));
+    ascon_hash_update(&s, msg, sizeof(msg));
+    ascon_hash_squeeze(&s, out, sizeof(out));
+    ascon_hash_wipe(&s);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, out, sizeof(out));
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "nvs.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "sdkconfig.h"
+
+// Crash-safe packet counter for AEAD nonces.
+//
+// Counters are reserved in blocks of CONFIG_NONCE_COUNTER_BLOCK: before any
+// counter of a block is handed out, the end of the block is written to NVS as
+// the high-water mark. nonce_counter_next() then takes counters from RAM with
+// one atomic increment and touches NVS only when a block runs out. After a
+// reset the counter continues at the stored high-water mark, skipping what is
+// left of the block in use, so no counter is handed out twice for a key
+// however the device went down.
+//
+// Two limits end the use of a key: on_rekey is called once when the counter
+// reaches or passes rekey_at, so a new key can be negotiated in time, and
+// on_exhausted once when it reaches or passes limit, from which point
+// nonce_counter_next() fails. A reset may skip over either threshold (it lies
+// in the rest of the block), so nonce_counter_init() calls the hooks itself
+// when the stored mark is already past them. The hooks are armed per boot,
+// so a device still on an old key is reminded again. After switching to a
+// new key, nonce_counter_rekey() starts again at 0 and rearms both hooks.
+
+typedef struct nonce_counter nonce_counter_t;
+
+// Called from the nonce_counter_next() that hands out (or refuses) value, or
+// from nonce_counter_init() with the counter it resumes at
+typedef void (*nonce_counter_hook_t)(nonce_counter_t* nc, uint64_t value, void* arg);
+
+typedef struct {
+    const char* nvs_namespace;     // NVS namespace, e.g. "aead"
+    const char* nvs_key;           // NVS key of the high-water mark (max 15 chars)
+    uint64_t rekey_at;             // 0: no rekey hook
+    uint64_t limit;                // first counter that is refused; 0: UINT64_MAX
+    nonce_counter_hook_t on_rekey;
+    nonce_counter_hook_t on_exhausted;
+    void* arg;                     // passed to the hooks
+} nonce_counter_config_t;
+
+struct nonce_counter {
+    _Atomic uint64_t next;         // next counter to hand out
+    _Atomic uint64_t reserved;     // counters below this are covered by NVS
+    nvs_handle_t nvs;
+    SemaphoreHandle_t lock;        // serializes NVS reservations
+    _Atomic bool rekey_fired;      // latched once on_rekey has been called
+    _Atomic bool exhausted_fired;
+    nonce_counter_config_t cfg;
+};
+
+// Opens the NVS entry, continues at its high-water mark (0 if there is none)
+// and reserves the first block
+esp_err_t nonce_counter_init(nonce_counter_t* nc, const nonce_counter_config_t* cfg);
+
+// Hands out the next counter. Safe from several tasks. Returns
+// ESP_ERR_INVALID_STATE once the limit is reached, or the NVS error if a
+// block could not be reserved (that counter is then skipped).
+esp_err_t nonce_counter_next(nonce_counter_t* nc, uint64_t* value);
+
+// Starts again at 0. Only call this once the previous key is no longer used
+// for encryption, or nonces repeat under it.
+esp_err_t nonce_counter_rekey(nonce_counter_t* nc);
+
+void nonce_counter_deinit(nonce_counter_t* nc);
@@ -0,0 +1,109 @@
+#include "nonce_counter/nonce_counter.h"
+#include <string.h>
+
+#define BLOCK ((uint64_t)CONFIG_NONCE_COUNTER_BLOCK)
+
+// Moves the NVS high-water mark past v. Counters already handed out by other
+// tasks that also ran out of the block wait here and are covered by the same
+// write.
+static esp_err_t reserve(nonce_counter_t* nc, uint64_t v)
+{
+    esp_err_t err = ESP_OK;
+    xSemaphoreTake(nc->lock, portMAX_DELAY);
+    if (v >= atomic_load(&nc->reserved)) {
+        uint64_t mark = v + BLOCK;
+        if (mark < v) mark = UINT64_MAX;
+        err = nvs_set_u64(nc->nvs, nc->cfg.nvs_key, mark);
+        if (err == ESP_OK) err = nvs_commit(nc->nvs);
+        if (err == ESP_OK) atomic_store(&nc->reserved, mark);
+    }
+    xSemaphoreGive(nc->lock);
+    return err;
+}
+
+// Calls hook for the first counter at or past its threshold only; counters
+// crossing it from several tasks race for the flag
+static void fire_once(nonce_counter_t* nc, _Atomic bool* fired, nonce_counter_hook_t hook, uint64_t v)
+{
+    if (hook && !atomic_load_explicit(fired, memory_order_relaxed) && !atomic_exchange(fired, true)) {
+        hook(nc, v, nc->cfg.arg);
+    }
+}
+
+esp_err_t nonce_counter_init(nonce_counter_t* nc, const nonce_counter_config_t* cfg)
+{
+    memset(nc, 0, sizeof(*nc));
+    nc->cfg = *cfg;
+    if (nc->cfg.limit == 0) nc->cfg.limit = UINT64_MAX;
+    nc->lock = xSemaphoreCreateMutex();
+    if (!nc->lock) return ESP_ERR_NO_MEM;
+    esp_err_t err = nvs_open(cfg->nvs_namespace, NVS_READWRITE, &nc->nvs);
+    if (err != ESP_OK) {
+        vSemaphoreDelete(nc->lock);
+        return err;
+    }
+    uint64_t mark = 0;
+    err = nvs_get_u64(nc->nvs, cfg->nvs_key, &mark);
+    if (err == ESP_ERR_NVS_NOT_FOUND) {
+        mark = 0;
+        err = ESP_OK;
+    }
+    if (err == ESP_OK) {
+        // Everything below the mark may have been used before the reset
+        atomic_store(&nc->next, mark);
+        atomic_store(&nc->reserved, mark);
+        // Past the limit nothing is handed out, so no block is needed
+        if (mark < nc->cfg.limit) err = reserve(nc, mark);
+    }
+    if (err == ESP_OK) {
+        // The thresholds may have been in the part of the last block that
+        // the reset skipped; next() would then only see counters beyond them
+        if (nc->cfg.rekey_at && mark >= nc->cfg.rekey_at) {
+            fire_once(nc, &nc->rekey_fired, nc->cfg.on_rekey, mark);
+        }
+        if (mark >= nc->cfg.limit) fire_once(nc, &nc->exhausted_fired, nc->cfg.on_exhausted, mark);
+    }
+    if (err != ESP_OK) nonce_counter_deinit(nc);
+    return err;
+}
+
+esp_err_t nonce_counter_next(nonce_counter_t* nc, uint64_t* value)
+{
+    // On chips without 64-bit atomic instructions this is the toolchain's
+    // short critical section, still no lock or flash access
+    uint64_t v = atomic_fetch_add_explicit(&nc->next, 1, memory_order_relaxed);
+    if (v >= nc->cfg.limit) {
+        fire_once(nc, &nc->exhausted_fired, nc->cfg.on_exhausted, v);
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (v >= atomic_load_explicit(&nc->reserved, memory_order_acquire)) {
+        esp_err_t err = reserve(nc, v);
+        if (err != ESP_OK) return err;
+    }
+    if (nc->cfg.rekey_at && v >= nc->cfg.rekey_at) fire_once(nc, &nc->rekey_fired, nc->cfg.on_rekey, v);
+    *value = v;
+    return ESP_OK;
+}
+
+esp_err_t nonce_counter_rekey(nonce_counter_t* nc)
+{
+    xSemaphoreTake(nc->lock, portMAX_DELAY);
+    esp_err_t err = nvs_set_u64(nc->nvs, nc->cfg.nvs_key, BLOCK);
+    if (err == ESP_OK) err = nvs_commit(nc->nvs);
+    if (err == ESP_OK) {
+        atomic_store(&nc->reserved, BLOCK);
+        atomic_store(&nc->next, 0);
+        atomic_store(&nc->rekey_fired, false);
+        atomic_store(&nc->exhausted_fired, false);
+    }
+    xSemaphoreGive(nc->lock);
+    return err;
+}
+
+void nonce_counter_deinit(nonce_counter_t* nc)
+{
+    if (nc->nvs) nvs_close(nc->nvs);
+    if (nc->lock) vSemaphoreDelete(nc->lock);
+    nc->nvs = 0;
+    nc->lock = NULL;
+}
@@ -0,0 +1,112 @@
+// Unity tests for nonce_counter (ESP-IDF unit-test-app layout). A "reboot"
+// is nonce_counter_deinit() and nonce_counter_init() on the same NVS key.
+#include <inttypes.h>
+#include "unity.h"
+#include "nvs_flash.h"
+#include "nonce_counter/nonce_counter.h"
+
+#define BLOCK ((uint64_t)CONFIG_NONCE_COUNTER_BLOCK)
+
+static int s_rekeys, s_exhausted;
+static uint64_t s_rekey_value, s_exhausted_value;
+
+static void on_rekey(nonce_counter_t* nc, uint64_t value, void* arg)
+{
+    ++s_rekeys;
+    s_rekey_value = value;
+}
+
+static void on_exhausted(nonce_counter_t* nc, uint64_t value, void* arg)
+{
+    ++s_exhausted;
+    s_exhausted_value = value;
+}
+
+static void setup(void)
+{
+    esp_err_t err = nvs_flash_init();
+    if (err == ESP_ERR_NVS_NO_FREE_PAGES || err == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+        TEST_ESP_OK(nvs_flash_erase());
+        err = nvs_flash_init();
+    }
+    TEST_ESP_OK(err);
+    nvs_handle_t h;
+    TEST_ESP_OK(nvs_open("nc_test", NVS_READWRITE, &h));
+    nvs_erase_all(h);
+    TEST_ESP_OK(nvs_commit(h));
+    nvs_close(h);
+    s_rekeys = s_exhausted = 0;
+}
+
+static uint64_t take_until(nonce_counter_t* nc, uint64_t last)
+{
+    uint64_t v = 0;
+    do {
+        TEST_ESP_OK(nonce_counter_next(nc, &v));
+    } while (v < last);
+    return v;
+}
+
+TEST_CASE("nonce_counter resumes past everything handed out", "[nonce_counter]")
+{
+    setup();
+    const nonce_counter_config_t cfg = { .nvs_namespace = "nc_test", .nvs_key = "ctr" };
+    nonce_counter_t nc;
+    TEST_ESP_OK(nonce_counter_init(&nc, &cfg));
+    uint64_t last = take_until(&nc, BLOCK + 5);
+    nonce_counter_deinit(&nc);
+
+    TEST_ESP_OK(nonce_counter_init(&nc, &cfg));
+    uint64_t v;
+    TEST_ESP_OK(nonce_counter_next(&nc, &v));
+    TEST_ASSERT_TRUE(v > last);
+    TEST_ASSERT_EQUAL_UINT64(2 * BLOCK, v);
+    nonce_counter_deinit(&nc);
+}
+
+TEST_CASE("nonce_counter hooks fire for thresholds skipped by a reboot", "[nonce_counter]")
+{
+    setup();
+    // Both thresholds sit in the middle of a block, where a reboot skips them
+    const nonce_counter_config_t cfg = {
+        .nvs_namespace = "nc_test",
+        .nvs_key = "ctr",
+        .rekey_at = BLOCK + BLOCK / 2,
+        .limit = 2 * BLOCK + BLOCK / 2,
+        .on_rekey = on_rekey,
+        .on_exhausted = on_exhausted,
+    };
+    nonce_counter_t nc;
+    TEST_ESP_OK(nonce_counter_init(&nc, &cfg));
+    take_until(&nc, BLOCK + 1);
+    TEST_ASSERT_EQUAL(0, s_rekeys);
+    nonce_counter_deinit(&nc);
+
+    // Resumes at 2 * BLOCK, past rekey_at, without handing out rekey_at
+    TEST_ESP_OK(nonce_counter_init(&nc, &cfg));
+    TEST_ASSERT_EQUAL(1, s_rekeys);
+    TEST_ASSERT_EQUAL_UINT64(2 * BLOCK, s_rekey_value);
+    uint64_t v;
+    TEST_ESP_OK(nonce_counter_next(&nc, &v));
+    TEST_ASSERT_EQUAL_UINT64(2 * BLOCK, v);
+    TEST_ASSERT_EQUAL(1, s_rekeys);
+    nonce_counter_deinit(&nc);
+
+    // Resumes at 3 * BLOCK, past the limit; the hooks are armed per boot, so
+    // on_rekey reminds again
+    TEST_ESP_OK(nonce_counter_init(&nc, &cfg));
+    TEST_ASSERT_EQUAL(2, s_rekeys);
+    TEST_ASSERT_EQUAL(1, s_exhausted);
+    TEST_ASSERT_EQUAL_UINT64(3 * BLOCK, s_exhausted_value);
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, nonce_counter_next(&nc, &v));
+    TEST_ASSERT_EQUAL(1, s_exhausted);
+
+    // A new key starts at 0 and rearms both hooks
+    TEST_ESP_OK(nonce_counter_rekey(&nc));
+    TEST_ESP_OK(nonce_counter_next(&nc, &v));
+    TEST_ASSERT_EQUAL_UINT64(0, v);
+    take_until(&nc, cfg.rekey_at);
+    TEST_ASSERT_EQUAL(3, s_rekeys);
+    TEST_ASSERT_EQUAL_UINT64(cfg.rekey_at, s_rekey_value);
+    nonce_counter_deinit(&nc);
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "sdkconfig.h"
+
+// Replay protection for the 64-bit packet counter carried in the nonce.
+//
+// Each sender has an RFC 6479 sliding window: a ring of 64-bit blocks holding
+// one bit per counter, plus the highest counter accepted so far. Checking and
+// recording a counter is O(1); moving the window forward clears only the
+// blocks it slides over. Senders are kept in a fixed-size hash table keyed by
+// source address and key ID, with least-recently-used eviction.
+//
+// The check is split so forged packets cannot move a window:
+//
+//   if (replay_check(&table, &peer, ctr) != REPLAY_OK) drop;   // before decrypt
+//   if (aead_ctx_decrypt(...) != 0) drop;
+//   replay_accept(&table, &peer, ctr);                         // after the tag verified
+//
+// Replays are then rejected at the cost of a hash lookup and a bit test rather
+// than an AEAD verification.
+//
+// The source address is not authenticated. With one key shared by several
+// senders, a captured packet re-sent from another address lands in that
+// address's window and is accepted again; an evicted sender gets a fresh
+// window as well. Use per-sender keys (distinct key IDs) or put a sender ID
+// into the AD and key the table by it where that matters.
+
+#define REPLAY_WINDOW_BLOCKS CONFIG_REPLAY_WINDOW_BLOCKS
+#define REPLAY_WINDOW_SIZE   ((REPLAY_WINDOW_BLOCKS - 1) * 64)
+#define REPLAY_TABLE_SIZE    CONFIG_REPLAY_TABLE_SIZE
+
+typedef enum {
+    REPLAY_OK = 0,   // not seen yet
+    REPLAY_DUP,      // inside the window and already received
+    REPLAY_OLD,      // too far behind the window to tell
+    REPLAY_INVALID,  // peer->addr_len is larger than the address field
+} replay_status_t;
+
+typedef struct {
+    uint64_t top;   // highest counter accepted
+    uint64_t bitmap[REPLAY_WINDOW_BLOCKS];
+} replay_window_t;
+
+void replay_window_init(replay_window_t* w);
+
+// Status of ctr, without changing w
+replay_status_t replay_window_check(const replay_window_t* w, uint64_t ctr);
+
+// Records ctr; returns the status replay_window_check() would have returned
+// and changes nothing unless that is REPLAY_OK
+replay_status_t replay_window_accept(replay_window_t* w, uint64_t ctr);
+
+#define REPLAY_ADDR_MAX 16
+
+// Sender identity: address bytes (4 for IPv4, 16 for IPv6) and key ID
+typedef struct {
+    uint8_t addr[REPLAY_ADDR_MAX];
+    uint8_t addr_len;
+    uint32_t key_id;
+} replay_peer_t;
+
+typedef struct {
+    replay_peer_t peer;
+    replay_window_t window;
+    uint16_t hnext;       // next entry in the hash chain
+    uint16_t prev, next;  // LRU list, most recent first
+} replay_entry_t;
+
+// Power of two, at least twice the table size
+#define REPLAY_BUCKETS (REPLAY_TABLE_SIZE <= 16 ? 32 : REPLAY_TABLE_SIZE <= 128 ? 256 : \
+                        REPLAY_TABLE_SIZE <= 1024 ? 2048 : 8192)
+
+typedef struct {
+    replay_entry_t entries[REPLAY_TABLE_SIZE];
+    uint16_t buckets[REPLAY_BUCKETS];
+    uint16_t head, tail;  // most and least recently used entry
+    uint16_t count;
+    uint32_t seed;
+} replay_table_t;
+
+// seed randomizes the hash (e.g. esp_random()) so senders can't be chosen to
+// collide
+void replay_table_init(replay_table_t* t, uint32_t seed);
+
+// Status of ctr from peer, without changing the table. A sender not in the
+// table has not sent anything yet, so everything is REPLAY_OK. Both functions
+// return REPLAY_INVALID for an addr_len above REPLAY_ADDR_MAX.
+replay_status_t replay_check(const replay_table_t* t, const replay_peer_t* peer, uint64_t ctr);
+
+// Records ctr from peer once its packet has authenticated. A new sender is
+// added, evicting the least recently used one if the table is full.
+replay_status_t replay_accept(replay_table_t* t, const replay_peer_t* peer, uint64_t ctr);
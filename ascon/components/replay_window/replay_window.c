@@ -0,0 +1,132 @@
+#include "replay_window/replay_window.h"
+#include <string.h>
+
+_Static_assert((REPLAY_WINDOW_BLOCKS & (REPLAY_WINDOW_BLOCKS - 1)) == 0,
+               "CONFIG_REPLAY_WINDOW_BLOCKS must be a power of two");
+
+#define BLOCK_BITS 64
+#define BLOCK_SHIFT 6
+#define BLOCK_MASK (REPLAY_WINDOW_BLOCKS - 1)
+#define NIL 0xffff
+
+void replay_window_init(replay_window_t* w)
+{
+    memset(w, 0, sizeof(*w));
+}
+
+replay_status_t replay_window_check(const replay_window_t* w, uint64_t ctr)
+{
+    if (ctr > w->top) return REPLAY_OK;
+    if (w->top - ctr >= REPLAY_WINDOW_SIZE) return REPLAY_OLD;
+    uint64_t block = w->bitmap[(ctr >> BLOCK_SHIFT) & BLOCK_MASK];
+    return (block >> (ctr & (BLOCK_BITS - 1)) & 1) ? REPLAY_DUP : REPLAY_OK;
+}
+
+replay_status_t replay_window_accept(replay_window_t* w, uint64_t ctr)
+{
+    replay_status_t st = replay_window_check(w, ctr);
+    if (st != REPLAY_OK) return st;
+    if (ctr > w->top) {
+        // Clear the blocks the window slides over, at most all of them
+        uint64_t cur = w->top >> BLOCK_SHIFT;
+        uint64_t diff = (ctr >> BLOCK_SHIFT) - cur;
+        if (diff > REPLAY_WINDOW_BLOCKS) diff = REPLAY_WINDOW_BLOCKS;
+        for (uint64_t i = 1; i <= diff; ++i) {
+            w->bitmap[(cur + i) & BLOCK_MASK] = 0;
+        }
+        w->top = ctr;
+    }
+    w->bitmap[(ctr >> BLOCK_SHIFT) & BLOCK_MASK] |= (uint64_t)1 << (ctr & (BLOCK_BITS - 1));
+    return REPLAY_OK;
+}
+
+// Sender table: hash chains through hnext, LRU order through prev/next
+
+static uint32_t peer_hash(const replay_table_t* t, const replay_peer_t* p)
+{
+    // FNV-1a over the seed, key ID and address
+    uint32_t h = 2166136261u ^ t->seed;
+    uint8_t k[4] = { (uint8_t)p->key_id, (uint8_t)(p->key_id >> 8),
+                     (uint8_t)(p->key_id >> 16), (uint8_t)(p->key_id >> 24) };
+    for (size_t i = 0; i < sizeof(k); ++i) h = (h ^ k[i]) * 16777619u;
+    for (size_t i = 0; i < p->addr_len; ++i) h = (h ^ p->addr[i]) * 16777619u;
+    h ^= h >> 16;
+    return h & (REPLAY_BUCKETS - 1);
+}
+
+static int peer_equal(const replay_peer_t* a, const replay_peer_t* b)
+{
+    return a->key_id == b->key_id && a->addr_len == b->addr_len &&
+           memcmp(a->addr, b->addr, a->addr_len) == 0;
+}
+
+static uint16_t find(const replay_table_t* t, const replay_peer_t* p, uint32_t h)
+{
+    for (uint16_t i = t->buckets[h]; i != NIL; i = t->entries[i].hnext) {
+        if (peer_equal(&t->entries[i].peer, p)) return i;
+    }
+    return NIL;
+}
+
+static void lru_unlink(replay_table_t* t, uint16_t i)
+{
+    replay_entry_t* e = &t->entries[i];
+    if (e->prev != NIL) t->entries[e->prev].next = e->next; else t->head = e->next;
+    if (e->next != NIL) t->entries[e->next].prev = e->prev; else t->tail = e->prev;
+}
+
+static void lru_push_front(replay_table_t* t, uint16_t i)
+{
+    replay_entry_t* e = &t->entries[i];
+    e->prev = NIL;
+    e->next = t->head;
+    if (t->head != NIL) t->entries[t->head].prev = i; else t->tail = i;
+    t->head = i;
+}
+
+static void hash_remove(replay_table_t* t, uint16_t i)
+{
+    uint16_t* link = &t->buckets[peer_hash(t, &t->entries[i].peer)];
+    while (*link != i) link = &t->entries[*link].hnext;
+    *link = t->entries[i].hnext;
+}
+
+void replay_table_init(replay_table_t* t, uint32_t seed)
+{
+    memset(t->buckets, 0xff, sizeof(t->buckets));
+    t->head = t->tail = NIL;
+    t->count = 0;
+    t->seed = seed;
+}
+
+replay_status_t replay_check(const replay_table_t* t, const replay_peer_t* peer, uint64_t ctr)
+{
+    if (peer->addr_len > REPLAY_ADDR_MAX) return REPLAY_INVALID;
+    uint16_t i = find(t, peer, peer_hash(t, peer));
+    return i == NIL ? REPLAY_OK : replay_window_check(&t->entries[i].window, ctr);
+}
+
+replay_status_t replay_accept(replay_table_t* t, const replay_peer_t* peer, uint64_t ctr)
+{
+    if (peer->addr_len > REPLAY_ADDR_MAX) return REPLAY_INVALID;
+    uint32_t h = peer_hash(t, peer);
+    uint16_t i = find(t, peer, h);
+    if (i == NIL) {
+        if (t->count < REPLAY_TABLE_SIZE) {
+            i = t->count++;
+        } else {
+            i = t->tail;
+            lru_unlink(t, i);
+            hash_remove(t, i);
+        }
+        replay_entry_t* e = &t->entries[i];
+        e->peer = *peer;
+        replay_window_init(&e->window);
+        e->hnext = t->buckets[h];
+        t->buckets[h] = i;
+    } else {
+        lru_unlink(t, i);
+    }
+    lru_push_front(t, i);
+    return replay_window_accept(&t->entries[i].window, ctr);
+}
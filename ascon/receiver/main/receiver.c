@@ -13,6 +13,8 @@
 #include "esp_netif.h"
 #include "protocol_examples_common.h"
 #include "crypto_aead/crypto_aead.h"
+#include "replay_window/replay_window.h"
+#include "esp_random.h"
 #include "esp_timer.h"
 
 #define TAG "AEAD_RECV"
@@ -32,6 +34,14 @@ static const uint8_t g_key[AEAD_KEY_LEN] = {
 #endif
 };
 
+// The sender puts its packet counter big-endian into the first 8 nonce bytes
+static uint64_t nonce_counter(const uint8_t* nonce)
+{
+    uint64_t v = 0;
+    for (int i = 0; i < 8; ++i) v = (v << 8) | nonce[i];
+    return v;
+}
+
 static void bytes_to_hex(const uint8_t* in, size_t len, char* out, size_t outlen)
 {
     static const char* hex = "0123456789abcdef";
@@ -73,6 +83,20 @@ void app_main(void)
         return;
     }
 
+    // Expand the key once; dec_us below is the per-packet cost only
+    static aead_ctx_t aead;
+    int64_t k0 = esp_timer_get_time();
+    if (aead_ctx_init(&aead, g_key) != 0) {
+        ESP_LOGE(TAG, "aead key setup failed");
+        close(sock);
+        return;
+    }
+    ESP_LOGI(TAG, "key setup %" PRId64 " us", esp_timer_get_time() - k0);
+
+    // One replay window per sender address; the demo has a single key (ID 0)
+    static replay_table_t replay;
+    replay_table_init(&replay, esp_random());
+
     ESP_LOGI(TAG, "listening on UDP port %d", LISTEN_PORT);
 
     while (1) {
@@ -84,39 +108,55 @@ void app_main(void)
             ESP_LOGE(TAG, "recvfrom failed");
             break;
         }
-        if ((size_t)r < AEAD_NONCE_LEN + AEAD_TAG_LEN) {
+        if ((size_t)r < AEAD_HEADROOM + AEAD_TAILROOM) {
             ESP_LOGE(TAG, "packet too short (%d)", (int)r);
             continue;
         }
 
+        // Decrypt in place behind the nonce header
         const uint8_t* nonce = buf;
-        const uint8_t* ct_and_tag = buf + AEAD_NONCE_LEN;
-        size_t clen = (size_t)r - AEAD_NONCE_LEN;
+        uint8_t* payload = buf + AEAD_HEADROOM;
+        size_t clen = (size_t)r - AEAD_HEADROOM;
+
+        // Drop replays before spending a decryption on them
+        replay_peer_t peer = { .addr_len = 4, .key_id = 0 };
+        memcpy(peer.addr, &src.sin_addr.s_addr, 4);
+        uint64_t ctr = nonce_counter(nonce);
+        replay_status_t rs = replay_check(&replay, &peer, ctr);
+        if (rs != REPLAY_OK) {
+            ESP_LOGW(TAG, "%s ctr=%" PRIu64 " from %s:%d dropped",
+                     rs == REPLAY_DUP ? "replayed" : rs == REPLAY_OLD ? "stale" : "invalid", ctr,
+                     inet_ntoa(src.sin_addr), ntohs(src.sin_port));
+            continue;
+        }
 
         // For demo, use AAD as the incrementing counter; we cannot know it,
         // but sender used counter embedded in nonce high 8 bytes. Reuse those.
         static uint8_t aad[8];
         memcpy(aad, nonce, 8);
 
-        static uint8_t pt[1024];
-        size_t ptlen = 0;
-        int64_t t0 = esp_timer_get_time();
-        int dec = aead_decrypt(pt, &ptlen, ct_and_tag, clen,
-                               aad, sizeof(aad), nonce, g_key);
-        int64_t t1 = esp_timer_get_time();
+        // Log the ciphertext before it is overwritten
         static char nonce_hex[AEAD_NONCE_LEN*2+1];
         bytes_to_hex(nonce, AEAD_NONCE_LEN, nonce_hex, sizeof(nonce_hex));
 
         static char ct_hex[1024];
-        bytes_to_hex(ct_and_tag, clen, ct_hex, sizeof(ct_hex));
+        bytes_to_hex(payload, clen, ct_hex, sizeof(ct_hex));
+
+        size_t ptlen = 0;
+        int64_t t0 = esp_timer_get_time();
+        int dec = aead_ctx_decrypt_inplace(&aead, payload, clen, &ptlen,
+                                           aad, sizeof(aad), nonce);
+        int64_t t1 = esp_timer_get_time();
 
         if (dec == 0) {
-            // Ensure null-terminated for printing
-            size_t print_len = ptlen < sizeof(pt)-1 ? ptlen : sizeof(pt)-1;
-            pt[print_len] = '\0';
+            // Authenticated: only now may the counter move the window
+            replay_accept(&replay, &peer, ctr);
+            // The tag that followed the plaintext is no longer needed, so
+            // there is always room to NUL-terminate for printing
+            payload[ptlen] = '\0';
             ESP_LOGI(TAG, "from %s:%d nonce=%s ct|tag=%s pt=\"%s\" dec_us=%" PRId64,
                      inet_ntoa(src.sin_addr), ntohs(src.sin_port),
-                     nonce_hex, ct_hex, (char*)pt, (t1 - t0));
+                     nonce_hex, ct_hex, (char*)payload, (t1 - t0));
         } else {
             ESP_LOGE(TAG, "auth failure from %s:%d nonce=%s ct|tag=%s",
                      inet_ntoa(src.sin_addr), ntohs(src.sin_port),
@@ -124,5 +164,6 @@ void app_main(void)
         }
     }
 
+    aead_ctx_free(&aead);
     close(sock);
 }
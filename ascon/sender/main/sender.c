@@ -13,6 +13,7 @@
 #include "esp_netif.h"
 #include "protocol_examples_common.h"
 #include "crypto_aead/crypto_aead.h"
+#include "nonce_counter/nonce_counter.h"
 #include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
@@ -46,6 +47,16 @@ static void be64(uint8_t out[8], uint64_t x)
     for (int i = 7; i >= 0; --i) { out[i] = (uint8_t)(x & 0xFF); x >>= 8; }
 }
 
+static void on_rekey(nonce_counter_t* nc, uint64_t value, void* arg)
+{
+    ESP_LOGW(TAG, "counter %" PRIu64 " reached, the key should be replaced", value);
+}
+
+static void on_exhausted(nonce_counter_t* nc, uint64_t value, void* arg)
+{
+    ESP_LOGE(TAG, "counter exhausted at %" PRIu64 ", no more packets under this key", value);
+}
+
 static void bytes_to_hex(const uint8_t* in, size_t len, char* out, size_t outlen)
 {
     static const char* hex = "0123456789abcdef";
@@ -86,40 +97,68 @@ void app_main(void)
         return;
     }
 
-    uint64_t counter = 1;
+    // Expand the key once; enc_us below is the per-packet cost only
+    static aead_ctx_t aead;
+    int64_t k0 = esp_timer_get_time();
+    if (aead_ctx_init(&aead, g_key) != 0) {
+        ESP_LOGE(TAG, "aead key setup failed");
+        close(sock);
+        return;
+    }
+    ESP_LOGI(TAG, "key setup %" PRId64 " us", esp_timer_get_time() - k0);
+
+    // Counters survive resets: NVS holds a high-water mark that is moved
+    // once per CONFIG_NONCE_COUNTER_BLOCK packets
+    static nonce_counter_t nonces;
+    const nonce_counter_config_t nonce_cfg = {
+        .nvs_namespace = "aead",
+        .nvs_key = "tx_ctr",
+        .rekey_at = (uint64_t)1 << 32,
+        .on_rekey = on_rekey,
+        .on_exhausted = on_exhausted,
+    };
+    if (nonce_counter_init(&nonces, &nonce_cfg) != ESP_OK) {
+        ESP_LOGE(TAG, "nonce counter init failed");
+        aead_ctx_free(&aead);
+        close(sock);
+        return;
+    }
+    uint64_t counter = 0;
     const char* plaintext = "Hello from ESP32!";
 
     while (1) {
-        static uint8_t nonce[AEAD_NONCE_LEN] = {0};
+        // nonce | ciphertext | tag, built and encrypted in one buffer
+        static uint8_t packet[AEAD_HEADROOM + 512 + AEAD_TAILROOM];
+        uint8_t* nonce = packet;
+        uint8_t* payload = packet + AEAD_HEADROOM;
+        if (nonce_counter_next(&nonces, &counter) != ESP_OK) {
+            ESP_LOGE(TAG, "no nonce available");
+            break;
+        }
+        memset(nonce, 0, AEAD_NONCE_LEN);
         be64(nonce, counter);
 
         uint8_t aad[8];
         be64(aad, counter);
 
-        const uint8_t* m = (const uint8_t*)plaintext;
         size_t mlen = strlen(plaintext);
+        if (mlen > sizeof(packet) - AEAD_HEADROOM - AEAD_TAILROOM) {
+            ESP_LOGE(TAG, "plaintext too large");
+            break;
+        }
+        memcpy(payload, plaintext, mlen);
 
-        static uint8_t ct_and_tag[512];
         size_t clen = 0;
         int64_t t0 = esp_timer_get_time();
-        int enc = aead_encrypt(ct_and_tag, &clen, m, mlen,
-                               aad, sizeof(aad),
-                               nonce, g_key);
+        int enc = aead_ctx_encrypt_inplace(&aead, payload, mlen, &clen,
+                                           aad, sizeof(aad), nonce);
         int64_t t1 = esp_timer_get_time();
         if (enc != 0) {
             ESP_LOGE(TAG, "ascon encrypt failed");
             break;
         }
 
-        static uint8_t packet[AEAD_NONCE_LEN + 512];
-        if (clen > sizeof(ct_and_tag)) {
-            ESP_LOGE(TAG, "ciphertext too large");
-            break;
-        }
-        memcpy(packet, nonce, AEAD_NONCE_LEN);
-        memcpy(packet + AEAD_NONCE_LEN, ct_and_tag, clen);
-
-        ssize_t sent = sendto(sock, packet, AEAD_NONCE_LEN + clen, 0,
+        ssize_t sent = sendto(sock, packet, AEAD_HEADROOM + clen, 0,
                               (struct sockaddr*)&dest, sizeof(dest));
         if (sent < 0) {
             ESP_LOGE(TAG, "sendto failed");
@@ -129,13 +168,14 @@ void app_main(void)
         static char nonce_hex[AEAD_NONCE_LEN*2+1];
         static  char ct_hex[1024];
         bytes_to_hex(nonce, AEAD_NONCE_LEN, nonce_hex, sizeof(nonce_hex));
-        bytes_to_hex(ct_and_tag, clen, ct_hex, sizeof(ct_hex));
+        bytes_to_hex(payload, clen, ct_hex, sizeof(ct_hex));
         ESP_LOGI(TAG, "ctr=%" PRIu64 " nonce=%s pt=\"%s\" ct|tag=%s enc_us=%" PRId64,
                  counter, nonce_hex, plaintext, ct_hex, (t1 - t0));
 
-        counter++;
         vTaskDelay(pdMS_TO_TICKS(2000));
     }
 
+    nonce_counter_deinit(&nonces);
+    aead_ctx_free(&aead);
     close(sock);
 }
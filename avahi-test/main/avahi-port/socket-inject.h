@@ -0,0 +1,23 @@
+#ifndef SOCKET_INJECT_H
+#define SOCKET_INJECT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "avahi-common/address.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Packet injection for the mDNS fuzzer (CONFIG_AVAHI_TEST_FUZZER).
+ *
+ * The next avahi_recv_dns_packet_ipv4() call returns a copy of data as if it
+ * had been received from src:src_port on the mDNS multicast group, without
+ * touching the socket. The caller keeps ownership of data. */
+void avahi_port_inject_ipv4(const uint8_t *data, size_t size, const AvahiIPv4Address *src, uint16_t src_port);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SOCKET_INJECT_H */
@@ -11,6 +11,10 @@
 #include "assert.h"
 #include "avahi-core/socket.h"
 #include <sys/ioctl.h>  // Add this for ioctl
+#include "sdkconfig.h"
+#ifdef CONFIG_AVAHI_TEST_FUZZER
+#include "socket-inject.h"
+#endif
 
 static void mdns_mcast_group_ipv4(struct sockaddr_in *ret_sa) {
     assert(ret_sa);
@@ -132,6 +136,60 @@ int avahi_send_dns_packet_ipv4(
     return 0;
 }
 
+#ifdef CONFIG_AVAHI_TEST_FUZZER
+static struct {
+    const uint8_t *data;
+    size_t size;
+    AvahiIPv4Address src;
+    uint16_t src_port;
+} injected;
+
+void avahi_port_inject_ipv4(const uint8_t *data, size_t size, const AvahiIPv4Address *src, uint16_t src_port) {
+    injected.data = data;
+    injected.size = size;
+    injected.src = *src;
+    injected.src_port = src_port;
+}
+
+// Same result as a recvfrom() of the injected datagram on the multicast socket
+static AvahiDnsPacket *recv_injected_ipv4(
+        AvahiIPv4Address *ret_src_address,
+        uint16_t *ret_src_port,
+        AvahiIPv4Address *ret_dst_address,
+        AvahiIfIndex *ret_iface,
+        uint8_t *ret_ttl) {
+
+    AvahiDnsPacket *p = avahi_dns_packet_new(injected.size + AVAHI_DNS_PACKET_EXTRA_SIZE);
+    struct sockaddr_in group;
+
+    if (!p)
+        return NULL;
+
+    p->size = injected.size < p->max_size ? injected.size : p->max_size;
+    memcpy(AVAHI_DNS_PACKET_DATA(p), injected.data, p->size);
+    injected.data = NULL;
+
+    if (ret_src_port)
+        *ret_src_port = injected.src_port;
+
+    if (ret_src_address)
+        *ret_src_address = injected.src;
+
+    if (ret_dst_address) {
+        mdns_mcast_group_ipv4(&group);
+        memcpy(&ret_dst_address->address, &group.sin_addr, sizeof(struct in_addr));
+    }
+
+    if (ret_ttl)
+        *ret_ttl = 255;
+
+    if (ret_iface)
+        *ret_iface = 1;
+
+    return p;
+}
+#endif
+
 AvahiDnsPacket *avahi_recv_dns_packet_ipv4(
         int fd,
         AvahiIPv4Address *ret_src_address,
@@ -148,6 +206,11 @@ AvahiDnsPacket *avahi_recv_dns_packet_ipv4(
 
     assert(fd >= 0);
 
+#ifdef CONFIG_AVAHI_TEST_FUZZER
+    if (injected.data)
+        return recv_injected_ipv4(ret_src_address, ret_src_port, ret_dst_address, ret_iface, ret_ttl);
+#endif
+
     if (ioctl(fd, FIONREAD, &ms) < 0) {
         avahi_log_warn("ioctl(FIONREAD) failed: %s", strerror(errno));
         goto fail;
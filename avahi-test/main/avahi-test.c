@@ -14,6 +14,9 @@
 #include "protocol_examples_common.h"
 #include "sys/utsname.h"
 #include <string.h>
+#ifdef CONFIG_AVAHI_TEST_FUZZER
+#include "fuzz/mdns_fuzzer.h"
+#endif
 
 // AvahiServer *avahi_server = NULL;
 // AvahiSimplePoll *simple_poll_api = NULL;
@@ -126,6 +129,9 @@ static void quit(AVAHI_GCC_UNUSED AvahiTimeout *timeout, AVAHI_GCC_UNUSED void *
 
 void app_main(void)
 {
+#ifdef CONFIG_AVAHI_TEST_FUZZER
+    exit(avahi_fuzzer_run());
+#endif
 #ifndef CONFIG_IDF_TARGET_LINUX
     ESP_ERROR_CHECK(nvs_flash_init());
     ESP_ERROR_CHECK(esp_netif_init());
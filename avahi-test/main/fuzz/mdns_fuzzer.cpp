@@ -0,0 +1,528 @@
+// In-process mDNS packet fuzzer for the avahi port (IDF Linux target).
+//
+// Packets from mdns_packet.hpp are handed to avahi_recv_dns_packet_ipv4()
+// through the port's injection hook, and the server's own socket callback is
+// invoked directly, so each packet takes the same path as a datagram read
+// from the network without a syscall. The server publishes a service and
+// runs browsers, so responses land in the cache and probes can conflict.
+//
+// Findings:
+// - crash: sanitizer report or signal; the packet is saved to
+//   mdns-crash-<seed>-<index>.bin
+// - heap growth: avahi's live heap (counted through avahi_set_allocator)
+//   exceeds the warm-up level by CONFIG_AVAHI_FUZZ_HEAP_LIMIT_KB
+// - leak: avahi allocations still live after avahi_server_free()
+
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "sdkconfig.h"
+#include "avahi-common/error.h"
+#include "avahi-common/malloc.h"
+#include "avahi-common/simple-watch.h"
+#include "avahi-core/core.h"
+#include "avahi-core/log.h"
+#include "avahi-core/lookup.h"
+#include "avahi-core/publish.h"
+#include "socket-inject.h"
+
+#include "mdns_fuzzer.h"
+#include "mdns_packet.hpp"
+
+#if defined(__SANITIZE_ADDRESS__)
+#define FUZZ_ASAN 1
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define FUZZ_ASAN 1
+#endif
+#endif
+
+#ifdef FUZZ_ASAN
+// Abort after the report so that the SIGABRT handler saves the packet; the
+// leak check at exit would also report FreeRTOS simulator threads
+extern "C" const char* __asan_default_options(void)
+{
+    return "abort_on_error=1:detect_leaks=0";
+}
+#endif
+
+namespace {
+
+constexpr uint64_t kCheckpoint = 1 << 16;       // packets between heap checks
+constexpr int kWarmupCheckpoints = 8;           // until the cache is full
+constexpr uint64_t kPollEvery = 256;            // packets between timeout runs
+constexpr uint16_t kMdnsPort = 5353;
+
+// --- Heap accounting -----------------------------------------------------
+
+struct heap_stats {
+    size_t live_bytes;
+    size_t live_blocks;
+    size_t peak_bytes;
+};
+
+heap_stats heap;
+
+// Keeps the malloc alignment for the block after the size header
+constexpr size_t kBlockHeader = alignof(max_align_t) > sizeof(size_t) ? alignof(max_align_t) : sizeof(size_t);
+
+void* counted_malloc(size_t size)
+{
+    auto* block = static_cast<unsigned char*>(malloc(kBlockHeader + size));
+    if (!block) {
+        return nullptr;
+    }
+    memcpy(block, &size, sizeof(size));
+    heap.live_bytes += size;
+    heap.live_blocks++;
+    if (heap.live_bytes > heap.peak_bytes) {
+        heap.peak_bytes = heap.live_bytes;
+    }
+    return block + kBlockHeader;
+}
+
+void counted_free(void* p)
+{
+    if (!p) {
+        return;
+    }
+    auto* block = static_cast<unsigned char*>(p) - kBlockHeader;
+    size_t size;
+    memcpy(&size, block, sizeof(size));
+    heap.live_bytes -= size;
+    heap.live_blocks--;
+    free(block);
+}
+
+void* counted_realloc(void* p, size_t size)
+{
+    if (!p) {
+        return counted_malloc(size);
+    }
+    auto* block = static_cast<unsigned char*>(p) - kBlockHeader;
+    size_t old_size;
+    memcpy(&old_size, block, sizeof(old_size));
+    auto* moved = static_cast<unsigned char*>(realloc(block, kBlockHeader + size));
+    if (!moved) {
+        return nullptr;
+    }
+    memcpy(moved, &size, sizeof(size));
+    heap.live_bytes = heap.live_bytes - old_size + size;
+    if (heap.live_bytes > heap.peak_bytes) {
+        heap.peak_bytes = heap.live_bytes;
+    }
+    return moved + kBlockHeader;
+}
+
+void* counted_calloc(size_t n, size_t size)
+{
+    if (size && n > SIZE_MAX / size) {
+        return nullptr;
+    }
+    void* p = counted_malloc(n * size);
+    if (p) {
+        memset(p, 0, n * size);
+    }
+    return p;
+}
+
+const AvahiAllocator counted_allocator = { counted_malloc, counted_free, counted_realloc, counted_calloc };
+
+// --- Crash capture -------------------------------------------------------
+
+uint64_t run_seed;
+uint64_t run_first;
+uint64_t current_index;
+const uint8_t* current_packet;
+size_t current_size;
+
+// Signal-safe decimal formatting
+char* append_u64(char* p, uint64_t v)
+{
+    char digits[20];
+    int n = 0;
+    do {
+        digits[n++] = static_cast<char>('0' + v % 10);
+        v /= 10;
+    } while (v);
+    while (n) {
+        *p++ = digits[--n];
+    }
+    return p;
+}
+
+char* append_str(char* p, const char* s)
+{
+    while (*s) {
+        *p++ = *s++;
+    }
+    return p;
+}
+
+void save_current_packet(int sig)
+{
+    char name[96];
+    char* p = append_str(name, "mdns-crash-");
+    p = append_u64(p, run_seed);
+    *p++ = '-';
+    p = append_u64(p, current_index);
+    p = append_str(p, ".bin");
+    *p = '\0';
+
+    int fd = open(name, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd >= 0 && current_packet) {
+        ssize_t unused = write(fd, current_packet, current_size);
+        (void)unused;
+    }
+    if (fd >= 0) {
+        close(fd);
+    }
+
+    char msg[256];
+    p = append_str(msg, "\n[mdns-fuzz] signal ");
+    p = append_u64(p, static_cast<uint64_t>(sig));
+    p = append_str(p, " at packet ");
+    p = append_u64(p, current_index);
+    p = append_str(p, ", saved to ");
+    p = append_str(p, name);
+    p = append_str(p, "\n[mdns-fuzz] reproduce with AVAHI_FUZZ_SEED=");
+    p = append_u64(p, run_seed);
+    p = append_str(p, " AVAHI_FUZZ_FIRST=");
+    p = append_u64(p, run_first);
+    p = append_str(p, " AVAHI_FUZZ_PACKETS=");
+    p = append_u64(p, current_index + 1 - run_first);
+    p = append_str(p, "\n");
+    ssize_t unused = write(STDERR_FILENO, msg, static_cast<size_t>(p - msg));
+    (void)unused;
+
+    signal(sig, SIG_DFL);
+    raise(sig);
+}
+
+void install_crash_handlers()
+{
+    struct sigaction sa = {};
+    sa.sa_handler = save_current_packet;
+    sa.sa_flags = SA_RESETHAND;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGABRT, &sa, nullptr);
+#ifndef FUZZ_ASAN
+    // ASan reports these itself and then aborts
+    sigaction(SIGSEGV, &sa, nullptr);
+    sigaction(SIGBUS, &sa, nullptr);
+    sigaction(SIGFPE, &sa, nullptr);
+    sigaction(SIGILL, &sa, nullptr);
+#endif
+}
+
+// --- Server plumbing -----------------------------------------------------
+
+// The simple poll API, with watch_new recording the server's mDNS socket so
+// that its callback can be invoked once per injected packet
+struct mdns_socket {
+    AvahiWatch* watch;
+    int fd;
+    AvahiWatchCallback callback;
+    void* userdata;
+};
+
+AvahiPoll fuzz_poll;
+const AvahiPoll* simple_api;
+mdns_socket mdns;
+
+bool is_mdns_socket(int fd)
+{
+    struct sockaddr_in sa;
+    socklen_t len = sizeof(sa);
+    return getsockname(fd, reinterpret_cast<struct sockaddr*>(&sa), &len) == 0 && sa.sin_family == AF_INET &&
+           ntohs(sa.sin_port) == kMdnsPort;
+}
+
+AvahiWatch* capture_watch_new(const AvahiPoll* api, int fd, AvahiWatchEvent event, AvahiWatchCallback callback,
+                              void* userdata)
+{
+    AvahiWatch* w = simple_api->watch_new(api, fd, event, callback, userdata);
+    if (w && !mdns.watch && (event & AVAHI_WATCH_IN) && is_mdns_socket(fd)) {
+        mdns = { w, fd, callback, userdata };
+    }
+    return w;
+}
+
+void capture_watch_free(AvahiWatch* w)
+{
+    if (w == mdns.watch) {
+        mdns = {};
+    }
+    simple_api->watch_free(w);
+}
+
+unsigned long log_messages;
+
+// Malformed packets are logged at warning level; printing them would
+// dominate the run time
+void count_log(AvahiLogLevel level, const char* txt)
+{
+    if (level <= AVAHI_LOG_ERROR || log_messages++ < 10) {
+        fprintf(stderr, "[avahi] %s\n", txt);
+    }
+}
+
+void group_callback(AvahiServer*, AvahiSEntryGroup*, AvahiEntryGroupState, void*) {}
+
+void service_callback(AvahiSServiceBrowser*, AvahiIfIndex, AvahiProtocol, AvahiBrowserEvent, const char*,
+                      const char*, const char*, AvahiLookupResultFlags, void*)
+{
+}
+
+void type_callback(AvahiSServiceTypeBrowser*, AvahiIfIndex, AvahiProtocol, AvahiBrowserEvent, const char*,
+                   const char*, AvahiLookupResultFlags, void*)
+{
+}
+
+struct fuzz_server {
+    AvahiSimplePoll* poll;
+    AvahiServer* server;
+};
+
+bool start_server(fuzz_server& fs)
+{
+    fs.poll = avahi_simple_poll_new();
+    if (!fs.poll) {
+        return false;
+    }
+    simple_api = avahi_simple_poll_get(fs.poll);
+    fuzz_poll = *simple_api;
+    fuzz_poll.watch_new = capture_watch_new;
+    fuzz_poll.watch_free = capture_watch_free;
+
+    AvahiServerConfig config;
+    avahi_server_config_init(&config);
+    config.publish_hinfo = 0;
+    config.publish_addresses = 0;
+    config.publish_workstation = 0;
+    config.publish_domain = 0;
+    config.n_wide_area_servers = 0;
+    config.enable_wide_area = 0;
+    config.use_ipv4 = 1;
+    config.use_ipv6 = 0;
+
+    int error = 0;
+    fs.server = avahi_server_new(&fuzz_poll, &config, nullptr, nullptr, &error);
+    avahi_server_config_free(&config);
+    if (!fs.server) {
+        fprintf(stderr, "avahi_server_new() failed: %s\n", avahi_strerror(error));
+        return false;
+    }
+    if (!mdns.watch) {
+        fprintf(stderr, "mDNS socket not found (is port 5353 available?)\n");
+        return false;
+    }
+
+    // Keep the server's own queries and responses off the real network
+    struct in_addr loopback;
+    loopback.s_addr = htonl(INADDR_LOOPBACK);
+    setsockopt(mdns.fd, IPPROTO_IP, IP_MULTICAST_IF, &loopback, sizeof(loopback));
+
+    AvahiSEntryGroup* group = avahi_s_entry_group_new(fs.server, group_callback, nullptr);
+    if (group && avahi_server_add_service(fs.server, group, AVAHI_IF_UNSPEC, AVAHI_PROTO_INET,
+                                          static_cast<AvahiPublishFlags>(0), "avahi-fuzz", "_http._tcp", nullptr,
+                                          nullptr, 80, "path=/", "version=1.0", nullptr) == 0) {
+        avahi_s_entry_group_commit(group);
+    }
+    avahi_s_service_browser_new(fs.server, AVAHI_IF_UNSPEC, AVAHI_PROTO_INET, "_http._tcp", nullptr,
+                                AVAHI_LOOKUP_USE_MULTICAST, service_callback, nullptr);
+    avahi_s_service_type_browser_new(fs.server, AVAHI_IF_UNSPEC, AVAHI_PROTO_INET, nullptr,
+                                     AVAHI_LOOKUP_USE_MULTICAST, type_callback, nullptr);
+    return true;
+}
+
+void stop_server(fuzz_server& fs)
+{
+    if (fs.server) {
+        avahi_server_free(fs.server);
+    }
+    if (fs.poll) {
+        avahi_simple_poll_free(fs.poll);
+    }
+    fs = {};
+}
+
+// --- Packet loop ---------------------------------------------------------
+
+AvahiIPv4Address sources[4];
+
+// Mostly on-link peers; loopback with a high port takes the legacy unicast path
+void packet_source(uint64_t index, AvahiIPv4Address* src, uint16_t* port)
+{
+    uint64_t h = index * 0x9E3779B97F4A7C15ull;
+    unsigned which = static_cast<unsigned>(h >> 62);
+    *src = sources[which];
+    *port = which == 3 && (h >> 59 & 7) == 0 ? static_cast<uint16_t>(1024 + (h >> 32 & 0x7FFF)) : kMdnsPort;
+}
+
+void inject(const uint8_t* data, size_t size, uint64_t index)
+{
+    AvahiIPv4Address src;
+    uint16_t port;
+    packet_source(index, &src, &port);
+    avahi_port_inject_ipv4(data, size, &src, port);
+    mdns.callback(mdns.watch, mdns.fd, AVAHI_WATCH_IN, mdns.userdata);
+}
+
+uint64_t env_u64(const char* name, uint64_t fallback)
+{
+    const char* v = getenv(name);
+    return v && *v ? strtoull(v, nullptr, 0) : fallback;
+}
+
+double now_s()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) / 1e9;
+}
+
+int replay(fuzz_server& fs, const char* path)
+{
+    static uint8_t packet[mdns_fuzz::kMaxPacket];
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        fprintf(stderr, "Cannot open %s: %s\n", path, strerror(errno));
+        return 1;
+    }
+    size_t size = fread(packet, 1, sizeof(packet), f);
+    fclose(f);
+
+    current_packet = packet;
+    current_size = size;
+    inject(packet, size, 0);
+    avahi_simple_poll_iterate(fs.poll, 0);
+    printf("Replayed %zu bytes from %s\n", size, path);
+    return 0;
+}
+
+} // namespace
+
+extern "C" int avahi_fuzzer_run(void)
+{
+    static uint8_t packet[mdns_fuzz::kMaxPacket];
+
+    run_seed = env_u64("AVAHI_FUZZ_SEED", CONFIG_AVAHI_FUZZ_SEED);
+    uint64_t first = run_first = env_u64("AVAHI_FUZZ_FIRST", 0);
+    uint64_t count = env_u64("AVAHI_FUZZ_PACKETS", CONFIG_AVAHI_FUZZ_PACKETS);
+    size_t heap_limit = static_cast<size_t>(CONFIG_AVAHI_FUZZ_HEAP_LIMIT_KB) * 1024;
+
+    static const char* const source_text[] = { "0.0.0.2", "0.0.0.3", "192.168.4.2", "127.0.0.1" };
+    for (size_t i = 0; i < sizeof(sources) / sizeof(sources[0]); ++i) {
+        inet_pton(AF_INET, source_text[i], &sources[i].address);
+    }
+
+    avahi_set_allocator(&counted_allocator);
+    avahi_set_log_function(count_log);
+    install_crash_handlers();
+
+    fuzz_server fs = {};
+    if (!start_server(fs)) {
+        stop_server(fs);
+        return 1;
+    }
+    // Let the interface come up and the service start probing
+    for (int i = 0; i < 10; ++i) {
+        avahi_simple_poll_iterate(fs.poll, 0);
+    }
+
+    const char* replay_path = getenv("AVAHI_FUZZ_REPLAY");
+    if (replay_path && *replay_path) {
+        int rc = replay(fs, replay_path);
+        stop_server(fs);
+        return rc;
+    }
+
+    printf("mDNS fuzzer: seed %llu, packets %llu..%llu%s\n", static_cast<unsigned long long>(run_seed),
+           static_cast<unsigned long long>(first), static_cast<unsigned long long>(first + count),
+           count ? "" : " (forever)");
+
+    mdns_fuzz::generator gen(run_seed);
+    current_packet = packet;
+    size_t baseline = 0;
+    int checkpoints = 0;
+    uint64_t last_checkpoint = first;
+    uint64_t faulty = 0;
+    uint64_t report_count = 0;
+    int rc = 0;
+    double start = now_s(), last_report = start;
+
+    uint64_t index = first;
+    for (; count == 0 || index < first + count; ++index) {
+        current_index = index;
+        current_size = gen.build(index, packet);
+        faulty += gen.faults() != 0;
+        inject(packet, current_size, index);
+
+        if ((index + 1) % kPollEvery == 0) {
+            if (avahi_simple_poll_iterate(fs.poll, 0) != 0 || !mdns.watch) {
+                fprintf(stderr, "Server stopped at packet %llu\n", static_cast<unsigned long long>(index));
+                rc = 1;
+                break;
+            }
+        }
+
+        if ((index + 1) % kCheckpoint == 0) {
+            if (checkpoints++ < kWarmupCheckpoints) {
+                baseline = heap.live_bytes > baseline ? heap.live_bytes : baseline;
+            } else if (heap.live_bytes > baseline + heap_limit) {
+                fprintf(stderr,
+                        "\n[mdns-fuzz] heap growth: %zu KB live in %zu blocks, warm-up level %zu KB\n"
+                        "[mdns-fuzz] grew during packets %llu..%llu, reproduce with AVAHI_FUZZ_SEED=%llu "
+                        "AVAHI_FUZZ_FIRST=%llu AVAHI_FUZZ_PACKETS=%llu\n",
+                        heap.live_bytes / 1024, heap.live_blocks, baseline / 1024,
+                        static_cast<unsigned long long>(last_checkpoint), static_cast<unsigned long long>(index),
+                        static_cast<unsigned long long>(run_seed), static_cast<unsigned long long>(first),
+                        static_cast<unsigned long long>(index + 1 - first));
+                rc = 1;
+                ++index;
+                break;
+            }
+            last_checkpoint = index + 1;
+        }
+
+        if ((index & 4095) == 0) {
+            double now = now_s();
+            if (now - last_report >= 1.0) {
+                uint64_t done = index + 1 - first;
+                printf("%llu packets - %.0f packets/s - %.0f%% faulty - heap %zu KB in %zu blocks (peak %zu KB)\n",
+                       static_cast<unsigned long long>(done), static_cast<double>(done - report_count) / (now - last_report),
+                       100.0 * static_cast<double>(faulty) / static_cast<double>(done), heap.live_bytes / 1024,
+                       heap.live_blocks, heap.peak_bytes / 1024);
+                fflush(stdout);
+                report_count = done;
+                last_report = now;
+            }
+        }
+    }
+
+    double elapsed = now_s() - start;
+    uint64_t done = index - first;
+    printf("\n%llu packets in %.1f s (%.0f packets/s), %lu avahi log messages\n",
+           static_cast<unsigned long long>(done), elapsed, elapsed > 0 ? static_cast<double>(done) / elapsed : 0.0,
+           log_messages);
+
+    current_packet = nullptr;
+    stop_server(fs);
+    if (heap.live_blocks) {
+        fprintf(stderr, "[mdns-fuzz] leak: %zu bytes in %zu blocks still allocated after avahi_server_free()\n",
+                heap.live_bytes, heap.live_blocks);
+        rc = 1;
+    }
+    return rc;
+}
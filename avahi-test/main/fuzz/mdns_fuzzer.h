@@ -0,0 +1,21 @@
+#ifndef MDNS_FUZZER_H
+#define MDNS_FUZZER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Runs the in-process mDNS packet fuzzer (CONFIG_AVAHI_TEST_FUZZER) and
+ * returns the process exit code: 0, or 1 if heap growth or a leak was found.
+ * Crashes are saved to mdns-crash-<seed>-<index>.bin before the process dies.
+ *
+ * Environment overrides: AVAHI_FUZZ_SEED, AVAHI_FUZZ_FIRST (first packet
+ * index), AVAHI_FUZZ_PACKETS (0 = run forever), AVAHI_FUZZ_REPLAY (inject
+ * one saved packet and exit). */
+int avahi_fuzzer_run(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MDNS_FUZZER_H */
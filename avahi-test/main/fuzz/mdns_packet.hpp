@@ -0,0 +1,671 @@
+#ifndef MDNS_PACKET_HPP
+#define MDNS_PACKET_HPP
+
+// Structure-aware mDNS packet generator for the avahi fuzzer.
+//
+// Names are built from a small vocabulary of hosts, service instances and
+// service types, so they repeat, compress and collide the way real mDNS
+// traffic does, and records come in RR sets (several records per name and
+// type, with and without the cache-flush bit) so that the cache, browsers
+// and conflict detection get related data. About half of the packets are
+// well-formed; the rest carry one or two of the faults below. A packet only
+// depends on (seed, index), so any packet of a run can be regenerated.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+
+namespace mdns_fuzz {
+
+constexpr size_t kMaxPacket = 9000;     // AVAHI_DNS_PACKET_SIZE_MAX
+constexpr size_t kHeaderSize = 12;
+
+enum rr_type : uint16_t {
+    kTypeA = 1,
+    kTypeNS = 2,
+    kTypeCNAME = 5,
+    kTypePTR = 12,
+    kTypeHINFO = 13,
+    kTypeTXT = 16,
+    kTypeAAAA = 28,
+    kTypeSRV = 33,
+    kTypeOPT = 41,
+    kTypeNSEC = 47,
+    kTypeANY = 255,
+};
+
+constexpr uint16_t kClassIN = 1;
+constexpr uint16_t kCacheFlush = 0x8000;    // unique record (responses)
+constexpr uint16_t kUnicastResponse = 0x8000; // QU question (queries)
+
+enum fault : uint32_t {
+    kPointerLoop = 1u << 0,         // compression pointer to itself
+    kForwardPointer = 1u << 1,      // pointer past its own position
+    kPointerOutOfRange = 1u << 2,   // pointer beyond the packet
+    kPointerChain = 1u << 3,        // pointer to the previous pointer
+    kLongLabel = 1u << 4,           // length byte 64..255 (reserved label types)
+    kLongName = 1u << 5,            // more than 255 bytes uncompressed
+    kBinaryLabel = 1u << 6,         // dots, NULs, backslashes, invalid UTF-8
+    kRdlength = 1u << 7,            // rdlength disagrees with the rdata
+    kCounts = 1u << 8,              // section counts disagree with the records
+    kFlags = 1u << 9,               // opcode, rcode and TC bits
+    kTruncate = 1u << 10,
+    kBitFlip = 1u << 11,
+    kTrailing = 1u << 12,           // bytes after the last record
+};
+constexpr int kFaultKinds = 13;
+
+// splitmix64: cheap, and any (seed, index) pair gives an independent stream
+class rng {
+public:
+    explicit rng(uint64_t seed) : state_(seed) {}
+
+    uint64_t next()
+    {
+        uint64_t z = (state_ += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    uint32_t below(uint32_t n) { return static_cast<uint32_t>(((next() >> 32) * n) >> 32); }
+    bool chance(uint32_t num, uint32_t den) { return below(den) < num; }
+
+private:
+    uint64_t state_;
+};
+
+struct label {
+    const uint8_t* data;
+    uint8_t len;
+};
+
+struct name {
+    static constexpr int kMaxLabels = 12;
+    label labels[kMaxLabels];
+    int count = 0;
+
+    void add(const char* s) { add(reinterpret_cast<const uint8_t*>(s), static_cast<uint8_t>(strlen(s))); }
+    void add(const uint8_t* s, uint8_t len)
+    {
+        if (count < kMaxLabels) {
+            labels[count++] = { s, len };
+        }
+    }
+};
+
+class generator {
+public:
+    explicit generator(uint64_t seed) : seed_(seed), rng_(seed) {}
+
+    // Builds packet `index` of this seed into out (kMaxPacket bytes)
+    size_t build(uint64_t index, uint8_t* out)
+    {
+        rng_ = rng(seed_ ^ (index * 0xD1B54A32D192ED03ull));
+        out_ = out;
+        size_ = kHeaderSize;
+        full_ = false;
+        table_used_ = 0;
+        scratch_used_ = 0;
+        last_pointer_ = 0;
+        names_written_ = 0;
+        memset(out_, 0, kHeaderSize);
+
+        faults_ = 0;
+        if (rng_.chance(1, 2)) {
+            faults_ |= 1u << rng_.below(kFaultKinds);
+            if (rng_.chance(1, 3)) {
+                faults_ |= 1u << rng_.below(kFaultKinds);
+            }
+        }
+        name_fault_at_ = rng_.below(4);
+        rdlength_fault_at_ = rng_.below(3);
+        records_written_ = 0;
+
+        uint16_t counts[4] = {};
+        uint16_t flags = 0;
+        switch (rng_.below(4)) {
+        case 0:
+            query(counts);
+            break;
+        case 1:
+            probe(counts);
+            break;
+        default:
+            response(counts);
+            flags = 0x8400;     // QR, AA
+            break;
+        }
+
+        if (faults_ & kFlags) {
+            flags ^= static_cast<uint16_t>(rng_.below(16) << 11);     // opcode
+            flags ^= static_cast<uint16_t>(rng_.below(16));           // rcode
+            if (rng_.chance(1, 2)) {
+                flags ^= 0x0200;                                    // TC
+            }
+            if (rng_.chance(1, 4)) {
+                flags ^= 0x8000;                                    // QR
+            }
+        }
+        if (faults_ & kCounts) {
+            uint16_t& c = counts[rng_.below(4)];
+            c = rng_.chance(1, 4) ? 0xFFFF : static_cast<uint16_t>(c + rng_.below(7) - 3);
+        }
+        put16_at(0, static_cast<uint16_t>(rng_.chance(1, 8) ? rng_.next() : 0));
+        put16_at(2, flags);
+        for (int i = 0; i < 4; ++i) {
+            put16_at(4 + 2 * i, counts[i]);
+        }
+
+        if (faults_ & kTrailing) {
+            for (uint32_t n = 1 + rng_.below(64); n && size_ < kMaxPacket; --n) {
+                out_[size_++] = static_cast<uint8_t>(rng_.next());
+            }
+        }
+        if (faults_ & kBitFlip) {
+            for (uint32_t n = 1 + rng_.below(4); n; --n) {
+                out_[rng_.below(static_cast<uint32_t>(size_))] ^= static_cast<uint8_t>(1 + rng_.below(255));
+            }
+        }
+        if (faults_ & kTruncate) {
+            size_ = rng_.below(static_cast<uint32_t>(size_));
+        }
+        return size_;
+    }
+
+    // Faults applied to the last packet (a fault can be drawn but find nothing to hit)
+    uint32_t faults() const { return faults_; }
+
+private:
+    static constexpr int kTableSize = 64;
+    static constexpr size_t kScratchSize = 4096;
+
+    // --- Names ---------------------------------------------------------
+
+    enum name_shape { kHost, kServiceType, kInstance, kEnumeration, kSubtype, kReverse, kRandom, kShapes };
+
+    const char* pick(const char* const* list, size_t n) { return list[rng_.below(static_cast<uint32_t>(n))]; }
+
+    // The fuzzer publishes "avahi-fuzz._http._tcp" and the port names the
+    // host "esp32", so probes and responses for those names collide
+    const char* host_label()
+    {
+        static const char* const hosts[] = { "esp32", "esp32-2", "printer", "avahi-fuzz", "TV (2)", "h\xc3\xb4te" };
+        return pick(hosts, sizeof(hosts) / sizeof(hosts[0]));
+    }
+
+    const char* service_label()
+    {
+        static const char* const services[] = { "_http", "_ipp", "_printer", "_airplay", "_mqtt", "_esphomelib" };
+        return pick(services, sizeof(services) / sizeof(services[0]));
+    }
+
+    void add_service_type(name& n)
+    {
+        n.add(rng_.chance(3, 4) ? "_http" : service_label());
+        n.add(rng_.chance(3, 4) ? "_tcp" : "_udp");
+        n.add("local");
+    }
+
+    uint8_t* scratch(size_t len)
+    {
+        if (scratch_used_ + len > kScratchSize) {
+            scratch_used_ = 0;
+        }
+        uint8_t* p = scratch_ + scratch_used_;
+        scratch_used_ += len;
+        return p;
+    }
+
+    void add_random_label(name& n, uint8_t len, bool binary)
+    {
+        static const uint8_t special[] = { '.', 0, '\\', 0xff, 0xc0, ' ', 0xc3, '"' };
+        uint8_t* p = scratch(len);
+        for (uint8_t i = 0; i < len; ++i) {
+            p[i] = binary && rng_.chance(1, 3) ? special[rng_.below(sizeof(special))]
+                                               : static_cast<uint8_t>('a' + rng_.below(26));
+        }
+        n.add(p, len);
+    }
+
+    void add_number_label(name& n, uint32_t value)
+    {
+        uint8_t* p = scratch(3);
+        uint8_t len = 0;
+        char digits[3];
+        do {
+            digits[len++] = static_cast<char>('0' + value % 10);
+            value /= 10;
+        } while (value && len < 3);
+        for (uint8_t i = 0; i < len; ++i) {
+            p[i] = static_cast<uint8_t>(digits[len - 1 - i]);
+        }
+        n.add(p, len);
+    }
+
+    name make_name(name_shape shape)
+    {
+        name n;
+        switch (shape) {
+        case kHost:
+            n.add(host_label());
+            n.add("local");
+            break;
+        case kServiceType:
+            add_service_type(n);
+            break;
+        case kInstance:
+            n.add(rng_.chance(1, 3) ? "avahi-fuzz" : host_label());
+            add_service_type(n);
+            break;
+        case kEnumeration:
+            n.add("_services");
+            n.add("_dns-sd");
+            n.add("_udp");
+            n.add("local");
+            break;
+        case kSubtype:
+            n.add("_printer");
+            n.add("_sub");
+            add_service_type(n);
+            break;
+        case kReverse:
+            for (int i = 0; i < 4; ++i) {
+                add_number_label(n, rng_.below(256));
+            }
+            n.add("in-addr");
+            n.add("arpa");
+            break;
+        default:
+            for (uint32_t i = 1 + rng_.below(3); i; --i) {
+                add_random_label(n, static_cast<uint8_t>(1 + rng_.below(20)), false);
+            }
+            n.add("local");
+            break;
+        }
+
+        if ((faults_ & kBinaryLabel) && rng_.chance(1, 2)) {
+            label& l = n.labels[rng_.below(static_cast<uint32_t>(n.count))];
+            name tmp;
+            add_random_label(tmp, static_cast<uint8_t>(1 + rng_.below(63)), true);
+            l = tmp.labels[0];
+        }
+        if ((faults_ & kLongName) && rng_.chance(1, 2)) {
+            name tmp;
+            while (tmp.count < 5) {
+                add_random_label(tmp, 63, false);
+            }
+            for (int i = 0; i < n.count && tmp.count < name::kMaxLabels; ++i) {
+                tmp.labels[tmp.count++] = n.labels[i];
+            }
+            n = tmp;
+        }
+        return n;
+    }
+
+    name random_name() { return make_name(static_cast<name_shape>(rng_.below(kShapes))); }
+
+    // Case-sensitive hash of labels[from..] including the length bytes
+    static uint64_t suffix_hash(const name& n, int from)
+    {
+        uint64_t h = 0xcbf29ce484222325ull;
+        for (int i = from; i < n.count; ++i) {
+            h = (h ^ n.labels[i].len) * 0x100000001b3ull;
+            for (uint8_t j = 0; j < n.labels[i].len; ++j) {
+                h = (h ^ n.labels[i].data[j]) * 0x100000001b3ull;
+            }
+        }
+        return h;
+    }
+
+    int find_suffix(uint64_t h) const
+    {
+        for (int i = 0; i < table_used_; ++i) {
+            if (table_[i].hash == h) {
+                return table_[i].offset;
+            }
+        }
+        return -1;
+    }
+
+    void remember_suffix(uint64_t h, size_t offset)
+    {
+        if (table_used_ < kTableSize && offset < 0x3FFF) {
+            table_[table_used_++] = { h, static_cast<uint16_t>(offset) };
+        }
+    }
+
+    void put_pointer(size_t offset)
+    {
+        last_pointer_ = size_;
+        put16(static_cast<uint16_t>(0xC000 | (offset & 0x3FFF)));
+    }
+
+    // Returns false if a pointer fault replaced the name
+    bool name_fault()
+    {
+        const uint32_t pointer_faults = kPointerLoop | kForwardPointer | kPointerOutOfRange | kPointerChain | kLongLabel;
+        if (!(faults_ & pointer_faults) || names_written_++ != name_fault_at_) {
+            return true;
+        }
+        uint32_t options[5];
+        int n = 0;
+        for (uint32_t f : { kPointerLoop, kForwardPointer, kPointerOutOfRange, kPointerChain, kLongLabel }) {
+            if (faults_ & f) {
+                options[n++] = f;
+            }
+        }
+        switch (options[rng_.below(static_cast<uint32_t>(n))]) {
+        case kPointerLoop:
+            put_pointer(size_);
+            return false;
+        case kForwardPointer:
+            put_pointer(size_ + 2 + rng_.below(64));
+            return false;
+        case kPointerOutOfRange:
+            put_pointer(0x3FFF - rng_.below(16));
+            return false;
+        case kPointerChain:
+            if (last_pointer_) {
+                put_pointer(last_pointer_);
+                return false;
+            }
+            return true;
+        default: {
+            // Label types 01/10 are reserved (EDNS0 extended labels)
+            uint8_t len = static_cast<uint8_t>(64 + rng_.below(192));
+            put8(len);
+            for (uint8_t i = 0; i < (len & 0x3F); ++i) {
+                put8(static_cast<uint8_t>('a' + rng_.below(26)));
+            }
+            return true;
+        }
+        }
+    }
+
+    void put_name(const name& n)
+    {
+        if (!name_fault()) {
+            return;
+        }
+        for (int i = 0; i < n.count; ++i) {
+            uint64_t h = suffix_hash(n, i);
+            int offset = find_suffix(h);
+            if (offset >= 0) {
+                put_pointer(static_cast<size_t>(offset));
+                return;
+            }
+            remember_suffix(h, size_);
+            put8(n.labels[i].len);
+            put(n.labels[i].data, n.labels[i].len);
+        }
+        put8(0);
+    }
+
+    // --- Records -------------------------------------------------------
+
+    uint32_t ttl()
+    {
+        static const uint32_t ttls[] = { 120, 4500, 0, 1, 0x7FFFFFFF, 0xFFFFFFFF };
+        return rng_.chance(3, 4) ? ttls[rng_.below(2)] : ttls[rng_.below(6)];
+    }
+
+    void put_character_string(const char* s)
+    {
+        size_t len = strlen(s);
+        put8(static_cast<uint8_t>(len));
+        put(reinterpret_cast<const uint8_t*>(s), len);
+    }
+
+    void put_rdata(uint16_t type)
+    {
+        switch (type) {
+        case kTypeA:
+            put8(rng_.chance(1, 2) ? 192 : static_cast<uint8_t>(rng_.next()));
+            put8(168);
+            put8(4);
+            put8(static_cast<uint8_t>(rng_.below(8)));
+            break;
+        case kTypeAAAA:
+            put16(0xFE80);
+            for (int i = 0; i < 7; ++i) {
+                put16(static_cast<uint16_t>(rng_.next()));
+            }
+            break;
+        case kTypePTR:
+            put_name(rng_.chance(3, 4) ? make_name(kInstance) : random_name());
+            break;
+        case kTypeCNAME:
+        case kTypeNS:
+            put_name(random_name());
+            break;
+        case kTypeSRV:
+            put16(static_cast<uint16_t>(rng_.below(3)));
+            put16(static_cast<uint16_t>(rng_.below(3)));
+            put16(rng_.chance(3, 4) ? 80 : static_cast<uint16_t>(rng_.next()));
+            put_name(rng_.chance(3, 4) ? make_name(kHost) : random_name());
+            break;
+        case kTypeTXT: {
+            static const char* const txt[] = { "path=/", "version=1.0", "txtvers=1", "=", "novalue", "k=", "" };
+            uint32_t n = rng_.chance(1, 8) ? 0 : 1 + rng_.below(6);
+            for (uint32_t i = 0; i < n; ++i) {
+                put_character_string(pick(txt, sizeof(txt) / sizeof(txt[0])));
+            }
+            if (rng_.chance(1, 16)) {
+                // One long string, or a string run up to the packet limit
+                uint32_t len = rng_.chance(1, 2) ? 255 : 1 + rng_.below(4000);
+                while (len && !full_) {
+                    uint8_t chunk = static_cast<uint8_t>(len > 255 ? 255 : len);
+                    put8(chunk);
+                    for (uint8_t i = 0; i < chunk; ++i) {
+                        put8(static_cast<uint8_t>('a' + i % 26));
+                    }
+                    len -= chunk;
+                }
+            }
+            break;
+        }
+        case kTypeHINFO:
+            put_character_string("ESP32");
+            put_character_string(rng_.chance(1, 2) ? "FreeRTOS" : "");
+            break;
+        case kTypeNSEC:
+            put_name(make_name(kHost));
+            put8(0);                            // window 0
+            put8(static_cast<uint8_t>(1 + rng_.below(32)));
+            for (uint32_t i = 0, n = out_[size_ - 1]; i < n; ++i) {
+                put8(static_cast<uint8_t>(rng_.next()));
+            }
+            break;
+        default:
+            for (uint32_t n = rng_.below(64); n; --n) {
+                put8(static_cast<uint8_t>(rng_.next()));
+            }
+            break;
+        }
+    }
+
+    // Writes a record; rolls it back and returns false if the packet is full
+    bool put_record(const name& owner, uint16_t type, uint16_t cls, uint32_t record_ttl)
+    {
+        size_t start = size_;
+        int table_used = table_used_;
+        put_name(owner);
+        put16(type);
+        put16(cls);
+        put32(record_ttl);
+        size_t rdlength_at = size_;
+        put16(0);
+        put_rdata(type);
+        if (full_) {
+            size_ = start;
+            table_used_ = table_used;
+            return false;
+        }
+        uint32_t rdlength = static_cast<uint32_t>(size_ - rdlength_at - 2);
+        if ((faults_ & kRdlength) && records_written_ == rdlength_fault_at_) {
+            rdlength = rng_.chance(1, 4) ? 0xFFFF : rdlength + rng_.below(17) - 8;
+        }
+        put16_at(rdlength_at, static_cast<uint16_t>(rdlength));
+        ++records_written_;
+        return true;
+    }
+
+    bool put_question(const name& n, uint16_t type)
+    {
+        size_t start = size_;
+        put_name(n);
+        put16(type);
+        put16(static_cast<uint16_t>(kClassIN | (rng_.chance(1, 4) ? kUnicastResponse : 0)));
+        if (full_) {
+            size_ = start;
+            return false;
+        }
+        return true;
+    }
+
+    uint16_t random_type()
+    {
+        static const uint16_t types[] = { kTypeA, kTypeAAAA, kTypePTR, kTypeSRV, kTypeTXT, kTypeHINFO,
+                                          kTypeCNAME, kTypeNS, kTypeNSEC, kTypeANY, 99, 65280 };
+        return types[rng_.below(sizeof(types) / sizeof(types[0]))];
+    }
+
+    // A service description: PTR set for the type, SRV/TXT for each instance,
+    // A/AAAA set for the host. Unique records mostly carry the cache-flush bit.
+    uint16_t service_records(uint32_t instances, bool goodbye)
+    {
+        uint16_t written = 0;
+        name type = make_name(kServiceType);
+        for (uint32_t i = 0; i < instances; ++i) {
+            name instance = make_name(kInstance);
+            uint32_t t = goodbye ? 0 : ttl();
+            uint16_t flush = rng_.chance(7, 8) ? kCacheFlush : 0;
+            written += put_record(rng_.chance(7, 8) ? type : random_name(), kTypePTR, kClassIN, t);
+            if (rng_.chance(3, 4)) {
+                written += put_record(instance, kTypeSRV, kClassIN | flush, t);
+            }
+            if (rng_.chance(3, 4)) {
+                written += put_record(instance, kTypeTXT, kClassIN | flush, t);
+            }
+        }
+        name host = make_name(kHost);
+        for (uint32_t n = rng_.below(4); n; --n) {
+            written += put_record(host, rng_.chance(3, 4) ? kTypeA : kTypeAAAA,
+                                  kClassIN | (rng_.chance(3, 4) ? kCacheFlush : 0), goodbye ? 0 : ttl());
+        }
+        return written;
+    }
+
+    void response(uint16_t counts[4])
+    {
+        bool goodbye = rng_.chance(1, 8);
+        counts[1] = service_records(1 + rng_.below(4), goodbye);
+        for (uint32_t n = rng_.below(3); n; --n) {
+            counts[1] += put_record(random_name(), random_type(), kClassIN | (rng_.chance(1, 2) ? kCacheFlush : 0), ttl());
+        }
+        // Additional records: NSEC, EDNS0 OPT, more addresses
+        for (uint32_t n = rng_.below(3); n; --n) {
+            switch (rng_.below(3)) {
+            case 0:
+                counts[3] += put_record(make_name(kHost), kTypeNSEC, kClassIN | kCacheFlush, ttl());
+                break;
+            case 1: {
+                name root;
+                counts[3] += put_record(root, kTypeOPT, 1440, 0);
+                break;
+            }
+            default:
+                counts[3] += service_records(1, false);
+                break;
+            }
+        }
+    }
+
+    void query(uint16_t counts[4])
+    {
+        for (uint32_t n = 1 + rng_.below(4); n; --n) {
+            name q = rng_.chance(1, 8) ? random_name() : make_name(static_cast<name_shape>(rng_.below(kRandom)));
+            counts[0] += put_question(q, rng_.chance(1, 2) ? static_cast<uint16_t>(kTypePTR) : random_type());
+        }
+        // Known answers
+        if (rng_.chance(1, 2)) {
+            counts[1] = service_records(1 + rng_.below(6), false);
+        }
+    }
+
+    // Probe: ANY question for the names plus the proposed records in the
+    // authority section
+    void probe(uint16_t counts[4])
+    {
+        name instance = make_name(kInstance);
+        name host = make_name(kHost);
+        counts[0] += put_question(instance, kTypeANY);
+        if (rng_.chance(1, 2)) {
+            counts[0] += put_question(host, kTypeANY);
+        }
+        counts[2] += put_record(instance, kTypeSRV, kClassIN, 120);
+        counts[2] += put_record(instance, kTypeTXT, kClassIN, 4500);
+        if (rng_.chance(1, 2)) {
+            counts[2] += put_record(host, kTypeA, kClassIN, 120);
+        }
+    }
+
+    // --- Output --------------------------------------------------------
+
+    void put(const uint8_t* data, size_t len)
+    {
+        if (size_ + len > kMaxPacket) {
+            full_ = true;
+            return;
+        }
+        memcpy(out_ + size_, data, len);
+        size_ += len;
+    }
+
+    void put8(uint8_t v) { put(&v, 1); }
+
+    void put16(uint16_t v)
+    {
+        uint8_t b[2] = { static_cast<uint8_t>(v >> 8), static_cast<uint8_t>(v) };
+        put(b, 2);
+    }
+
+    void put32(uint32_t v)
+    {
+        put16(static_cast<uint16_t>(v >> 16));
+        put16(static_cast<uint16_t>(v));
+    }
+
+    void put16_at(size_t at, uint16_t v)
+    {
+        out_[at] = static_cast<uint8_t>(v >> 8);
+        out_[at + 1] = static_cast<uint8_t>(v);
+    }
+
+    struct suffix {
+        uint64_t hash;
+        uint16_t offset;
+    };
+
+    uint64_t seed_;
+    rng rng_;
+    uint8_t* out_ = nullptr;
+    size_t size_ = 0;
+    bool full_ = false;
+    uint32_t faults_ = 0;
+    suffix table_[kTableSize];
+    int table_used_ = 0;
+    uint8_t scratch_[kScratchSize];
+    size_t scratch_used_ = 0;
+    size_t last_pointer_ = 0;
+    uint32_t names_written_ = 0;
+    uint32_t name_fault_at_ = 0;
+    uint32_t records_written_ = 0;
+    uint32_t rdlength_fault_at_ = 0;
+};
+
+} // namespace mdns_fuzz
+
+#endif // MDNS_PACKET_HPP
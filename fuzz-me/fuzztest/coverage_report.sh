@@ -0,0 +1,106 @@
+#!/bin/bash
+
+# Coverage-over-time comparison of the arbitrary-string fuzz tests and their
+# grammar-aware counterparts (iot_domains.h).
+# Usage: ./coverage_report.sh [-t seconds_per_test] [-o report_dir]
+#
+# Needs the fuzzing-mode build from build.sh (build_fuzz/). Each test runs
+# for the same wall time on one core; FuzzTest prints a status line whenever
+# the corpus grows, which is turned into a (seconds, edges) CSV per test and a
+# summary table. A test stops early when it finds a crash, which is recorded
+# as time to first crash.
+
+set -e
+
+SECONDS_PER_TEST=60
+REPORT_DIR="coverage_report"
+BINARY="build_fuzz/iot_parser_fuzztest"
+
+while getopts "t:o:h" opt; do
+    case $opt in
+        t) SECONDS_PER_TEST="$OPTARG" ;;
+        o) REPORT_DIR="$OPTARG" ;;
+        h) echo "Usage: $0 [-t seconds_per_test] [-o report_dir]"
+           exit 0 ;;
+        *) echo "Invalid option. Use -h for help."; exit 1 ;;
+    esac
+done
+
+if [ ! -x "$BINARY" ]; then
+    echo "Error: $BINARY not found, run ./build.sh first"
+    exit 1
+fi
+
+# before (arbitrary strings) : after (grammar-aware)
+PAIRS=(
+    "FuzzMqttTopicParsing:FuzzMqttGrammar"
+    "FuzzHttpRequestParsing:FuzzHttpGrammar"
+    "FuzzJsonExtraction:FuzzJsonGrammar"
+)
+
+mkdir -p "$REPORT_DIR"
+
+# Converts FuzzTest status lines into "seconds,edges" rows. Fuzzing time is
+# printed as an absl duration such as 850ms, 12.5s or 1m3.2s.
+to_csv() {
+    echo "seconds,edges"
+    sed -n 's/.*Edges covered: *\([0-9]*\).*Fuzzing time: *\([^ |]*\).*/\2 \1/p' "$1" |
+    awk '{
+        t = $1; s = 0
+        if (t ~ /ms$/) { sub(/ms$/, "", t); s = t / 1000 }
+        else {
+            if (t ~ /h/) { split(t, p, "h"); s += p[1] * 3600; t = p[2] }
+            if (t ~ /m/) { split(t, p, "m"); s += p[1] * 60; t = p[2] }
+            sub(/s$/, "", t); s += t
+        }
+        printf "%.2f,%s\n", s, $2
+    }'
+}
+
+# Edges reached by time $2 in CSV $1
+edges_at() {
+    awk -F, -v t="$2" 'NR > 1 && $1 <= t { e = $2 } END { print e + 0 }' "$1"
+}
+
+run_test() {
+    local name=$1
+    local log="$REPORT_DIR/$name.log"
+    local start=$(date +%s.%N)
+    set +e
+    timeout $((SECONDS_PER_TEST + 30)) "$BINARY" --fuzz="IoTParserTest.$name" \
+        --fuzz_for="${SECONDS_PER_TEST}s" > "$log" 2>&1
+    local rc=$?
+    set -e
+    local end=$(date +%s.%N)
+    to_csv "$log" > "$REPORT_DIR/$name.csv"
+    if [ $rc -ne 0 ]; then
+        printf "%.1fs" "$(echo "$end - $start" | bc -l)" > "$REPORT_DIR/$name.crash"
+    else
+        rm -f "$REPORT_DIR/$name.crash"
+    fi
+}
+
+SUMMARY="$REPORT_DIR/summary.md"
+q1=$((SECONDS_PER_TEST / 10)); q2=$((SECONDS_PER_TEST / 2)); q3=$SECONDS_PER_TEST
+{
+    echo "# Coverage over time (${SECONDS_PER_TEST}s per test, 1 core)"
+    echo ""
+    echo "| Test | Edges @${q1}s | Edges @${q2}s | Edges @${q3}s | First crash |"
+    echo "|------|------|------|------|------|"
+} > "$SUMMARY"
+
+for pair in "${PAIRS[@]}"; do
+    for name in ${pair%%:*} ${pair##*:}; do
+        echo "Running $name for ${SECONDS_PER_TEST}s..."
+        run_test "$name"
+        csv="$REPORT_DIR/$name.csv"
+        crash="-"
+        [ -f "$REPORT_DIR/$name.crash" ] && crash=$(cat "$REPORT_DIR/$name.crash")
+        echo "| $name | $(edges_at "$csv" $q1) | $(edges_at "$csv" $q2) | $(edges_at "$csv" $q3) | $crash |" >> "$SUMMARY"
+    done
+done
+
+echo ""
+cat "$SUMMARY"
+echo ""
+echo "Per-test CSV files (seconds,edges) and logs are in $REPORT_DIR/"
@@ -0,0 +1,63 @@
+#ifndef IOT_DOMAINS_H
+#define IOT_DOMAINS_H
+
+// FuzzTest domains for structurally valid parser inputs (see iot_grammar.h).
+// Each domain mutates the message description and maps it to a string, so
+// the fuzz test functions still take a plain `const std::string&`.
+
+#include <string>
+#include <vector>
+
+#include "fuzztest/fuzztest.h"
+#include "iot_grammar.h"
+
+namespace iot_grammar {
+
+inline auto JsonMember()
+{
+    return fuzztest::StructOf<json_member>(
+        fuzztest::InRange<int>(0, static_cast<int>(keys().size())),
+        fuzztest::InRange<int>(0, kValueKinds - 1),
+        fuzztest::String().WithMaxSize(96),
+        fuzztest::Arbitrary<int64_t>(),
+        fuzztest::InRange(0, 64));
+}
+
+// About half of the generated inputs carry no corruption
+inline auto Corruption()
+{
+    return fuzztest::StructOf<corruption>(
+        fuzztest::InRange<int>(0, 2 * kCorruptionKinds),
+        fuzztest::Arbitrary<uint32_t>(),
+        fuzztest::InRange<uint32_t>(0, 4096));
+}
+
+inline auto JsonObject()
+{
+    return fuzztest::Map(render_object, fuzztest::VectorOf(JsonMember()).WithMaxSize(12), Corruption());
+}
+
+// Known names, wildcards and free-form levels (long ones overflow the topic)
+inline auto NameLevel()
+{
+    return fuzztest::OneOf(
+        fuzztest::ElementOf<std::string>({ "home", "sensors", "device", "alarm", "api", "status",
+                                           "temperature", "control", "+", "#", "" }),
+        fuzztest::StringOf(fuzztest::PrintableAsciiChar()).WithMaxSize(80));
+}
+
+inline auto MqttLine()
+{
+    return fuzztest::Map(render_mqtt, fuzztest::VectorOf(NameLevel()).WithMaxSize(8), JsonObject());
+}
+
+inline auto HttpLine()
+{
+    return fuzztest::Map(render_http, fuzztest::InRange(0, 2),
+                         fuzztest::StringOf(fuzztest::PrintableAsciiChar()).WithMaxSize(16),
+                         fuzztest::VectorOf(NameLevel()).WithMaxSize(8), JsonObject());
+}
+
+} // namespace iot_grammar
+
+#endif // IOT_DOMAINS_H
@@ -0,0 +1,196 @@
+#ifndef IOT_GRAMMAR_H
+#define IOT_GRAMMAR_H
+
+// Structure-aware input generation for the parser fuzz tests.
+//
+// Arbitrary strings almost never start with "mqtt", "GET " or "POST " and
+// rarely contain a quoted key followed by a colon, so most of the fuzzing time
+// is spent in the prefix checks. The fuzzer here mutates a small description
+// of a message instead (topic levels, JSON members, one corruption) and the
+// functions below render it into the text the parser sees. Inputs are
+// well-formed unless the corruption says otherwise, and the corruptions are
+// the ones the parser is known to mishandle: oversized fields, escapes,
+// truncation, deep nesting and numbers that do not fit.
+//
+// This header only renders; the fuzztest domains live in iot_domains.h.
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace iot_grammar {
+
+// Keys looked up by the analysis functions, plus some from the sample inputs
+inline const std::vector<std::string>& keys()
+{
+    static const std::vector<std::string> k = {
+        "device_id", "temperature", "status", "action", "value", "humidity", "sensor", "test",
+    };
+    return k;
+}
+
+enum value_kind : int {
+    kString,
+    kNumber,
+    kHugeNumber,
+    kBool,
+    kNull,
+    kObject,
+    kArray,
+    kValueKinds,
+};
+
+struct json_member {
+    int key;            // index into keys(); out of range: text is used as the key
+    int kind;           // value_kind
+    std::string text;   // string value or custom key
+    int64_t number;
+    int depth;          // nesting depth of kObject / kArray values
+};
+
+enum corruption_kind : int {
+    kNone,
+    kOversize,          // a run of bytes inserted at position
+    kTruncate,
+    kDropByte,
+    kEscapes,           // a broken or unusual escape sequence at position
+    kDeepNesting,       // the object wrapped in `amount` arrays
+    kCorruptionKinds,
+};
+
+struct corruption {
+    int kind;           // corruption_kind; larger values mean kNone, so most inputs stay valid
+    uint32_t position;  // byte offset, taken modulo the rendered length
+    uint32_t amount;    // run length or nesting levels
+};
+
+inline std::string escape(const std::string& s)
+{
+    std::string out;
+    for (char c : s) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char buf[8];
+            snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned char>(c));
+            out += buf;
+        } else {
+            out += c;
+        }
+    }
+    return out;
+}
+
+inline std::string render_value(const json_member& m)
+{
+    switch (m.kind) {
+    case kString:
+        return "\"" + escape(m.text) + "\"";
+    case kNumber:
+        return std::to_string(m.number);
+    case kHugeNumber:
+        switch (static_cast<uint64_t>(m.number) % 4) {
+        case 0:
+            return "1" + std::string(19 + static_cast<uint64_t>(m.number) % 300, '9');
+        case 1:
+            return "-9223372036854775809";
+        case 2:
+            return "1e999";
+        default:
+            return "0." + std::string(400, '0') + "1e-400";
+        }
+    case kBool:
+        return m.number & 1 ? "true" : "false";
+    case kNull:
+        return "null";
+    case kObject: {
+        if (m.depth <= 0) {
+            return "{}";
+        }
+        std::string inner = std::to_string(m.number);
+        for (int i = 0; i < m.depth; ++i) {
+            inner = "{\"n\":" + inner + "}";
+        }
+        return inner;
+    }
+    default:
+        return std::string(m.depth, '[') + std::to_string(m.number) + std::string(m.depth, ']');
+    }
+}
+
+inline void apply(const corruption& c, std::string& s)
+{
+    if (s.empty()) {
+        return;
+    }
+    size_t at = c.position % s.size();
+    static const char* const escapes[] = { "\\\"", "\\\\", "\\u0000", "\\u12", "\\", "\\x41" };
+    switch (c.kind) {
+    case kOversize:
+        s.insert(at, c.amount % 2048, static_cast<char>('A' + c.position % 26));
+        break;
+    case kTruncate:
+        s.resize(at);
+        break;
+    case kDropByte:
+        s.erase(at, 1);
+        break;
+    case kEscapes:
+        s.insert(at, escapes[c.amount % (sizeof(escapes) / sizeof(escapes[0]))]);
+        break;
+    case kDeepNesting: {
+        size_t levels = c.amount % 1024;
+        s = "{\"nest\":" + std::string(levels, '[') + s + std::string(levels, ']') + "}";
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+inline std::string render_object(const std::vector<json_member>& members, const corruption& c)
+{
+    std::string out = "{";
+    for (size_t i = 0; i < members.size(); ++i) {
+        const json_member& m = members[i];
+        const std::string& key = m.key >= 0 && static_cast<size_t>(m.key) < keys().size()
+                                     ? keys()[static_cast<size_t>(m.key)]
+                                     : m.text;
+        out += (i ? "," : "") + ("\"" + escape(key) + "\":") + render_value(m);
+    }
+    out += "}";
+    apply(c, out);
+    return out;
+}
+
+// "mqtt/level/level {...}"
+inline std::string render_mqtt(const std::vector<std::string>& levels, const std::string& payload)
+{
+    std::string line = "mqtt";
+    for (const std::string& level : levels) {
+        line += "/" + level;
+    }
+    return line + " " + payload;
+}
+
+// "GET /segment/segment {...}"; method index 0/1 is GET/POST, otherwise
+// custom_method is used (oversized methods overflow http_message_t.method)
+inline std::string render_http(int method, const std::string& custom_method,
+                               const std::vector<std::string>& segments, const std::string& body)
+{
+    std::string line = method == 0 ? "GET" : method == 1 ? "POST" : custom_method;
+    line += " ";
+    for (const std::string& segment : segments) {
+        line += "/" + segment;
+    }
+    if (segments.empty()) {
+        line += "/";
+    }
+    return line + " " + body;
+}
+
+} // namespace iot_grammar
+
+#endif // IOT_GRAMMAR_H
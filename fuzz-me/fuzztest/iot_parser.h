@@ -28,6 +28,8 @@ int extract_json_value(const char* json, const char* key, char* value);
 void parse_http_request(const char* input, http_message_t* msg);
 void print_mqtt_analysis(const mqtt_message_t* msg);
 void print_http_analysis(const http_message_t* msg);
+// Dispatches one input line by prefix (mqtt, GET/POST, other), as main() does
+void dispatch_message(const char* input);
 
 #ifdef __cplusplus
 }
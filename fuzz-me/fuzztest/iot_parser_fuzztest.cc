@@ -1,7 +1,17 @@
 #include "fuzztest/fuzztest.h"
 #include "gtest/gtest.h"
 #include "iot_parser.h"
+#include "json_number.h"
+#include "topic_trie.h"
+#include "iot_batch.h"
+#include "iot_diff.h"
+#include "iot_domains.h"
+#include "json_schema.hpp"
 #include <string>
+#include <vector>
+#include <cfloat>
+#include <cmath>
+#include <cstdlib>
 #include <cstring>
 
 // ========================================
@@ -30,6 +40,203 @@ TEST(IoTParserTest, ValidHttpParsing) {
     EXPECT_STREQ(msg.body, "{\"action\":\"read\"}");
 }
 
+TEST(IoTParserTest, TopicTrieWildcards) {
+    topic_trie_t* trie = topic_trie_create();
+    ASSERT_NE(trie, nullptr);
+    EXPECT_EQ(topic_trie_add(trie, "/sensors/+", 1), 0);
+    EXPECT_EQ(topic_trie_add(trie, "/sensors/#", 2), 0);
+    EXPECT_EQ(topic_trie_add(trie, "#", 3), 0);
+    EXPECT_EQ(topic_trie_add(trie, "/sensors/#/temp", 4), -1);
+
+    mqtt_message_t msg = {0};
+    parse_mqtt_topic("mqtt/sensors/temp {\"temperature\":25.5}", &msg);
+    uint32_t ids[8];
+    EXPECT_EQ(topic_trie_match(trie, msg.topic, ids, 8), 3u);
+    EXPECT_EQ(topic_trie_match(trie, "/sensors", ids, 8), 2u);
+    EXPECT_EQ(topic_trie_match(trie, "$SYS/uptime", ids, 8), 0u);
+
+    EXPECT_EQ(topic_trie_remove(trie, "/sensors/+", 1), 0);
+    EXPECT_EQ(topic_trie_remove(trie, "/sensors/+", 1), -1);
+    EXPECT_EQ(topic_trie_match(trie, msg.topic, ids, 8), 2u);
+    topic_trie_destroy(trie);
+}
+
+TEST(IoTParserTest, TopicTrieLeadingSlash) {
+    // The first level interned is the empty one before "/"
+    topic_trie_t* trie = topic_trie_create();
+    ASSERT_NE(trie, nullptr);
+    EXPECT_EQ(topic_trie_add(trie, "/a", 1), 0);
+    EXPECT_EQ(topic_trie_add(trie, "/", 2), 0);
+    EXPECT_EQ(topic_trie_add(trie, "+/a", 3), 0);
+    uint32_t ids[8];
+    EXPECT_EQ(topic_trie_match(trie, "/a", ids, 8), 2u);
+    EXPECT_EQ(topic_trie_match(trie, "/", ids, 8), 1u);
+    EXPECT_EQ(topic_trie_match(trie, "a", ids, 8), 0u);
+    topic_trie_destroy(trie);
+}
+
+TEST(IoTParserTest, TypedNumericExtraction) {
+    const char* json = "{\"temperature\":25.5,\"count\":9223372036854775808,\"id\":\"x\"}";
+    double temperature = 0;
+    EXPECT_EQ(extract_json_double(json, "temperature", &temperature), JSON_NUMBER_OK);
+    EXPECT_DOUBLE_EQ(temperature, 25.5);
+
+    int64_t value = 0;
+    EXPECT_EQ(extract_json_int64(json, "temperature", &value), JSON_NUMBER_INEXACT);
+    EXPECT_EQ(value, 25);
+    EXPECT_EQ(extract_json_int64(json, "count", &value), JSON_NUMBER_OVERFLOW);
+    EXPECT_EQ(value, INT64_MAX);
+    EXPECT_EQ(extract_json_int64(json, "id", &value), JSON_NUMBER_NOT_FOUND);
+    EXPECT_EQ(extract_json_double(json, "missing", &temperature), JSON_NUMBER_NOT_FOUND);
+}
+
+TEST(IoTParserTest, DoubleRoundingBoundaries) {
+    struct Case {
+        const char* text;
+        double expected;
+        json_number_status_t status;
+    };
+    const Case cases[] = {
+        { "9007199254740993", 9007199254740992.0, JSON_NUMBER_OK },          // tie, to even
+        { "9007199254740995", 9007199254740996.0, JSON_NUMBER_OK },
+        { "0.30000000000000004", 0.30000000000000004, JSON_NUMBER_OK },
+        { "1.7976931348623157e308", DBL_MAX, JSON_NUMBER_OK },
+        { "1.7976931348623159e308", HUGE_VAL, JSON_NUMBER_OVERFLOW },
+        { "2.2250738585072011e-308", 2.2250738585072009e-308, JSON_NUMBER_INEXACT },
+        { "2.4703282292062328e-324", 4.9406564584124654e-324, JSON_NUMBER_INEXACT },
+        { "2.4703282292062327e-324", 0.0, JSON_NUMBER_INEXACT },
+        { "9999999999999999999e290", HUGE_VAL, JSON_NUMBER_OVERFLOW },
+        { "1e-400", 0.0, JSON_NUMBER_INEXACT },
+    };
+    for (const Case& c : cases) {
+        double value = 0;
+        json_number_status_t status;
+        const char* last = c.text + strlen(c.text);
+        EXPECT_EQ(json_parse_double(c.text, last, &value, &status), last) << c.text;
+        EXPECT_EQ(value, c.expected) << c.text;
+        EXPECT_EQ(status, c.status) << c.text;
+    }
+}
+
+struct SchemaReading {
+    std::string_view device_id;
+    double temperature = 0;
+    int64_t count = 0;
+    bool active = false;
+};
+
+constexpr auto kReadingSchema = json_schema::make_schema(
+    json_schema::bind("device_id", &SchemaReading::device_id),
+    json_schema::bind("temperature", &SchemaReading::temperature),
+    json_schema::bind("count", &SchemaReading::count),
+    json_schema::bind("active", &SchemaReading::active));
+
+TEST(IoTParserTest, JsonSchemaTypedFields) {
+    const std::string json =
+        "{\"device_id\":\"sensor1\", \"temperature\":25.5,\"count\":1.5,"
+        "\"active\":true,\"extra\":{\"a\":[1,2]}}";
+    SchemaReading r;
+    json_schema::parse_result res = kReadingSchema.parse(json.data(), json.size(), r);
+    EXPECT_TRUE(res.ok);
+    EXPECT_EQ(r.device_id, "sensor1");
+    EXPECT_DOUBLE_EQ(r.temperature, 25.5);
+    EXPECT_TRUE(r.active);
+    EXPECT_EQ(res.seen, 0xBu);
+    EXPECT_EQ(res.invalid, 0x4u);  // 1.5 does not fit an integer field
+    EXPECT_EQ(res.unknown, 1u);
+    EXPECT_FALSE(kReadingSchema.parse("{\"count\":", 10, r).ok);
+}
+
+static std::string BatchText(const iot_span_t& msg, iot_ref_t ref) {
+    return std::string(msg.ptr + ref.off, ref.len);
+}
+
+TEST(IoTParserTest, BatchParseColumns) {
+    const std::vector<std::string> inputs = {
+        "mqtt/home/temperature {\"device_id\":\"sensor01\",\"temperature\":23.5,\"status\":\"active\"}",
+        "POST /device/control {\"action\":\"set\",\"value\":\"on\"}",
+        "GET /status",
+        "garbage",
+    };
+    std::vector<iot_span_t> msgs;
+    for (const std::string& in : inputs) msgs.push_back({in.data(), in.size()});
+
+    iot_batch_t batch;
+    ASSERT_EQ(iot_batch_init(&batch, msgs.size()), 0);
+    EXPECT_EQ(iot_batch_parse(&batch, msgs.data(), msgs.size()), 3);
+    EXPECT_EQ(batch.kind[0], IOT_MSG_MQTT);
+    EXPECT_EQ(BatchText(msgs[0], batch.topic[0]), "/home/temperature");
+    EXPECT_EQ(BatchText(msgs[0], batch.text[IOT_FIELD_DEVICE_ID][0]), "sensor01");
+    EXPECT_DOUBLE_EQ(batch.temperature[0], 23.5);
+    EXPECT_EQ(batch.kind[1], IOT_MSG_HTTP_POST);
+    EXPECT_EQ(BatchText(msgs[1], batch.topic[1]), "/device/control");
+    EXPECT_EQ(batch.fields[1], (1u << IOT_FIELD_ACTION) | (1u << IOT_FIELD_VALUE));
+    EXPECT_EQ(BatchText(msgs[1], batch.text[IOT_FIELD_VALUE][1]), "on");
+    EXPECT_EQ(BatchText(msgs[2], batch.topic[2]), "/status");
+    EXPECT_EQ(batch.kind[3], IOT_MSG_INVALID);
+    EXPECT_EQ(iot_batch_parse(&batch, msgs.data(), msgs.size() + 1), -1);
+    iot_batch_free(&batch);
+}
+
+TEST(IoTParserTest, DifferentialLegacyVsBatch) {
+    iot_batch_t batch;
+    ASSERT_EQ(iot_batch_init(&batch, 1), 0);
+    iot_diff_result_t res;
+    std::string mqtt = "mqtt/home/temperature {\"device_id\":\"sensor01\",\"temperature\":23.5,\"status\":\"active\"}";
+    EXPECT_EQ(iot_diff_check(mqtt.c_str(), mqtt.size(), &batch, &res), IOT_DIFF_MATCH);
+    // topic, payload, device_id, status, temperature as the legacy "23" and
+    // as the double 23.5
+    EXPECT_EQ(res.compared, 6u);
+    EXPECT_EQ(res.skipped, 0u);
+
+    std::string post = "POST /device/control {\"action\":\"set\",\"value\":-0}";
+    EXPECT_EQ(iot_diff_check(post.c_str(), post.size(), &batch, &res), IOT_DIFF_MATCH);
+    EXPECT_EQ(iot_diff_check("GET /status", 11, &batch, &res), IOT_DIFF_HARDENED_ONLY);
+    EXPECT_EQ(iot_diff_check("GETX /a {}", 10, &batch, &res), IOT_DIFF_LEGACY_ONLY);
+    std::string long_topic = "mqtt/" + std::string(70, 'a') + " {}";
+    EXPECT_EQ(iot_diff_check(long_topic.c_str(), long_topic.size(), &batch, &res),
+              IOT_DIFF_OUT_OF_DOMAIN);
+
+    // A parser that drops the last character of a value must be flagged
+    iot_diff_legacy_t legacy;
+    iot_span_t msg = {post.data(), post.size()};
+    iot_diff_parse_legacy(post.c_str(), &legacy);
+    iot_batch_parse(&batch, &msg, 1);
+    batch.text[IOT_FIELD_ACTION][0].len--;
+    EXPECT_EQ(iot_diff_compare(&msg, &legacy, &batch, 0, &res), IOT_DIFF_DIVERGED);
+    EXPECT_EQ(std::string(res.detail, 6), "action");
+
+    // So must a temperature that is off by one ulp
+    iot_diff_parse_legacy(mqtt.c_str(), &legacy);
+    msg = {mqtt.data(), mqtt.size()};
+    iot_batch_parse(&batch, &msg, 1);
+    batch.temperature[0] = std::nextafter(batch.temperature[0], 0.0);
+    EXPECT_EQ(iot_diff_compare(&msg, &legacy, &batch, 0, &res), IOT_DIFF_DIVERGED);
+    EXPECT_EQ(std::string(res.detail, 20), "temperature (strtod)");
+    iot_batch_free(&batch);
+}
+
+TEST(IoTParserTest, GrammarRendersWellFormedMessages) {
+    using namespace iot_grammar;
+    std::vector<json_member> members = {
+        {0, kString, "sensor\"01", 0, 0},
+        {1, kNumber, "", -42, 0},
+        {-1, kObject, "custom", 7, 2},
+    };
+    corruption none = {kNone, 0, 0};
+    std::string json = render_object(members, none);
+    EXPECT_EQ(json, "{\"device_id\":\"sensor\\\"01\",\"temperature\":-42,"
+                    "\"custom\":{\"n\":{\"n\":7}}}");
+    int64_t temperature = 0;
+    EXPECT_EQ(extract_json_int64(json.c_str(), "temperature", &temperature), JSON_NUMBER_OK);
+    EXPECT_EQ(temperature, -42);
+
+    EXPECT_EQ(render_mqtt({"home", "+"}, "{}"), "mqtt/home/+ {}");
+    EXPECT_EQ(render_http(1, "", {"api"}, "{}"), "POST /api {}");
+    corruption truncate = {kTruncate, 5, 0};
+    EXPECT_EQ(render_object(members, truncate), "{\"dev");
+}
+
 // ========================================
 // FUZZ TESTS (Property-based testing)
 // ========================================
@@ -204,4 +411,167 @@ void FuzzEdgeCases(int input_type, const std::string& data) {
 
 FUZZ_TEST(IoTParserTest, FuzzEdgeCases)
     .WithDomains(fuzztest::InRange(0, 1000),
-                 fuzztest::Arbitrary<std::string>().WithMaxSize(300)); 
\ No newline at end of file
+                 fuzztest::Arbitrary<std::string>().WithMaxSize(300)); 
+
+// Fuzz Test 8: Topic trie must agree with the linear reference matcher
+void FuzzTopicTrieMatchesLinear(const std::vector<std::string>& filters,
+                                const std::string& topic) {
+    topic_trie_t* trie = topic_trie_create();
+    ASSERT_NE(trie, nullptr);
+    std::vector<const std::string*> added;
+    for (const std::string& f : filters) {
+        if (topic_trie_add(trie, f.c_str(), (uint32_t)added.size()) == 0) {
+            added.push_back(&f);
+        }
+    }
+
+    size_t expected = 0;
+    for (const std::string* f : added) {
+        expected += topic_filter_matches(f->c_str(), topic.c_str());
+    }
+    EXPECT_EQ(topic_trie_match(trie, topic.c_str(), nullptr, 0), expected);
+
+    for (size_t i = 0; i < added.size(); ++i) {
+        EXPECT_EQ(topic_trie_remove(trie, added[i]->c_str(), (uint32_t)i), 0);
+    }
+    topic_trie_stats_t stats;
+    topic_trie_get_stats(trie, &stats);
+    EXPECT_EQ(stats.filters, 0u);
+    EXPECT_EQ(stats.nodes, 1u);
+    topic_trie_destroy(trie);
+}
+
+FUZZ_TEST(IoTParserTest, FuzzTopicTrieMatchesLinear)
+    .WithDomains(fuzztest::VectorOf(fuzztest::StringOf(fuzztest::ElementOf(
+                                        {'a', 'b', '/', '+', '#', '$'}))
+                                        .WithMaxSize(12))
+                     .WithMaxSize(16),
+                 fuzztest::StringOf(fuzztest::ElementOf({'a', 'b', '/', '$'}))
+                     .WithMaxSize(12));
+
+// Fuzz Test 9: Double parsing must agree with strtod whenever it reports an
+// exact result, and bit for bit whenever no significant digit was dropped
+// (subnormals, underflow and overflow included)
+void FuzzJsonParseDouble(const std::string& digits, const std::string& fraction, int exponent) {
+    if (digits.empty()) return;
+    std::string token = digits;
+    if (!fraction.empty()) token += "." + fraction;
+    token += "e" + std::to_string(exponent);
+
+    double value = 0;
+    json_number_status_t status;
+    const char* first = token.c_str();
+    const char* end = json_parse_double(first, first + token.size(), &value, &status);
+    if (status == JSON_NUMBER_INVALID) {
+        EXPECT_EQ(end, first);
+        return;
+    }
+    double expected = strtod(std::string(first, end).c_str(), nullptr);
+    if (status == JSON_NUMBER_OK) {
+        EXPECT_EQ(value, expected) << token;
+    }
+    std::string significant = digits + fraction;
+    significant.erase(0, significant.find_first_not_of('0'));
+    significant.erase(significant.find_last_not_of('0') + 1);
+    if (significant.size() <= 19) {
+        EXPECT_EQ(std::memcmp(&value, &expected, sizeof(value)), 0) << token;
+    }
+}
+
+FUZZ_TEST(IoTParserTest, FuzzJsonParseDouble)
+    .WithDomains(fuzztest::StringOf(fuzztest::InRange('0', '9')).WithMaxSize(25),
+                 fuzztest::StringOf(fuzztest::InRange('0', '9')).WithMaxSize(25),
+                 fuzztest::InRange(-400, 400));
+
+// Fuzz Test 10: The worker pool must produce the same columns as a serial parse
+void FuzzBatchParallelMatchesSerial(const std::vector<std::string>& inputs) {
+    std::vector<iot_span_t> msgs;
+    for (const std::string& in : inputs) msgs.push_back({in.data(), in.size()});
+    iot_batch_t serial, parallel;
+    ASSERT_EQ(iot_batch_init(&serial, msgs.size()), 0);
+    ASSERT_EQ(iot_batch_init(&parallel, msgs.size()), 0);
+    iot_batch_pool_t* pool = iot_batch_pool_create(3);
+
+    EXPECT_EQ(iot_batch_parse(&serial, msgs.data(), msgs.size()),
+              iot_batch_parse_parallel(pool, &parallel, msgs.data(), msgs.size()));
+    for (size_t i = 0; i < msgs.size(); ++i) {
+        EXPECT_EQ(serial.kind[i], parallel.kind[i]);
+        EXPECT_EQ(serial.fields[i], parallel.fields[i]);
+        EXPECT_EQ(serial.payload[i].off, parallel.payload[i].off);
+        EXPECT_LE(serial.payload[i].off + serial.payload[i].len, msgs[i].len);
+    }
+
+    iot_batch_pool_destroy(pool);
+    iot_batch_free(&serial);
+    iot_batch_free(&parallel);
+}
+
+FUZZ_TEST(IoTParserTest, FuzzBatchParallelMatchesSerial)
+    .WithDomains(fuzztest::VectorOf(fuzztest::Arbitrary<std::string>().WithMaxSize(200))
+                     .WithMaxSize(64));
+
+// Fuzz Test 11-13: Grammar-aware inputs (iot_domains.h). Same properties as
+// the tests above, but the inputs pass the prefix checks and carry the keys
+// the analysis looks up, so the fuzzer spends its time in the parsers.
+static void ExtractAnalysisKeys(const char* json) {
+    static const char* const kAnalysisKeys[] = {"device_id", "temperature", "status", "action", "value"};
+    for (const char* key : kAnalysisKeys) {
+        char value[MAX_VALUE_SIZE] = {0};
+        if (extract_json_value(json, key, value) > 0) {
+            EXPECT_LE(strlen(value), MAX_VALUE_SIZE - 1);
+        }
+    }
+}
+
+void FuzzMqttGrammar(const std::string& line) {
+    mqtt_message_t msg = {0};
+    parse_mqtt_topic(line.c_str(), &msg);
+    EXPECT_LE(strlen(msg.topic), MAX_TOPIC_SIZE - 1);
+    EXPECT_LE(strlen(msg.payload), MAX_BUFFER_SIZE - 1);
+    ExtractAnalysisKeys(msg.payload);
+}
+
+FUZZ_TEST(IoTParserTest, FuzzMqttGrammar)
+    .WithDomains(iot_grammar::MqttLine());
+
+void FuzzHttpGrammar(const std::string& line) {
+    http_message_t msg = {0};
+    parse_http_request(line.c_str(), &msg);
+    EXPECT_LE(strlen(msg.method), sizeof(msg.method) - 1);
+    EXPECT_LE(strlen(msg.path), MAX_PATH_SIZE - 1);
+    EXPECT_LE(strlen(msg.body), MAX_BUFFER_SIZE - 1);
+    ExtractAnalysisKeys(msg.body);
+}
+
+FUZZ_TEST(IoTParserTest, FuzzHttpGrammar)
+    .WithDomains(iot_grammar::HttpLine());
+
+void FuzzJsonGrammar(const std::string& json) {
+    ExtractAnalysisKeys(json.c_str());
+    double temperature = 0;
+    json_number_status_t status = extract_json_double(json.c_str(), "temperature", &temperature);
+    if (status == JSON_NUMBER_OK) {
+        EXPECT_FALSE(std::isinf(temperature));
+    }
+    SchemaReading r;
+    kReadingSchema.parse(json.data(), json.size(), r);
+}
+
+FUZZ_TEST(IoTParserTest, FuzzJsonGrammar)
+    .WithDomains(iot_grammar::JsonObject());
+
+// Fuzz Test 14: Differential check of the legacy parser against the batch
+// parser (iot_diff.h). Inputs that would overflow a legacy buffer are skipped,
+// so any failure here is a semantic difference, not a legacy crash.
+void FuzzLegacyMatchesBatch(const std::string& line) {
+    iot_batch_t batch;
+    ASSERT_EQ(iot_batch_init(&batch, 1), 0);
+    iot_diff_result_t res;
+    EXPECT_NE(iot_diff_check(line.c_str(), line.size(), &batch, &res), IOT_DIFF_DIVERGED)
+        << res.detail;
+    iot_batch_free(&batch);
+}
+
+FUZZ_TEST(IoTParserTest, FuzzLegacyMatchesBatch)
+    .WithDomains(fuzztest::OneOf(iot_grammar::MqttLine(), iot_grammar::HttpLine(),
+                                 fuzztest::Arbitrary<std::string>().WithMaxSize(400)));
@@ -0,0 +1,621 @@
+#!/usr/bin/env python3
+"""
+Multi-core fuzzing orchestrator for the IoT Network Message Parser
+
+Runs FuzzTest, libFuzzer and radamsa (persistent mode) workers side by side,
+one per core, and ties them together:
+
+- Shared corpus: new inputs of the libFuzzer workers are collected into
+  work/corpus/ and deduplicated by content; libFuzzer workers reload it and
+  radamsa workers are restarted with seeds drawn from it at every sync.
+  With a libFuzzer binary the shared corpus is minimized with -merge=1.
+  FuzzTest corpora use their own serialization and are only shared between
+  FuzzTest workers running the same test.
+- Crash triage: every crash report is reduced to its top stack frames
+  (sanitizer and libc frames skipped) and hashed; work/crashes/<hash>/ keeps
+  the first input and report of each unique crash. Raw inputs are replayed
+  with the symbolizing persistent_fuzzer -r so that all engines hash the same
+  frames; replays run in a small thread pool so the scheduling loop never
+  waits on them, and hangs are bucketed without a replay.
+- Status: work/status.json is rewritten every few seconds with per-worker and
+  total execs/sec, coverage over time and the unique crash list.
+
+Usage:
+    python3 fuzz_orchestrator.py [--jobs N] [--mix fuzztest=1,libfuzzer=2,radamsa=1]
+                                 [--duration SECONDS] [--sync-interval SECONDS]
+"""
+
+import argparse
+import concurrent.futures
+import hashlib
+import json
+import os
+import random
+import re
+import shutil
+import signal
+import subprocess
+import sys
+import time
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+
+DEFAULT_FUZZTEST_TESTS = [
+    "FuzzMqttGrammar",
+    "FuzzHttpGrammar",
+    "FuzzJsonGrammar",
+    "FuzzMqttTopicParsing",
+    "FuzzHttpRequestParsing",
+]
+
+# Frames that say where the sanitizer or libc noticed the bug, not where it is
+SKIP_FRAME = re.compile(
+    r"__asan|__ubsan|__sanitizer|__interceptor|___interceptor|__libc_|__GI_|"
+    r"libFuzzer|fuzzer::|fuzztest::|LLVMFuzzerTestOneInput|_start\b|"
+    r"sanitizer_common|compiler-rt|libsanitizer|asan_interceptors|"
+    r"/lib(asan|ubsan|c|stdc\+\+)\.so|"
+    r"\b(str|mem|v?sn?printf|printf|malloc|free)\w*$"
+)
+FRAME = re.compile(r"^\s*#\d+\s+0x[0-9a-f]+\s+(?:in\s+(\S+)(?:\s+(\S+))?|\((\S+)\))")
+ASAN_KIND = re.compile(r"ERROR: \w+Sanitizer: ([\w-]+)")
+UBSAN_KIND = re.compile(r"runtime error: (.*)")
+UBSAN_LOCATION = re.compile(r"(\S+:\d+):\d+: runtime error:")
+LIBFUZZER_KIND = re.compile(r"ERROR: libFuzzer: ([\w-]+(?: signal)?)")
+
+STACK_DEPTH = 3
+REPLAY_THREADS = 2
+
+
+def stack_signature(report):
+    """Returns (hash, kind, frames) for a sanitizer report, or None."""
+    frames = []
+    in_stack = False
+    for line in report.splitlines():
+        m = FRAME.match(line)
+        if not m:
+            # Only the first stack trace, not the allocation or frame info
+            if in_stack and not line.strip():
+                break
+            continue
+        in_stack = True
+        func, location, module = m.groups()
+        if func:
+            if SKIP_FRAME.search(func) or (location and SKIP_FRAME.search(location)):
+                continue
+            frames.append(func)
+        elif module and not SKIP_FRAME.search(module):
+            # Unsymbolized: keep module+offset, stable for one binary only
+            frames.append(os.path.basename(module))
+        if len(frames) == STACK_DEPTH:
+            break
+    if not frames:
+        # UBSan without print_stacktrace only names the source line
+        m = UBSAN_LOCATION.search(report)
+        if not m:
+            return None
+        frames.append(os.path.basename(m.group(1)))
+    digest = hashlib.sha1("|".join(frames).encode()).hexdigest()[:12]
+    return digest, crash_kind(report), frames
+
+
+def crash_kind(report):
+    # Markers put in front by the orchestrator for reports without one
+    first = report.split("\n", 1)[0]
+    if first in ("timeout", "error"):
+        return first
+    m = ASAN_KIND.search(report)
+    if m:
+        return m.group(1)
+    m = UBSAN_KIND.search(report)
+    if m:
+        # "index 129 out of bounds for type 'char [128]'" -> without the numbers
+        return "ubsan: " + re.sub(r" ?-?\d+", "", m.group(1))[:60]
+    m = LIBFUZZER_KIND.search(report)
+    if m:
+        return "libfuzzer: " + m.group(1)
+    return "unknown"
+
+
+def kind_signature(kind):
+    """Signature of a report without stack frames: its error class."""
+    return hashlib.sha1(("no-stack|" + kind).encode()).hexdigest()[:12], kind, []
+
+
+def content_name(data):
+    return hashlib.sha1(data).hexdigest()
+
+
+class Worker:
+    def __init__(self, wid, engine, target, workdir, core):
+        self.id = wid
+        self.engine = engine
+        self.target = target
+        self.dir = workdir
+        self.core = core
+        self.proc = None
+        self.log = os.path.join(workdir, "worker.log")
+        self.restarts = 0
+        self.execs_per_s = 0
+        self.coverage = 0
+        self.seen_crash_files = set()
+        os.makedirs(workdir, exist_ok=True)
+
+    def start(self, cmd, env=None):
+        with open(self.log, "ab") as log:
+            core = self.core
+
+            def pin():
+                if core is not None and hasattr(os, "sched_setaffinity"):
+                    os.sched_setaffinity(0, {core})
+                os.setsid()
+
+            self.proc = subprocess.Popen(cmd, stdout=log, stderr=subprocess.STDOUT, cwd=self.dir,
+                                         env=env, preexec_fn=pin)
+
+    def running(self):
+        return self.proc is not None and self.proc.poll() is None
+
+    def stop(self):
+        if self.running():
+            os.killpg(self.proc.pid, signal.SIGTERM)
+            try:
+                self.proc.wait(timeout=5)
+            except subprocess.TimeoutExpired:
+                os.killpg(self.proc.pid, signal.SIGKILL)
+                self.proc.wait()
+
+    def log_tail(self, size=16384):
+        try:
+            with open(self.log, "rb") as f:
+                f.seek(0, os.SEEK_END)
+                f.seek(max(0, f.tell() - size))
+                return f.read().decode(errors="replace")
+        except OSError:
+            return ""
+
+    def status(self):
+        return {
+            "id": self.id,
+            "engine": self.engine,
+            "target": self.target,
+            "core": self.core,
+            "pid": self.proc.pid if self.running() else None,
+            "restarts": self.restarts,
+            "execs_per_s": self.execs_per_s,
+            "coverage": self.coverage,
+        }
+
+
+class Orchestrator:
+    def __init__(self, args):
+        self.args = args
+        self.work = os.path.abspath(args.work_dir)
+        self.corpus = os.path.join(self.work, "corpus")
+        self.crashes = os.path.join(self.work, "crashes")
+        self.triage_dir = os.path.join(self.work, "triage")
+        self.status_file = os.path.join(self.work, "status.json")
+        for d in (self.corpus, self.crashes, self.triage_dir):
+            os.makedirs(d, exist_ok=True)
+        self.workers = []
+        self.unique = {}            # hash -> crash record
+        self.raw_to_hash = {}       # unsymbolized signature -> (hash, kind, frames)
+        self.pending = {}           # unsymbolized signature -> replay future and its hits
+        self.replays = concurrent.futures.ThreadPoolExecutor(REPLAY_THREADS)
+        self.replay_timeout = max(5, 10 * args.timeout_ms / 1000)
+        self.stashed = 0
+        self.total_crashes = 0
+        self.history = []
+        self.start_time = time.time()
+        self.epoch = 0
+        self.seed_corpus()
+
+    # ------------------------------------------------------------------
+    # Setup
+
+    def seed_corpus(self):
+        with open(self.args.seeds, "rb") as f:
+            for line in f.read().splitlines():
+                if line:
+                    self.add_to_corpus(line)
+
+    def add_to_corpus(self, data):
+        path = os.path.join(self.corpus, content_name(data))
+        if os.path.exists(path):
+            return False
+        with open(path, "wb") as f:
+            f.write(data)
+        return True
+
+    def available_engines(self):
+        found = {}
+        for engine, binary in (("fuzztest", self.args.fuzztest_bin),
+                               ("libfuzzer", self.args.libfuzzer_bin),
+                               ("radamsa", self.args.radamsa_bin)):
+            if binary and os.access(binary, os.X_OK):
+                found[engine] = os.path.abspath(binary)
+            else:
+                print(f"Note: {engine} binary not found ({binary}), no {engine} workers")
+        return found
+
+    def plan_workers(self):
+        self.binaries = self.available_engines()
+        weights = {}
+        for part in self.args.mix.split(","):
+            name, _, weight = part.partition("=")
+            if name in self.binaries and int(weight or 1) > 0:
+                weights[name] = int(weight or 1)
+        if not weights:
+            print("Error: none of the requested engines is available")
+            sys.exit(1)
+
+        # Round-robin over the weighted engine list, one worker per core
+        order = [e for e, w in weights.items() for _ in range(w)]
+        cores = sorted(os.sched_getaffinity(0)) if hasattr(os, "sched_getaffinity") else [None]
+        ft_index = 0
+        for i in range(self.args.jobs):
+            engine = order[i % len(order)]
+            target = ""
+            if engine == "fuzztest":
+                target = self.args.fuzztest_tests[ft_index % len(self.args.fuzztest_tests)]
+                ft_index += 1
+            wid = f"{engine}-{i}"
+            self.workers.append(Worker(wid, engine, target, os.path.join(self.work, "workers", wid),
+                                       cores[i % len(cores)]))
+
+    # ------------------------------------------------------------------
+    # Workers
+
+    def start_worker(self, w):
+        seed = random.randrange(1 << 31)
+        env = dict(os.environ)
+        if w.engine == "libfuzzer":
+            os.makedirs(os.path.join(w.dir, "corpus"), exist_ok=True)
+            cmd = [self.binaries["libfuzzer"], "corpus", self.corpus,
+                   f"-seed={seed}", "-reload=1", "-print_final_stats=1",
+                   f"-timeout={max(1, self.args.timeout_ms // 1000)}",
+                   "-artifact_prefix=" + os.path.join(w.dir, "")]
+        elif w.engine == "radamsa":
+            cmd = [self.binaries["radamsa"], "-n", str(1 << 62), "-s", str(seed),
+                   "-t", str(self.args.timeout_ms), "-i", self.radamsa_seeds(), "-o", "."]
+        else:
+            test_corpus = os.path.join(self.work, "fuzztest_corpus", w.target)
+            os.makedirs(test_corpus, exist_ok=True)
+            env["FUZZTEST_TESTSUITE_IN_DIR"] = test_corpus
+            env["FUZZTEST_TESTSUITE_OUT_DIR"] = os.path.join(w.dir, "corpus")
+            cmd = [self.binaries["fuzztest"], f"--fuzz=IoTParserTest.{w.target}",
+                   f"--fuzz_for={self.args.sync_interval}s"]
+        w.start(cmd, env)
+
+    def radamsa_seeds(self):
+        """Seed file for persistent_fuzzer: first line of a sample of corpus
+        entries (the parser only reads one line), at most 4 KiB."""
+        path = os.path.join(self.work, "radamsa_seeds.txt")
+        entries = []
+        for name in os.listdir(self.corpus):
+            with open(os.path.join(self.corpus, name), "rb") as f:
+                line = f.read().split(b"\n", 1)[0]
+            if line:
+                entries.append(line)
+        random.shuffle(entries)
+        out, size = [], 0
+        for line in sorted(entries[:256], key=len):
+            if size + len(line) + 1 > 4096:
+                break
+            out.append(line)
+            size += len(line) + 1
+        with open(path, "wb") as f:
+            f.write(b"\n".join(out) + b"\n")
+        return path
+
+    def update_stats(self, w):
+        tail = w.log_tail()
+        if w.engine == "libfuzzer":
+            hits = re.findall(r"cov: (\d+) .*?exec/s: (\d+)", tail)
+            if hits:
+                w.coverage, w.execs_per_s = int(hits[-1][0]), int(hits[-1][1])
+        elif w.engine == "fuzztest":
+            hits = re.findall(r"Edges covered:\s*(\d+).*?Runs/secs:\s*(\d+)", tail)
+            if hits:
+                w.coverage, w.execs_per_s = int(hits[-1][0]), int(hits[-1][1])
+        else:
+            hits = re.findall(r"- (\d+) execs/s", tail)
+            if hits:
+                w.execs_per_s = int(hits[-1])
+
+    # ------------------------------------------------------------------
+    # Crashes
+
+    def symbolized(self, input_path, report):
+        """Replays a raw input through the symbolizing persistent_fuzzer.
+        Runs on the replay pool, so it must not touch orchestrator state."""
+        env = dict(os.environ, ASAN_OPTIONS="symbolize=1", UBSAN_OPTIONS="print_stacktrace=1")
+        try:
+            replay = subprocess.run([self.binaries["radamsa"], "-r", input_path], env=env,
+                                    stdout=subprocess.DEVNULL, stderr=subprocess.PIPE,
+                                    timeout=self.replay_timeout)
+        except subprocess.TimeoutExpired:
+            return "timeout\n" + report
+        text = replay.stderr.decode(errors="replace")
+        return text if stack_signature(text) else report
+
+    def triage(self, w, input_path, report):
+        """Hashes a crash report.
+
+        Reports saved by the workers are unsymbolized (addresses only), which
+        is enough to recognize a repeat of the same crash in the same binary.
+        Only an unseen raw signature is replayed for a symbolized stack, so a
+        bug hit thousands of times costs one replay. The replay runs on the
+        replay pool; hits of that signature wait in self.pending (with a copy
+        of their input, the workers delete theirs) until finish_replays()
+        records them.
+
+        Reports without a stack (hangs, plain signals, exit errors) are
+        bucketed by their error class instead. Hangs are not replayed."""
+        raw = stack_signature(report)
+        kind = crash_kind(report)
+        key = raw[0] if raw else kind_signature(kind)[0]
+        if key in self.raw_to_hash:
+            self.record(w, input_path, report, self.raw_to_hash[key])
+            return
+        if kind == "timeout" or not input_path or "radamsa" not in self.binaries:
+            self.raw_to_hash[key] = raw or kind_signature(kind)
+            self.record(w, input_path, report, self.raw_to_hash[key])
+            return
+        self.stashed += 1
+        stash = os.path.join(self.triage_dir, f"{key}-{self.stashed}")
+        shutil.copy(input_path, stash)
+        if key not in self.pending:
+            self.pending[key] = {"future": self.replays.submit(self.symbolized, stash, report),
+                                 "hits": []}
+        self.pending[key]["hits"].append((w, stash, report))
+
+    def finish_replays(self, wait=False):
+        """Records the hits of every finished replay (of all, with wait)."""
+        for key, p in list(self.pending.items()):
+            if not wait and not p["future"].done():
+                continue
+            del self.pending[key]
+            first_report = p["hits"][0][2]
+            try:
+                first_report = p["future"].result()
+            except Exception as e:
+                print(f"[{self.elapsed()}] Replay of {key} failed: {e}")
+            sig = stack_signature(first_report) or kind_signature(crash_kind(first_report))
+            self.raw_to_hash[key] = sig
+            for i, (w, stash, report) in enumerate(p["hits"]):
+                self.record(w, stash, first_report if i == 0 else report, sig)
+                os.remove(stash)
+
+    def record(self, w, input_path, report, sig):
+        """Counts one hit of sig. Returns True for a new unique crash."""
+        digest, kind, frames = sig
+
+        self.total_crashes += 1
+        record = self.unique.get(digest)
+        if record:
+            record["count"] += 1
+            return False
+        dest = os.path.join(self.crashes, digest)
+        os.makedirs(dest, exist_ok=True)
+        if input_path:
+            shutil.copy(input_path, os.path.join(dest, "input"))
+        with open(os.path.join(dest, "report.txt"), "w") as f:
+            f.write(report)
+        self.unique[digest] = {
+            "hash": digest,
+            "kind": kind,
+            "frames": frames,
+            "engine": w.engine,
+            "worker": w.id,
+            "first_seen_s": round(time.time() - self.start_time, 1),
+            "count": 1,
+            "dir": os.path.relpath(dest, self.work),
+        }
+        print(f"[{self.elapsed()}] New crash {digest} ({kind}) in {' < '.join(frames) or '?'} from {w.id}")
+        return True
+
+    def collect_crashes(self, w):
+        if w.engine == "libfuzzer":
+            for name in sorted(os.listdir(w.dir)):
+                if name.startswith(("crash-", "timeout-", "leak-", "oom-")) and name not in w.seen_crash_files:
+                    w.seen_crash_files.add(name)
+                    report = w.log_tail(65536)
+                    if name.startswith("timeout-"):
+                        report = "timeout\n" + report
+                    self.triage(w, os.path.join(w.dir, name), report)
+        elif w.engine == "radamsa":
+            # Inputs and reports are moved to work/crashes/ or dropped as
+            # duplicates; a parser bug is typically hit every few runs
+            for sub in ("crashes", "timeouts", "errors"):
+                d = os.path.join(w.dir, sub)
+                if not os.path.isdir(d):
+                    continue
+                for name in sorted(os.listdir(d)):
+                    if not name.endswith(".txt"):
+                        continue
+                    path = os.path.join(d, name)
+                    report = ""
+                    if os.path.exists(path + ".log"):
+                        with open(path + ".log", errors="replace") as f:
+                            report = f.read()
+                    if sub == "timeouts":
+                        report = "timeout\n" + report
+                    elif sub == "errors":
+                        report = "error\n" + report
+                    self.triage(w, path, report)
+                    for f in (path, path + ".log"):
+                        if os.path.exists(f):
+                            os.remove(f)
+
+    def worker_exited(self, w):
+        """FuzzTest and libFuzzer stop at the first crash; record it and restart."""
+        rc = w.proc.returncode
+        if w.engine == "fuzztest":
+            self.merge_fuzztest_corpus(w)
+            if rc != 0:
+                self.triage(w, None, w.log_tail(65536))
+        elif w.engine == "libfuzzer":
+            self.collect_crashes(w)
+        w.restarts += 1
+        # Keep only the last run in the log, the next one starts fresh
+        os.replace(w.log, w.log + ".prev")
+        self.start_worker(w)
+
+    # ------------------------------------------------------------------
+    # Corpus
+
+    def merge_fuzztest_corpus(self, w):
+        src = os.path.join(w.dir, "corpus")
+        dst = os.path.join(self.work, "fuzztest_corpus", w.target)
+        if not os.path.isdir(src):
+            return
+        for root, _, files in os.walk(src):
+            for name in files:
+                with open(os.path.join(root, name), "rb") as f:
+                    data = f.read()
+                path = os.path.join(dst, content_name(data))
+                if not os.path.exists(path):
+                    with open(path, "wb") as f:
+                        f.write(data)
+
+    def sync(self):
+        self.epoch += 1
+        added = 0
+        for w in self.workers:
+            if w.engine != "libfuzzer":
+                continue
+            d = os.path.join(w.dir, "corpus")
+            for name in os.listdir(d) if os.path.isdir(d) else []:
+                with open(os.path.join(d, name), "rb") as f:
+                    added += self.add_to_corpus(f.read())
+        before = len(os.listdir(self.corpus))
+        if "libfuzzer" in self.binaries:
+            self.minimize()
+        after = len(os.listdir(self.corpus))
+        print(f"[{self.elapsed()}] Sync #{self.epoch}: +{added} inputs, corpus {before} -> {after}")
+        # Restart radamsa workers on the new corpus
+        for w in self.workers:
+            if w.engine == "radamsa":
+                self.collect_crashes(w)
+                w.stop()
+                self.start_worker(w)
+
+    def minimize(self):
+        merged = self.corpus + ".min"
+        shutil.rmtree(merged, ignore_errors=True)
+        os.makedirs(merged)
+        result = subprocess.run([self.binaries["libfuzzer"], "-merge=1", merged, self.corpus],
+                                stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL,
+                                timeout=max(60, self.args.sync_interval))
+        if result.returncode == 0 and os.listdir(merged):
+            old = self.corpus + ".old"
+            os.replace(self.corpus, old)
+            os.replace(merged, self.corpus)
+            shutil.rmtree(old, ignore_errors=True)
+        else:
+            shutil.rmtree(merged, ignore_errors=True)
+
+    # ------------------------------------------------------------------
+    # Status
+
+    def elapsed(self):
+        s = int(time.time() - self.start_time)
+        return f"{s // 3600:02d}:{s % 3600 // 60:02d}:{s % 60:02d}"
+
+    def write_status(self):
+        coverage = {}
+        for w in self.workers:
+            if w.engine != "radamsa":
+                coverage[w.engine] = max(coverage.get(w.engine, 0), w.coverage)
+        corpus_size = len(os.listdir(self.corpus))
+        now = round(time.time() - self.start_time, 1)
+        self.history.append({"t": now, "corpus": corpus_size, **coverage})
+        if len(self.history) > 2000:
+            self.history = self.history[::2]
+        status = {
+            "updated": time.strftime("%Y-%m-%dT%H:%M:%S"),
+            "elapsed_s": now,
+            "sync_epoch": self.epoch,
+            "totals": {
+                "workers": len(self.workers),
+                "execs_per_s": sum(w.execs_per_s for w in self.workers),
+                "coverage": coverage,
+                "corpus_size": corpus_size,
+                "crashes": self.total_crashes,
+                "unique_crashes": len(self.unique),
+            },
+            "workers": [w.status() for w in self.workers],
+            "unique_crashes": sorted(self.unique.values(), key=lambda r: r["first_seen_s"]),
+            "coverage_history": self.history,
+        }
+        tmp = self.status_file + ".tmp"
+        with open(tmp, "w") as f:
+            json.dump(status, f, indent=2)
+        os.replace(tmp, self.status_file)
+        return status
+
+    # ------------------------------------------------------------------
+
+    def run(self):
+        self.plan_workers()
+        for w in self.workers:
+            self.start_worker(w)
+        print(f"Started {len(self.workers)} workers: " + ", ".join(w.id for w in self.workers))
+        print(f"Status file: {self.status_file}")
+
+        stop = []
+        signal.signal(signal.SIGINT, lambda *_: stop.append(1))
+        signal.signal(signal.SIGTERM, lambda *_: stop.append(1))
+        next_sync = time.time() + self.args.sync_interval
+        deadline = time.time() + self.args.duration if self.args.duration else None
+        try:
+            while not stop and (deadline is None or time.time() < deadline):
+                time.sleep(self.args.status_interval)
+                for w in self.workers:
+                    self.update_stats(w)
+                    if w.engine == "radamsa" or w.engine == "libfuzzer":
+                        self.collect_crashes(w)
+                    if not w.running():
+                        self.worker_exited(w)
+                self.finish_replays()
+                if time.time() >= next_sync:
+                    self.sync()
+                    next_sync = time.time() + self.args.sync_interval
+                s = self.write_status()["totals"]
+                print(f"[{self.elapsed()}] {s['execs_per_s']} execs/s, corpus {s['corpus_size']}, "
+                      f"coverage {s['coverage']}, crashes {s['crashes']} ({s['unique_crashes']} unique)")
+        finally:
+            for w in self.workers:
+                w.stop()
+                self.collect_crashes(w)
+            self.finish_replays(wait=True)
+            self.replays.shutdown()
+            self.write_status()
+        print(f"\nDone. {len(self.unique)} unique crashes, see {self.crashes}/ and {self.status_file}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Multi-core fuzzing orchestrator for the IoT parser")
+    parser.add_argument("--jobs", "-j", type=int, default=os.cpu_count() or 1,
+                        help="number of workers, one per core (default: all cores)")
+    parser.add_argument("--mix", default="fuzztest=1,libfuzzer=2,radamsa=1",
+                        help="engine weights (default: fuzztest=1,libfuzzer=2,radamsa=1)")
+    parser.add_argument("--duration", type=int, default=0, help="seconds to run, 0 = until Ctrl+C")
+    parser.add_argument("--sync-interval", type=int, default=300, help="corpus sync period in seconds")
+    parser.add_argument("--status-interval", type=int, default=5, help="status file update period in seconds")
+    parser.add_argument("--timeout-ms", type=int, default=1000, help="per-input timeout")
+    parser.add_argument("--work-dir", default="work", help="corpus, crashes and status.json go here")
+    parser.add_argument("--seeds", default=os.path.join(HERE, "../radamsa/sample_inputs.txt"))
+    parser.add_argument("--fuzztest-bin", default=os.path.join(HERE, "../fuzztest/build_fuzz/iot_parser_fuzztest"))
+    parser.add_argument("--libfuzzer-bin", default=os.path.join(HERE, "build/iot_parser_libfuzzer"))
+    parser.add_argument("--radamsa-bin", default=os.path.join(HERE, "../radamsa/build/persistent_fuzzer"))
+    parser.add_argument("--fuzztest-tests", default=",".join(DEFAULT_FUZZTEST_TESTS),
+                        help="comma-separated FUZZ_TEST names, assigned round-robin")
+    args = parser.parse_args()
+    args.fuzztest_tests = [t for t in args.fuzztest_tests.split(",") if t]
+    sys.stdout.reconfigure(line_buffering=True)
+    Orchestrator(args).run()
+
+
+if __name__ == "__main__":
+    main()
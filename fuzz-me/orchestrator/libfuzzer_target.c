@@ -0,0 +1,14 @@
+// libFuzzer entry point for the IoT parser, driven by fuzz_orchestrator.py.
+// Inputs take the same path as a line typed into the interactive parser.
+#include <stddef.h>
+#include <stdint.h>
+
+#include "iot_replay.h"
+
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    iot_parser_replay(data, size);
+    return 0;
+}
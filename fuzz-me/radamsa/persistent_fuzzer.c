@@ -0,0 +1,577 @@
+// Persistent-mode radamsa driver for the IoT parser.
+//
+// run_fuzzer.sh starts one parser process per mutated input. This driver
+// links the parser in-process and runs inputs in a loop in a forked worker:
+//
+//   supervisor ── fork ──> worker: mutate -> replay -> mutate -> ...
+//        ^                   |  watchdog thread (per-input timeout)
+//        └── waitpid ────────┘
+//
+// The worker publishes every input in shared memory before running it. When
+// a sanitizer aborts it, it crashes or the watchdog fires, the supervisor
+// saves that input using the same categories, file names and log format as
+// run_fuzzer.sh and starts a new worker with the next input.
+//
+// Mutations are deterministic per run index (seed + run), so a worker that is
+// restarted after a failure continues exactly where the previous one stopped.
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "iot_replay.h"
+
+#define MAX_FUZZ_INPUT 4096
+#define MAX_SEEDS 256
+
+// Worker exit codes. 124 is what timeout(1) returns, so hangs are reported
+// the same way as by run_fuzzer.sh.
+#define EXIT_TIMEOUT 124
+#define EXIT_SETUP 125
+
+#ifdef HAVE_LIBRADAMSA
+// libradamsa (radamsa/c/libradamsa.c)
+void init(void);
+size_t radamsa(uint8_t* ptr, size_t len, uint8_t* target, size_t max, unsigned int seed);
+#endif
+
+typedef enum {
+    MUTATOR_BUILTIN,
+    MUTATOR_RADAMSA,        // radamsa CLI, one process per batch
+    MUTATOR_LIBRADAMSA,
+} mutator_t;
+
+typedef struct {
+    long runs;
+    unsigned timeout_ms;
+    unsigned seed;
+    unsigned batch;
+    mutator_t mutator;
+    const char* seeds_file;
+    const char* out_dir;
+    const char* reproduce;
+} options_t;
+
+typedef struct {
+    char* data;             // whole seed file
+    size_t size;
+    size_t count;           // lines, for the builtin mutator
+    size_t line_off[MAX_SEEDS];
+    size_t line_len[MAX_SEEDS];
+} seeds_t;
+
+enum { PHASE_MUTATE, PHASE_EXEC };
+
+// Shared between supervisor and worker (MAP_SHARED)
+typedef struct {
+    atomic_long run;        // index of the input in data[]
+    atomic_int phase;
+    size_t len;
+    uint8_t data[MAX_FUZZ_INPUT];
+} shared_state_t;
+
+#if defined(__SANITIZE_ADDRESS__)
+// Symbolizing each report costs more than everything else a restart does.
+// Environment ASAN_OPTIONS still take precedence; saved inputs can be replayed
+// with -r and ASAN_OPTIONS=symbolize=1 for a symbolized trace.
+const char* __asan_default_options(void);
+const char* __asan_default_options(void)
+{
+    return "symbolize=0";
+}
+#endif
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// ---------------------------------------------------------------------------
+// Mutators
+
+static uint32_t xorshift(uint32_t* s)
+{
+    uint32_t x = *s;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *s = x;
+}
+
+static const char* const interesting[] = {
+    "-1", "0", "4294967296", "99999999999999999999", "-9223372036854775809",
+    "%s%s%s%n", "%x%x%x", "\"", "\\", "{", "}", ":", ",", " ", "\n", "\xff\xfe",
+};
+
+// Stacks 1-4 byte-level edits on one seed line, in the spirit of radamsa's
+// default mutations (flips, repeats, deletions, splicing, special values).
+static size_t mutate_builtin(const seeds_t* seeds, uint32_t seed, uint8_t* out, size_t max)
+{
+    uint32_t s = seed * 2654435761u + 1;
+    size_t line = xorshift(&s) % seeds->count;
+    size_t len = seeds->line_len[line] < max ? seeds->line_len[line] : max;
+    memcpy(out, seeds->data + seeds->line_off[line], len);
+
+    int edits = 1 + (int)(xorshift(&s) % 4);
+    for (int e = 0; e < edits && len > 0; ++e) {
+        size_t at = xorshift(&s) % len;
+        size_t span = 1 + xorshift(&s) % (len - at);
+        switch (xorshift(&s) % 6) {
+        case 0:     // bit flip
+            out[at] ^= (uint8_t)(1u << (xorshift(&s) % 8));
+            break;
+        case 1:     // delete a range
+            memmove(out + at, out + at + span, len - at - span);
+            len -= span;
+            break;
+        case 2: {   // repeat a short range, occasionally many times
+            unsigned times = 1 + xorshift(&s) % ((xorshift(&s) & 15) == 0 ? 64 : 4);
+            span = span < 8 ? span : 1 + span % 8;
+            for (unsigned t = 0; t < times && len + span <= max; ++t) {
+                memmove(out + at + span, out + at, len - at);
+                len += span;
+            }
+            break;
+        }
+        case 3: {   // insert a special value
+            const char* v = interesting[xorshift(&s) % (sizeof(interesting) / sizeof(interesting[0]))];
+            size_t vlen = strlen(v);
+            if (len + vlen <= max) {
+                memmove(out + at + vlen, out + at, len - at);
+                memcpy(out + at, v, vlen);
+                len += vlen;
+            }
+            break;
+        }
+        case 4: {   // splice the tail of another seed
+            size_t other = xorshift(&s) % seeds->count;
+            size_t olen = seeds->line_len[other];
+            size_t from = olen ? xorshift(&s) % olen : 0;
+            size_t n = olen - from < max - at ? olen - from : max - at;
+            memcpy(out + at, seeds->data + seeds->line_off[other] + from, n);
+            len = at + n;
+            break;
+        }
+        default:    // random byte
+            out[at] = (uint8_t)xorshift(&s);
+            break;
+        }
+    }
+    return len;
+}
+
+typedef struct {
+    char dir[PATH_MAX];
+    long batch_index;       // batch currently in dir, -1 if none
+} radamsa_batch_t;
+
+static size_t read_file(const char* path, uint8_t* out, size_t max)
+{
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        return 0;
+    }
+    size_t n = fread(out, 1, max, f);
+    fclose(f);
+    return n;
+}
+
+// radamsa writes a whole batch of outputs into a tmpfs directory per call,
+// which keeps process start-up off the per-input path
+static int mutate_radamsa(const options_t* opt, radamsa_batch_t* rb, long run, uint8_t* out, size_t* len)
+{
+    long batch = run / (long)opt->batch;
+    if (batch != rb->batch_index) {
+        char cmd[3 * PATH_MAX];
+        snprintf(cmd, sizeof(cmd), "radamsa -s %lu -n %u -o '%s/%%n' '%s'",
+                 (unsigned long)opt->seed + (unsigned long)batch, opt->batch, rb->dir, opt->seeds_file);
+        if (system(cmd) != 0) {
+            return -1;
+        }
+        rb->batch_index = batch;
+    }
+    char path[PATH_MAX + 32];
+    snprintf(path, sizeof(path), "%s/%ld", rb->dir, run % (long)opt->batch + 1);
+    *len = read_file(path, out, MAX_FUZZ_INPUT);
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+// Worker
+
+typedef struct {
+    const options_t* opt;
+    shared_state_t* shared;
+} watchdog_arg_t;
+
+static void* watchdog_main(void* p)
+{
+    watchdog_arg_t* arg = p;
+    long last_run = -1;
+    double since = now_s();
+    double timeout = arg->opt->timeout_ms / 1000.0;
+    useconds_t tick = arg->opt->timeout_ms * 100;   // a tenth of the timeout, in us
+    for (;;) {
+        usleep(tick ? tick : 1000);
+        long run = atomic_load(&arg->shared->run);
+        if (run != last_run || atomic_load(&arg->shared->phase) != PHASE_EXEC) {
+            last_run = run;
+            since = now_s();
+        } else if (now_s() - since > timeout) {
+            _exit(EXIT_TIMEOUT);
+        }
+    }
+    return NULL;
+}
+
+static int worker(const options_t* opt, const seeds_t* seeds, shared_state_t* shared, long first)
+{
+    // Parser output is not needed; stderr keeps the sanitizer reports
+    if (!freopen("/dev/null", "w", stdout)) {
+        return EXIT_SETUP;
+    }
+    char report[PATH_MAX];
+    snprintf(report, sizeof(report), "%s/worker.stderr", opt->out_dir);
+    if (!freopen(report, "w", stderr)) {
+        return EXIT_SETUP;
+    }
+
+    radamsa_batch_t rb = { .batch_index = -1 };
+    if (opt->mutator == MUTATOR_RADAMSA) {
+        const char* tmp = access("/dev/shm", W_OK) == 0 ? "/dev/shm" : "/tmp";
+        snprintf(rb.dir, sizeof(rb.dir), "%s/iot_radamsa_XXXXXX", tmp);
+        if (!mkdtemp(rb.dir)) {
+            return EXIT_SETUP;
+        }
+    }
+#ifdef HAVE_LIBRADAMSA
+    if (opt->mutator == MUTATOR_LIBRADAMSA) {
+        init();
+    }
+#endif
+
+    pthread_t watchdog;
+    watchdog_arg_t arg = { opt, shared };
+    if (pthread_create(&watchdog, NULL, watchdog_main, &arg) != 0) {
+        return EXIT_SETUP;
+    }
+
+    int rc = 0;
+    for (long run = first; run < opt->runs; ++run) {
+        atomic_store(&shared->phase, PHASE_MUTATE);
+        size_t len = 0;
+        unsigned seed = opt->seed + (unsigned)run;
+        switch (opt->mutator) {
+        case MUTATOR_RADAMSA:
+            if (mutate_radamsa(opt, &rb, run, shared->data, &len) != 0) {
+                fprintf(stderr, "radamsa failed\n");
+                rc = EXIT_SETUP;
+            }
+            break;
+#ifdef HAVE_LIBRADAMSA
+        case MUTATOR_LIBRADAMSA:
+            len = radamsa((uint8_t*)seeds->data, seeds->size, shared->data, MAX_FUZZ_INPUT, seed);
+            break;
+#endif
+        default:
+            len = mutate_builtin(seeds, seed, shared->data, MAX_FUZZ_INPUT);
+            break;
+        }
+        if (rc != 0) {
+            break;
+        }
+        shared->len = len;
+        atomic_store(&shared->run, run);
+        atomic_store(&shared->phase, PHASE_EXEC);
+        iot_parser_replay(shared->data, len);
+    }
+
+    if (opt->mutator == MUTATOR_RADAMSA) {
+        char cmd[PATH_MAX + 16];
+        snprintf(cmd, sizeof(cmd), "rm -rf '%s'", rb.dir);
+        if (system(cmd) != 0) {
+            fprintf(stderr, "failed to remove %s\n", rb.dir);
+        }
+    }
+    return rc;
+}
+
+// ---------------------------------------------------------------------------
+// Supervisor
+
+typedef struct {
+    const char* label;      // log label
+    const char* prefix;     // file name prefix
+    const char* dir;
+    int count;
+} category_t;
+
+static void save_failure(const options_t* opt, category_t* cat, const shared_state_t* shared,
+                         long run, int exit_code)
+{
+    cat->count++;
+    time_t t = time(NULL);
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s/%s/%s_%ld_%ld.txt", opt->out_dir, cat->dir, cat->prefix,
+             (long)t, run + 1);
+    FILE* f = fopen(path, "wb");
+    if (f) {
+        fwrite(shared->data, 1, shared->len, f);
+        fclose(f);
+    }
+
+    // Keep the sanitizer report next to the input
+    char report[PATH_MAX], saved_report[PATH_MAX + 8];
+    snprintf(report, sizeof(report), "%s/worker.stderr", opt->out_dir);
+    snprintf(saved_report, sizeof(saved_report), "%s.log", path);
+    struct stat st;
+    int have_report = stat(report, &st) == 0 && st.st_size > 0 && rename(report, saved_report) == 0;
+
+    char date[64];
+    strftime(date, sizeof(date), "%a %d %b %Y %I:%M:%S %p %Z", localtime(&t));
+    snprintf(report, sizeof(report), "%s/fuzzing.log", opt->out_dir);
+    FILE* log = fopen(report, "a");
+    if (log) {
+        fprintf(log, "%s: %s #%d - Run %ld - Exit code: %d\n", date, cat->label, cat->count,
+                run + 1, exit_code);
+        fprintf(log, "Input saved to: %s/%s_%ld_%ld.txt\n", cat->dir, cat->prefix, (long)t, run + 1);
+        if (have_report) {
+            fprintf(log, "Report saved to: %s/%s_%ld_%ld.txt.log\n", cat->dir, cat->prefix, (long)t, run + 1);
+        }
+        fclose(log);
+    }
+}
+
+static void print_progress(long done, long runs, const category_t* cats, double elapsed)
+{
+    printf("Progress: %ld/%ld runs - Crashes: %d - Timeouts: %d - Errors: %d - %.0f execs/s\n",
+           done, runs, cats[0].count, cats[1].count, cats[2].count, elapsed > 0 ? done / elapsed : 0.0);
+    fflush(stdout);
+}
+
+static int supervise(const options_t* opt, const seeds_t* seeds)
+{
+    category_t cats[] = {
+        { "Crash", "crash", "crashes", 0 },
+        { "Timeout", "timeout", "timeouts", 0 },
+        { "Error", "error", "errors", 0 },
+    };
+    for (size_t i = 0; i < 3; ++i) {
+        char dir[PATH_MAX];
+        snprintf(dir, sizeof(dir), "%s/%s", opt->out_dir, cats[i].dir);
+        mkdir(dir, 0755);
+    }
+
+    shared_state_t* shared = mmap(NULL, sizeof(*shared), PROT_READ | PROT_WRITE,
+                                  MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (shared == MAP_FAILED) {
+        perror("mmap");
+        return 1;
+    }
+    sigset_t sigchld;
+    sigemptyset(&sigchld);
+    sigaddset(&sigchld, SIGCHLD);
+    sigprocmask(SIG_BLOCK, &sigchld, NULL);
+
+    double start = now_s(), last_report = start;
+    long next = 0;
+    int workers = 0;
+    while (next < opt->runs) {
+        atomic_store(&shared->run, next - 1);
+        atomic_store(&shared->phase, PHASE_MUTATE);
+        fflush(stdout);
+        pid_t pid = fork();
+        if (pid < 0) {
+            perror("fork");
+            return 1;
+        }
+        if (pid == 0) {
+            sigprocmask(SIG_UNBLOCK, &sigchld, NULL);
+            _exit(worker(opt, seeds, shared, next));
+        }
+        workers++;
+
+        // Wake up on SIGCHLD, or once a second to report progress
+        int status;
+        while (waitpid(pid, &status, WNOHANG) == 0) {
+            struct timespec tick = { 1, 0 };
+            sigtimedwait(&sigchld, NULL, &tick);
+            double now = now_s();
+            if (now - last_report >= 1.0) {
+                print_progress(atomic_load(&shared->run) + 1, opt->runs, cats, now - start);
+                last_report = now;
+            }
+        }
+        if (WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+            break;
+        }
+
+        long run = atomic_load(&shared->run);
+        if (WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SETUP) {
+            fprintf(stderr, "Error: worker setup failed, see %s/worker.stderr\n", opt->out_dir);
+            return 1;
+        }
+        if (atomic_load(&shared->phase) != PHASE_EXEC) {
+            fprintf(stderr, "Error: worker died while generating input %ld\n", run + 2);
+            return 1;
+        }
+        if (WIFSIGNALED(status)) {
+            save_failure(opt, &cats[0], shared, run, 128 + WTERMSIG(status));
+            printf("C");
+        } else if (WEXITSTATUS(status) == EXIT_TIMEOUT) {
+            save_failure(opt, &cats[1], shared, run, EXIT_TIMEOUT);
+            printf("T");
+        } else {
+            save_failure(opt, &cats[2], shared, run, WEXITSTATUS(status));
+            printf("E");
+        }
+        next = run + 1;
+    }
+
+    double elapsed = now_s() - start;
+    int failed = cats[0].count + cats[1].count + cats[2].count;
+    printf("\n==========================================\n");
+    printf("Fuzzing completed!\n");
+    printf("Total runs: %ld\n", opt->runs);
+    printf("Crashes found: %d\n", cats[0].count);
+    printf("Timeouts: %d\n", cats[1].count);
+    printf("Other errors: %d\n", cats[2].count);
+    printf("Success rate: %.2f%%\n", opt->runs ? (opt->runs - failed) * 100.0 / opt->runs : 100.0);
+    printf("Workers started: %d\n", workers);
+    printf("Throughput: %.0f execs/s (%.2f s)\n", opt->runs / elapsed, elapsed);
+    if (failed > 0) {
+        printf("\nCheck the log file for details: %s/fuzzing.log\n", opt->out_dir);
+    }
+    char report[PATH_MAX];
+    snprintf(report, sizeof(report), "%s/worker.stderr", opt->out_dir);
+    unlink(report);
+    munmap(shared, sizeof(*shared));
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+
+static int load_seeds(const char* path, seeds_t* seeds)
+{
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        return -1;
+    }
+    memset(seeds, 0, sizeof(*seeds));
+    seeds->data = malloc(MAX_FUZZ_INPUT);
+    seeds->size = seeds->data ? fread(seeds->data, 1, MAX_FUZZ_INPUT, f) : 0;
+    fclose(f);
+    size_t start = 0;
+    for (size_t i = 0; i <= seeds->size && seeds->count < MAX_SEEDS; ++i) {
+        if (i == seeds->size || seeds->data[i] == '\n') {
+            if (i > start) {
+                seeds->line_off[seeds->count] = start;
+                seeds->line_len[seeds->count++] = i - start;
+            }
+            start = i + 1;
+        }
+    }
+    return seeds->count > 0 ? 0 : -1;
+}
+
+static void usage(const char* prog)
+{
+    printf("Usage: %s [-n runs] [-t timeout_ms] [-s seed] [-m mutator] [-b batch]\n"
+           "          [-i seed_file] [-o out_dir] [-r input_file]\n", prog);
+    printf("  -n: Number of fuzzing runs (default: 100000)\n");
+    printf("  -t: Timeout per input in milliseconds (default: 1000)\n");
+    printf("  -s: Base seed, input i uses seed + i (default: time)\n");
+    printf("  -m: builtin, radamsa (CLI in batches) or libradamsa (default: radamsa if found)\n");
+    printf("  -b: Inputs per radamsa call (default: 1000)\n");
+    printf("  -i: Seed inputs (default: sample_inputs.txt)\n");
+    printf("  -o: Directory for crashes/, timeouts/, errors/ and fuzzing.log (default: .)\n");
+    printf("  -r: Run one saved input in-process and exit\n");
+}
+
+int main(int argc, char** argv)
+{
+    options_t opt = {
+        .runs = 100000,
+        .timeout_ms = 1000,
+        .seed = (unsigned)time(NULL),
+        .batch = 1000,
+        .mutator = system("command -v radamsa > /dev/null 2>&1") == 0 ? MUTATOR_RADAMSA : MUTATOR_BUILTIN,
+        .seeds_file = "sample_inputs.txt",
+        .out_dir = ".",
+    };
+    int c;
+    while ((c = getopt(argc, argv, "n:t:s:m:b:i:o:r:h")) != -1) {
+        switch (c) {
+        case 'n': opt.runs = atol(optarg); break;
+        case 't': opt.timeout_ms = (unsigned)atoi(optarg); break;
+        case 's': opt.seed = (unsigned)strtoul(optarg, NULL, 0); break;
+        case 'b': opt.batch = (unsigned)atoi(optarg) > 0 ? (unsigned)atoi(optarg) : 1; break;
+        case 'i': opt.seeds_file = optarg; break;
+        case 'o': opt.out_dir = optarg; break;
+        case 'r': opt.reproduce = optarg; break;
+        case 'm':
+            if (strcmp(optarg, "builtin") == 0) {
+                opt.mutator = MUTATOR_BUILTIN;
+            } else if (strcmp(optarg, "radamsa") == 0) {
+                opt.mutator = MUTATOR_RADAMSA;
+            } else if (strcmp(optarg, "libradamsa") == 0) {
+#ifdef HAVE_LIBRADAMSA
+                opt.mutator = MUTATOR_LIBRADAMSA;
+#else
+                fprintf(stderr, "Error: built without libradamsa\n");
+                return 1;
+#endif
+            } else {
+                fprintf(stderr, "Error: unknown mutator %s\n", optarg);
+                return 1;
+            }
+            break;
+        case 'h': usage(argv[0]); return 0;
+        default: usage(argv[0]); return 1;
+        }
+    }
+
+    if (opt.reproduce) {
+        static uint8_t data[MAX_FUZZ_INPUT];
+        FILE* f = fopen(opt.reproduce, "rb");
+        if (!f) {
+            perror(opt.reproduce);
+            return 1;
+        }
+        size_t len = fread(data, 1, sizeof(data), f);
+        fclose(f);
+        iot_parser_replay(data, len);
+        return 0;
+    }
+
+    seeds_t seeds;
+    if (load_seeds(opt.seeds_file, &seeds) != 0) {
+        fprintf(stderr, "Error: no seed inputs in %s\n", opt.seeds_file);
+        return 1;
+    }
+    static const char* const names[] = { "builtin", "radamsa", "libradamsa" };
+    printf("Starting persistent-mode fuzzing...\n");
+    printf("Runs: %ld\n", opt.runs);
+    printf("Timeout: %u ms per input\n", opt.timeout_ms);
+    printf("Mutator: %s (seed %u)\n", names[opt.mutator], opt.seed);
+    printf("Sample file: %s\n", opt.seeds_file);
+    printf("==========================================\n");
+    int rc = supervise(&opt, &seeds);
+    free(seeds.data);
+    return rc;
+}
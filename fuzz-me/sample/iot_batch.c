@@ -0,0 +1,336 @@
+#include "iot_batch.h"
+#include "json_number.h"
+#include "json_scan.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef IOT_BATCH_THREADS
+#include <pthread.h>
+#endif
+
+int iot_batch_init(iot_batch_t* batch, size_t capacity)
+{
+    memset(batch, 0, sizeof(*batch));
+    // One block, widest columns first so every column stays aligned
+    size_t refs = 2 + IOT_FIELD_COUNT;
+    size_t row = sizeof(double) + refs * sizeof(iot_ref_t) + 2;
+    if (capacity > SIZE_MAX / row) {
+        return -1;
+    }
+    size_t size = capacity * row;
+    char* block = malloc(size ? size : 1);
+    if (!block) {
+        return -1;
+    }
+    batch->capacity = capacity;
+    batch->temperature = (double*)block;
+    block += capacity * sizeof(double);
+    batch->topic = (iot_ref_t*)block;
+    block += capacity * sizeof(iot_ref_t);
+    batch->payload = (iot_ref_t*)block;
+    block += capacity * sizeof(iot_ref_t);
+    for (int f = 0; f < IOT_FIELD_COUNT; ++f) {
+        batch->text[f] = (iot_ref_t*)block;
+        block += capacity * sizeof(iot_ref_t);
+    }
+    batch->kind = (uint8_t*)block;
+    block += capacity;
+    batch->fields = (uint8_t*)block;
+    return 0;
+}
+
+void iot_batch_free(iot_batch_t* batch)
+{
+    // temperature is the start of the block
+    free(batch->temperature);
+    memset(batch, 0, sizeof(*batch));
+}
+
+static int field_of(const json_span_t* key)
+{
+    switch (key->len) {
+    case 5:
+        return memcmp(key->ptr, "value", 5) == 0 ? IOT_FIELD_VALUE : -1;
+    case 6:
+        if (memcmp(key->ptr, "status", 6) == 0) {
+            return IOT_FIELD_STATUS;
+        }
+        return memcmp(key->ptr, "action", 6) == 0 ? IOT_FIELD_ACTION : -1;
+    case 9:
+        return memcmp(key->ptr, "device_id", 9) == 0 ? IOT_FIELD_DEVICE_ID : -1;
+    case 11:
+        return memcmp(key->ptr, "temperature", 11) == 0 ? IOT_FIELD_TEMPERATURE : -1;
+    default:
+        return -1;
+    }
+}
+
+static iot_ref_t make_ref(const char* base, const char* p, size_t len)
+{
+    iot_ref_t ref = { (uint32_t)(p - base), (uint32_t)len };
+    return ref;
+}
+
+static void extract_fields(iot_batch_t* b, size_t i, const char* base, iot_ref_t payload)
+{
+    json_scanner_t scanner;
+    json_member_t m;
+    json_scan_init(&scanner, base + payload.off, payload.len);
+    while (json_scan_next(&scanner, &m) == 1) {
+        int f = field_of(&m.key);
+        if (f < 0) {
+            continue;
+        }
+        b->fields[i] |= (uint8_t)(1u << f);
+        b->text[f][i] = make_ref(base, m.value.ptr, m.value.len);
+        if (f == IOT_FIELD_TEMPERATURE && m.type == JSON_SCAN_NUMBER) {
+            json_number_status_t status;
+            const char* last = m.value.ptr + m.value.len;
+            double t;
+            if (json_parse_double(m.value.ptr, last, &t, &status) == last) {
+                b->temperature[i] = t;
+            }
+        }
+    }
+}
+
+// Splits a message without copying. The split is stricter than the
+// interactive parser's (dispatch_message / parse_http_request): the method
+// must be exactly "GET " or "POST " including the space, where the
+// interactive parser takes any "GET..."/"POST..." word as the method, and an
+// HTTP line without a second space still yields its path (with an empty
+// body), where parse_http_request leaves path and body empty. iot_diff
+// reports both cases as accepted by one side only.
+static int parse_one(iot_batch_t* b, size_t i, const iot_span_t* msg)
+{
+    const char* p = msg->ptr;
+    const char* end = p + msg->len;
+    static const iot_ref_t empty = { 0, 0 };
+
+    b->kind[i] = IOT_MSG_INVALID;
+    b->fields[i] = 0;
+    b->topic[i] = empty;
+    b->payload[i] = empty;
+    b->temperature[i] = NAN;
+    for (int f = 0; f < IOT_FIELD_COUNT; ++f) {
+        b->text[f][i] = empty;
+    }
+
+    if (msg->len >= 4 && memcmp(p, "mqtt", 4) == 0) {
+        const char* space = memchr(p + 4, ' ', msg->len - 4);
+        if (!space) {
+            return 0;
+        }
+        b->kind[i] = IOT_MSG_MQTT;
+        b->topic[i] = make_ref(p, p + 4, (size_t)(space - (p + 4)));
+        b->payload[i] = make_ref(p, space + 1, (size_t)(end - (space + 1)));
+    } else if ((msg->len >= 4 && memcmp(p, "GET ", 4) == 0) ||
+               (msg->len >= 5 && memcmp(p, "POST ", 5) == 0)) {
+        const char* path = p + (*p == 'G' ? 4 : 5);
+        const char* space = memchr(path, ' ', (size_t)(end - path));
+        b->kind[i] = *p == 'G' ? IOT_MSG_HTTP_GET : IOT_MSG_HTTP_POST;
+        if (!space) {
+            b->topic[i] = make_ref(p, path, (size_t)(end - path));
+            return 1;
+        }
+        b->topic[i] = make_ref(p, path, (size_t)(space - path));
+        b->payload[i] = make_ref(p, space + 1, (size_t)(end - (space + 1)));
+    } else {
+        return 0;
+    }
+    extract_fields(b, i, p, b->payload[i]);
+    return 1;
+}
+
+static long parse_range(iot_batch_t* batch, const iot_span_t* msgs, size_t begin, size_t end)
+{
+    long recognized = 0;
+    for (size_t i = begin; i < end; ++i) {
+        recognized += parse_one(batch, i, &msgs[i]);
+    }
+    return recognized;
+}
+
+long iot_batch_parse(iot_batch_t* batch, const iot_span_t* msgs, size_t count)
+{
+    if (count > batch->capacity) {
+        return -1;
+    }
+    batch->count = count;
+    return parse_range(batch, msgs, 0, count);
+}
+
+#ifdef IOT_BATCH_THREADS
+
+typedef struct {
+    iot_batch_pool_t* pool;
+    unsigned slice;
+} worker_arg_t;
+
+struct iot_batch_pool {
+    pthread_t* threads;
+    worker_arg_t* args;
+    unsigned workers;           // threads besides the caller
+    pthread_mutex_t lock;
+    pthread_cond_t start;
+    pthread_cond_t done;
+    unsigned generation;
+    unsigned pending;
+    int shutdown;
+    // Current job
+    iot_batch_t* batch;
+    const iot_span_t* msgs;
+    size_t count;
+    long recognized;
+};
+
+static void slice_bounds(size_t count, unsigned slices, unsigned slice, size_t* begin, size_t* end)
+{
+    *begin = count * slice / slices;
+    *end = count * (slice + 1) / slices;
+}
+
+static void* worker_main(void* arg)
+{
+    worker_arg_t* w = arg;
+    iot_batch_pool_t* pool = w->pool;
+    unsigned seen = 0;
+    for (;;) {
+        pthread_mutex_lock(&pool->lock);
+        while (pool->generation == seen && !pool->shutdown) {
+            pthread_cond_wait(&pool->start, &pool->lock);
+        }
+        if (pool->shutdown) {
+            pthread_mutex_unlock(&pool->lock);
+            return NULL;
+        }
+        seen = pool->generation;
+        iot_batch_t* batch = pool->batch;
+        const iot_span_t* msgs = pool->msgs;
+        size_t count = pool->count;
+        pthread_mutex_unlock(&pool->lock);
+
+        size_t begin, end;
+        slice_bounds(count, pool->workers + 1, w->slice, &begin, &end);
+        long n = parse_range(batch, msgs, begin, end);
+
+        pthread_mutex_lock(&pool->lock);
+        pool->recognized += n;
+        if (--pool->pending == 0) {
+            pthread_cond_signal(&pool->done);
+        }
+        pthread_mutex_unlock(&pool->lock);
+    }
+}
+
+iot_batch_pool_t* iot_batch_pool_create(unsigned threads)
+{
+    if (threads < 2) {
+        return NULL;
+    }
+    iot_batch_pool_t* pool = calloc(1, sizeof(*pool));
+    if (!pool) {
+        return NULL;
+    }
+    pool->workers = threads - 1;
+    pool->threads = calloc(pool->workers, sizeof(*pool->threads));
+    pool->args = calloc(pool->workers, sizeof(*pool->args));
+    if (!pool->threads || !pool->args) {
+        free(pool->threads);
+        free(pool->args);
+        free(pool);
+        return NULL;
+    }
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->start, NULL);
+    pthread_cond_init(&pool->done, NULL);
+    for (unsigned i = 0; i < pool->workers; ++i) {
+        pool->args[i].pool = pool;
+        pool->args[i].slice = i + 1;
+        if (pthread_create(&pool->threads[i], NULL, worker_main, &pool->args[i]) != 0) {
+            pool->workers = i;
+            iot_batch_pool_destroy(pool);
+            return NULL;
+        }
+    }
+    return pool;
+}
+
+void iot_batch_pool_destroy(iot_batch_pool_t* pool)
+{
+    if (!pool) {
+        return;
+    }
+    pthread_mutex_lock(&pool->lock);
+    pool->shutdown = 1;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->lock);
+    for (unsigned i = 0; i < pool->workers; ++i) {
+        pthread_join(pool->threads[i], NULL);
+    }
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->start);
+    pthread_cond_destroy(&pool->done);
+    free(pool->threads);
+    free(pool->args);
+    free(pool);
+}
+
+long iot_batch_parse_parallel(iot_batch_pool_t* pool, iot_batch_t* batch,
+                              const iot_span_t* msgs, size_t count)
+{
+    if (!pool) {
+        return iot_batch_parse(batch, msgs, count);
+    }
+    if (count > batch->capacity) {
+        return -1;
+    }
+    batch->count = count;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->batch = batch;
+    pool->msgs = msgs;
+    pool->count = count;
+    pool->recognized = 0;
+    pool->pending = pool->workers;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->lock);
+
+    size_t begin, end;
+    slice_bounds(count, pool->workers + 1, 0, &begin, &end);
+    long recognized = parse_range(batch, msgs, begin, end);
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->pending != 0) {
+        pthread_cond_wait(&pool->done, &pool->lock);
+    }
+    recognized += pool->recognized;
+    pthread_mutex_unlock(&pool->lock);
+    return recognized;
+}
+
+#else // !IOT_BATCH_THREADS
+
+iot_batch_pool_t* iot_batch_pool_create(unsigned threads)
+{
+    (void)threads;
+    return NULL;
+}
+
+void iot_batch_pool_destroy(iot_batch_pool_t* pool)
+{
+    (void)pool;
+}
+
+long iot_batch_parse_parallel(iot_batch_pool_t* pool, iot_batch_t* batch,
+                              const iot_span_t* msgs, size_t count)
+{
+    (void)pool;
+    return iot_batch_parse(batch, msgs, count);
+}
+
+#endif // IOT_BATCH_THREADS
@@ -0,0 +1,83 @@
+#ifndef IOT_BATCH_H
+#define IOT_BATCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Batch parsing of buffered IoT messages (e.g. a replay log after a
+// reconnect). Messages are passed as spans and parsed without copying into a
+// struct-of-arrays result: entry i of every array describes message i, and
+// each array is contiguous so later passes that touch a single column (all
+// temperatures, all topics, ...) stream through memory.
+//
+// Text results are stored as (offset, length) pairs relative to the start of
+// the message they came from, so they stay valid for as long as the input
+// buffer does.
+
+typedef struct {
+    const char* ptr;
+    size_t len;         // messages must be shorter than 4 GiB
+} iot_span_t;
+
+typedef enum {
+    IOT_MSG_INVALID = 0,
+    IOT_MSG_MQTT,
+    IOT_MSG_HTTP_GET,
+    IOT_MSG_HTTP_POST,
+} iot_msg_kind_t;
+
+// Fields extracted from the JSON payload, as used by the analysis functions
+typedef enum {
+    IOT_FIELD_DEVICE_ID,
+    IOT_FIELD_TEMPERATURE,
+    IOT_FIELD_STATUS,
+    IOT_FIELD_ACTION,
+    IOT_FIELD_VALUE,
+    IOT_FIELD_COUNT,
+} iot_field_t;
+
+typedef struct {
+    uint32_t off;
+    uint32_t len;
+} iot_ref_t;
+
+typedef struct {
+    size_t count;
+    size_t capacity;
+    uint8_t* kind;          // iot_msg_kind_t
+    uint8_t* fields;        // bit (1 << iot_field_t) set when present
+    iot_ref_t* topic;       // MQTT topic or HTTP path
+    iot_ref_t* payload;     // JSON body
+    double* temperature;    // NaN unless the temperature is a JSON number
+    iot_ref_t* text[IOT_FIELD_COUNT];   // raw value of each field (strings without quotes)
+} iot_batch_t;
+
+// Allocates all columns for up to capacity messages in one block.
+// Returns 0 on success, -1 if the block size overflows or allocation fails.
+int iot_batch_init(iot_batch_t* batch, size_t capacity);
+void iot_batch_free(iot_batch_t* batch);
+
+// Parses msgs[0..count) on the calling thread. Returns the number of messages
+// that were recognized, or -1 if count exceeds the batch capacity.
+long iot_batch_parse(iot_batch_t* batch, const iot_span_t* msgs, size_t count);
+
+// Optional worker pool (Linux host, IOT_BATCH_THREADS builds). The batch is
+// split into one contiguous slice per thread; the calling thread takes a
+// slice too. Without thread support create returns NULL and
+// iot_batch_parse_parallel() falls back to iot_batch_parse().
+typedef struct iot_batch_pool iot_batch_pool_t;
+
+iot_batch_pool_t* iot_batch_pool_create(unsigned threads);
+void iot_batch_pool_destroy(iot_batch_pool_t* pool);
+long iot_batch_parse_parallel(iot_batch_pool_t* pool, iot_batch_t* batch,
+                              const iot_span_t* msgs, size_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IOT_BATCH_H
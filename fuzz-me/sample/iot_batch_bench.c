@@ -0,0 +1,116 @@
+// Batch parsing benchmark: a 100k-message backlog built from the sample
+// inputs, parsed serially and through the worker pool at increasing thread
+// counts.
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "iot_batch.h"
+
+#define NUM_MESSAGES 100000
+#define MAX_MESSAGE 128
+#define ROUNDS 10
+
+static char buffer[NUM_MESSAGES * MAX_MESSAGE];
+static iot_span_t msgs[NUM_MESSAGES];
+
+static uint32_t rng_state = 12345;
+
+static uint32_t rng(void)
+{
+    rng_state = rng_state * 1103515245u + 12345u;
+    return rng_state >> 8;
+}
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Variations of the messages in radamsa/sample_inputs.txt
+static int make_message(char* out)
+{
+    unsigned a = rng() % 100, b = rng() % 40, c = rng() % 10;
+    switch (rng() % 6) {
+    case 0:
+        return snprintf(out, MAX_MESSAGE, "mqtt/home/temperature {\"device_id\":\"sensor%02u\","
+                        "\"temperature\":%u.%u,\"status\":\"active\"}", a, b, c);
+    case 1:
+        return snprintf(out, MAX_MESSAGE, "mqtt/device/led {\"action\":\"toggle\","
+                        "\"brightness\":%u,\"color\":\"red\",\"seq\":%u}", a, b);
+    case 2:
+        return snprintf(out, MAX_MESSAGE, "mqtt/sensors/humidity {\"device_id\":\"esp32_%02u\","
+                        "\"humidity\":%u,\"location\":\"kitchen%u\"}", a, b, c);
+    case 3:
+        return snprintf(out, MAX_MESSAGE, "GET /api/sensors {\"action\":\"read\","
+                        "\"sensor\":\"temperature\",\"id\":%u}", a);
+    case 4:
+        return snprintf(out, MAX_MESSAGE, "POST /device/control {\"action\":\"set\","
+                        "\"value\":\"%u\",\"device\":\"fan%u\"}", a, c);
+    default:
+        return snprintf(out, MAX_MESSAGE, "POST /api/data {\"temperature\":%u.%u,"
+                        "\"humidity\":60,\"timestamp\":%u}", b, c, a);
+    }
+}
+
+static size_t build_backlog(void)
+{
+    char* p = buffer;
+    for (size_t i = 0; i < NUM_MESSAGES; ++i) {
+        int len = make_message(p);
+        msgs[i].ptr = p;
+        msgs[i].len = (size_t)len;
+        p += len;
+    }
+    return (size_t)(p - buffer);
+}
+
+static double run(iot_batch_pool_t* pool, iot_batch_t* batch, long* recognized)
+{
+    double t0 = now_s();
+    for (int r = 0; r < ROUNDS; ++r) {
+        *recognized = iot_batch_parse_parallel(pool, batch, msgs, NUM_MESSAGES);
+    }
+    return (now_s() - t0) / ROUNDS;
+}
+
+int main(int argc, char** argv)
+{
+    unsigned max_threads = argc > 1 ? (unsigned)atoi(argv[1]) : 4;
+    size_t bytes = build_backlog();
+    iot_batch_t batch;
+    if (iot_batch_init(&batch, NUM_MESSAGES) != 0) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    long recognized = 0;
+    double serial = run(NULL, &batch, &recognized);
+    size_t temps = 0;
+    for (size_t i = 0; i < batch.count; ++i) {
+        temps += batch.temperature[i] == batch.temperature[i];
+    }
+    printf("%d messages, %zu KiB, %ld recognized, %zu temperatures\n",
+           NUM_MESSAGES, bytes / 1024, recognized, temps);
+    printf("serial      %8.2f ms  %6.2f Mmsg/s  %7.1f MiB/s\n", serial * 1e3,
+           NUM_MESSAGES / serial / 1e6, bytes / serial / (1024 * 1024));
+
+    for (unsigned threads = 2; threads <= max_threads; threads *= 2) {
+        iot_batch_pool_t* pool = iot_batch_pool_create(threads);
+        if (!pool) {
+            printf("worker pool not available\n");
+            break;
+        }
+        double t = run(pool, &batch, &recognized);
+        printf("%2u threads  %8.2f ms  %6.2f Mmsg/s  %7.1f MiB/s  (%.2fx)\n", threads, t * 1e3,
+               NUM_MESSAGES / t / 1e6, bytes / t / (1024 * 1024), serial / t);
+        iot_batch_pool_destroy(pool);
+    }
+    iot_batch_free(&batch);
+    return 0;
+}
@@ -0,0 +1,357 @@
+#include "iot_diff.h"
+#include "json_number.h"
+
+#include <ctype.h>
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    const char* key;
+    iot_field_t field;
+} analysis_key_t;
+
+// The fields print_mqtt_analysis() and print_http_analysis() extract
+static const analysis_key_t mqtt_keys[] = {
+    { "device_id", IOT_FIELD_DEVICE_ID },
+    { "temperature", IOT_FIELD_TEMPERATURE },
+    { "status", IOT_FIELD_STATUS },
+};
+static const analysis_key_t http_keys[] = {
+    { "action", IOT_FIELD_ACTION },
+    { "value", IOT_FIELD_VALUE },
+};
+
+static const char* const status_names[] = {
+    "out-of-domain", "rejected", "legacy-only", "hardened-only", "match", "diverged",
+};
+
+const char* iot_diff_status_name(iot_diff_status_t status)
+{
+    return status < IOT_DIFF_STATUS_COUNT ? status_names[status] : "?";
+}
+
+static size_t analysis_keys(int kind, const analysis_key_t** keys)
+{
+    if (kind == IOT_MSG_MQTT) {
+        *keys = mqtt_keys;
+        return sizeof(mqtt_keys) / sizeof(mqtt_keys[0]);
+    }
+    *keys = http_keys;
+    return sizeof(http_keys) / sizeof(http_keys[0]);
+}
+
+static int legacy_kind(const char* line, size_t len)
+{
+    if (len >= 4 && memcmp(line, "mqtt", 4) == 0) {
+        return IOT_MSG_MQTT;
+    }
+    if (len >= 3 && memcmp(line, "GET", 3) == 0) {
+        return IOT_MSG_HTTP_GET;
+    }
+    if (len >= 4 && memcmp(line, "POST", 4) == 0) {
+        return IOT_MSG_HTTP_POST;
+    }
+    return IOT_MSG_INVALID;
+}
+
+// The "key": pattern extract_json_value() searches for
+static size_t make_needle(char* out, size_t size, const char* key)
+{
+    return (size_t)snprintf(out, size, "\"%s\":", key);
+}
+
+// strstr() over a span; *count is the number of matches, capped at 2
+static const char* find_needle(const char* p, const char* end, const char* needle, size_t n,
+                               int* count)
+{
+    const char* first = NULL;
+    *count = 0;
+    for (; (size_t)(end - p) >= n && *count < 2; ++p) {
+        if (*p == needle[0] && memcmp(p, needle, n) == 0) {
+            if (!first) {
+                first = p;
+            }
+            ++*count;
+        }
+    }
+    return first;
+}
+
+static const char* skip_space(const char* p, const char* end)
+{
+    while (p < end && isspace((unsigned char)*p)) {
+        p++;
+    }
+    return p;
+}
+
+// A quoted value that extract_json_value() would copy must fit its buffer
+static int values_fit(const char* p, const char* end, int kind)
+{
+    const analysis_key_t* keys;
+    size_t n = analysis_keys(kind, &keys);
+    for (size_t j = 0; j < n; ++j) {
+        char needle[MAX_KEY_SIZE + 4];
+        size_t len = make_needle(needle, sizeof(needle), keys[j].key);
+        int count;
+        const char* at = find_needle(p, end, needle, len, &count);
+        if (!at) {
+            continue;
+        }
+        const char* v = skip_space(at + len, end);
+        if (v < end && *v == '"') {
+            const char* q = memchr(v + 1, '"', (size_t)(end - (v + 1)));
+            if (q && q - (v + 1) >= MAX_VALUE_SIZE) {
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+int iot_diff_legacy_safe(const char* line, size_t len)
+{
+    const char* end = line + len;
+    if (memchr(line, '\0', len) || memchr(line, '\n', len)) {
+        return 0;
+    }
+    int kind = legacy_kind(line, len);
+    if (kind == IOT_MSG_MQTT) {
+        const char* space = memchr(line + 4, ' ', len - 4);
+        if (!space) {
+            return 1;
+        }
+        if (space - (line + 4) >= MAX_TOPIC_SIZE || end - (space + 1) >= MAX_BUFFER_SIZE) {
+            return 0;
+        }
+        return values_fit(space + 1, end, kind);
+    }
+    if (kind != IOT_MSG_INVALID) {
+        const char* method_end = memchr(line, ' ', len);
+        if (!method_end) {
+            return 1;
+        }
+        if (method_end - line >= (ptrdiff_t)sizeof(((http_message_t*)0)->method)) {
+            return 0;
+        }
+        const char* path_end = memchr(method_end + 1, ' ', (size_t)(end - (method_end + 1)));
+        if (!path_end) {
+            return 1;
+        }
+        if (path_end - (method_end + 1) >= MAX_PATH_SIZE || end - (path_end + 1) >= MAX_BUFFER_SIZE) {
+            return 0;
+        }
+        return values_fit(path_end + 1, end, kind);
+    }
+    return 1;
+}
+
+void iot_diff_parse_legacy(const char* line, iot_diff_legacy_t* out)
+{
+    const char* payload;
+    memset(out, 0, sizeof(*out));
+    out->kind = legacy_kind(line, strlen(line));
+    if (out->kind == IOT_MSG_MQTT) {
+        parse_mqtt_topic(line, &out->mqtt);
+        payload = out->mqtt.payload;
+    } else if (out->kind != IOT_MSG_INVALID) {
+        parse_http_request(line, &out->http);
+        payload = out->http.body;
+    } else {
+        return;
+    }
+
+    const analysis_key_t* keys;
+    size_t n = analysis_keys(out->kind, &keys);
+    for (size_t j = 0; j < n; ++j) {
+        out->found[j] = extract_json_value(payload, keys[j].key, out->values[j]);
+    }
+}
+
+static int legacy_accepted(const iot_span_t* msg, int kind)
+{
+    const char* end = msg->ptr + msg->len;
+    if (kind == IOT_MSG_MQTT) {
+        return memchr(msg->ptr + 4, ' ', msg->len - 4) != NULL;
+    }
+    if (kind == IOT_MSG_INVALID) {
+        return 0;
+    }
+    const char* method_end = memchr(msg->ptr, ' ', msg->len);
+    return method_end && memchr(method_end + 1, ' ', (size_t)(end - (method_end + 1)));
+}
+
+static void diverged(iot_diff_result_t* out, const char* what, const char* legacy,
+                     const char* hardened, size_t hardened_len)
+{
+    if (out->status == IOT_DIFF_DIVERGED) {
+        return;
+    }
+    out->status = IOT_DIFF_DIVERGED;
+    snprintf(out->detail, sizeof(out->detail), "%s: legacy \"%.40s\" hardened \"%.*s\"", what,
+             legacy, (int)(hardened_len > 40 ? 40 : hardened_len), hardened);
+}
+
+static void compare_text(iot_diff_result_t* out, const char* what, const char* legacy,
+                         const char* hardened, size_t len)
+{
+    out->compared++;
+    if (strlen(legacy) != len || memcmp(legacy, hardened, len) != 0) {
+        diverged(out, what, legacy, hardened, len);
+    }
+}
+
+// Compares the temperature column bit for bit with strtod() on the same
+// token, where both are correctly rounded (at most 19 significant digits)
+static void compare_double(iot_diff_result_t* out, const char* what, double hardened,
+                           const char* text, size_t text_len)
+{
+    char token[MAX_VALUE_SIZE];
+    double value;
+    json_number_status_t status;
+    if (text_len >= sizeof(token) ||
+        json_parse_double(text, text + text_len, &value, &status) != text + text_len ||
+        (status != JSON_NUMBER_OK && status != JSON_NUMBER_OVERFLOW)) {
+        out->skipped++;
+        return;
+    }
+    memcpy(token, text, text_len);
+    token[text_len] = '\0';
+    char* end;
+    double expected = strtod(token, &end);
+    out->compared++;
+    if (end != token + text_len || memcmp(&hardened, &expected, sizeof(double)) != 0) {
+        char legacy[32], hardened_text[32];
+        snprintf(legacy, sizeof(legacy), "%.17g", expected);
+        int n = snprintf(hardened_text, sizeof(hardened_text), "%.17g", hardened);
+        char label[MAX_KEY_SIZE + 16];
+        snprintf(label, sizeof(label), "%s (strtod)", what);
+        diverged(out, label, legacy, hardened_text, (size_t)n);
+    }
+}
+
+// Compares one analysis field, or counts it as skipped when the legacy
+// extraction is not well defined for it (see iot_diff.h). number is the
+// hardened parser's converted value for fields that have one, else NULL.
+static void compare_field(iot_diff_result_t* out, const analysis_key_t* key, int found,
+                          const char* value, const char* payload, size_t payload_len,
+                          const char* text, size_t text_len, int present, const double* number)
+{
+    char needle[MAX_KEY_SIZE + 4];
+    size_t n = make_needle(needle, sizeof(needle), key->key);
+    const char* end = payload + payload_len;
+    int count;
+    const char* at = find_needle(payload, end, needle, n, &count);
+
+    if (!present) {
+        if (count != 0) {
+            out->skipped++;
+            return;
+        }
+        out->compared++;
+        if (found) {
+            diverged(out, key->key, value, "(missing)", 9);
+        }
+        return;
+    }
+
+    int quoted = text > payload && text[-1] == '"';
+    if (count != 1 || skip_space(at + n, end) != (quoted ? text - 1 : text)) {
+        out->skipped++;
+        return;
+    }
+
+    char expected[MAX_VALUE_SIZE];
+    if (quoted) {
+        if (text_len == 0 || text_len >= MAX_VALUE_SIZE || memchr(text, '\\', text_len)) {
+            out->skipped++;
+            return;
+        }
+        memcpy(expected, text, text_len);
+        expected[text_len] = '\0';
+    } else {
+        if (number) {
+            compare_double(out, key->key, *number, text, text_len);
+        }
+        // The legacy strtol() keeps the integer part of a fraction or
+        // exponent form, which is what json_parse_int64() stops after
+        int64_t integer;
+        json_number_status_t status;
+        const char* last = text + text_len;
+        const char* stop = json_parse_int64(text, last, &integer, &status);
+        if (stop == text || (stop != last && *stop != '.' && *stop != 'e' && *stop != 'E') ||
+            status != JSON_NUMBER_OK) {
+            out->skipped++;
+            return;
+        }
+#if LONG_MAX < INT64_MAX
+        if (integer < LONG_MIN || integer > LONG_MAX) {
+            out->skipped++;
+            return;
+        }
+#endif
+        // Integers are compared by value, so -0 and 0 are the same
+        snprintf(expected, sizeof(expected), "%ld", (long)integer);
+    }
+    out->compared++;
+    if (found <= 0 || strcmp(value, expected) != 0) {
+        diverged(out, key->key, found > 0 ? value : "(missing)", text, text_len);
+    }
+}
+
+iot_diff_status_t iot_diff_compare(const iot_span_t* msg, const iot_diff_legacy_t* legacy,
+                                   const iot_batch_t* batch, size_t i, iot_diff_result_t* out)
+{
+    memset(out, 0, sizeof(*out));
+    int hardened = batch->kind[i] != IOT_MSG_INVALID;
+    int accepted = legacy_accepted(msg, legacy->kind);
+    out->kind = hardened ? batch->kind[i] : legacy->kind;
+    if (!hardened || !accepted) {
+        out->status = hardened ? IOT_DIFF_HARDENED_ONLY
+                    : accepted ? IOT_DIFF_LEGACY_ONLY : IOT_DIFF_REJECTED;
+        return out->status;
+    }
+
+    out->status = IOT_DIFF_MATCH;
+    int kind = batch->kind[i];
+    iot_ref_t topic = batch->topic[i];
+    iot_ref_t payload = batch->payload[i];
+    const char* p = msg->ptr + payload.off;
+    if (kind == IOT_MSG_MQTT) {
+        compare_text(out, "topic", legacy->mqtt.topic, msg->ptr + topic.off, topic.len);
+        compare_text(out, "payload", legacy->mqtt.payload, p, payload.len);
+    } else {
+        const char* method = kind == IOT_MSG_HTTP_GET ? "GET" : "POST";
+        compare_text(out, "method", legacy->http.method, method, strlen(method));
+        compare_text(out, "path", legacy->http.path, msg->ptr + topic.off, topic.len);
+        compare_text(out, "body", legacy->http.body, p, payload.len);
+    }
+    const analysis_key_t* keys;
+    size_t n = analysis_keys(kind, &keys);
+    for (size_t j = 0; j < n; ++j) {
+        iot_field_t f = keys[j].field;
+        iot_ref_t text = batch->text[f][i];
+        const double* number = f == IOT_FIELD_TEMPERATURE ? &batch->temperature[i] : NULL;
+        compare_field(out, &keys[j], legacy->found[j], legacy->values[j], p, payload.len,
+                      msg->ptr + text.off, text.len, (batch->fields[i] >> f) & 1, number);
+    }
+    return out->status;
+}
+
+iot_diff_status_t iot_diff_check(const char* line, size_t len, iot_batch_t* scratch,
+                                 iot_diff_result_t* out)
+{
+    if (!iot_diff_legacy_safe(line, len)) {
+        memset(out, 0, sizeof(*out));
+        out->status = IOT_DIFF_OUT_OF_DOMAIN;
+        return out->status;
+    }
+    iot_diff_legacy_t legacy;
+    iot_span_t msg = { line, len };
+    iot_diff_parse_legacy(line, &legacy);
+    iot_batch_parse(scratch, &msg, 1);
+    return iot_diff_compare(&msg, &legacy, scratch, 0, out);
+}
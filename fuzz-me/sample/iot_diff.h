@@ -0,0 +1,85 @@
+#ifndef IOT_DIFF_H
+#define IOT_DIFF_H
+
+#include <stddef.h>
+
+#include "iot_batch.h"
+#include "iot_parser.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Differential check of the legacy parser (iot_parser.c) against the
+// zero-copy parser in iot_batch.c on the same input line.
+//
+// Inputs the legacy parser cannot process without overflowing one of its
+// fixed buffers are reported as IOT_DIFF_OUT_OF_DOMAIN and never reach it.
+// When both parsers recognize the message, the topic (MQTT) or method and
+// path (HTTP), the payload/body and the JSON fields the analysis prints
+// (device_id, temperature and status for MQTT, action and value for HTTP)
+// are compared. A field is only compared where the legacy extraction is
+// well defined: its "key": pattern occurs once in the payload, at the
+// member the JSON scanner found, and the value is a non-empty string without
+// escapes or a number whose integer part fits a long. Numbers are compared
+// under the legacy strtol() rule, by their integer part, so "23.5" must come
+// out as "23". The temperature the batch parser converts is also compared
+// bit for bit with strtod() on the same token, up to 19 significant digits.
+// Everything else (nested or duplicate keys, escaped quotes, ...) is counted
+// as skipped.
+
+typedef enum {
+    IOT_DIFF_OUT_OF_DOMAIN = 0, // would overflow a legacy buffer, or not a single line
+    IOT_DIFF_REJECTED,          // neither parser recognized the message
+    IOT_DIFF_LEGACY_ONLY,       // e.g. "GETX /a b", or a legacy-only method
+    IOT_DIFF_HARDENED_ONLY,     // e.g. "GET /path" without a body
+    IOT_DIFF_MATCH,
+    IOT_DIFF_DIVERGED,
+    IOT_DIFF_STATUS_COUNT,
+} iot_diff_status_t;
+
+#define IOT_DIFF_MAX_FIELDS 3
+
+// Output of the legacy parse path, as main() and the print functions use it
+typedef struct {
+    int kind;                   // iot_msg_kind_t; GET/POST is taken from the method
+    int accepted;               // topic/path and payload/body were set
+    mqtt_message_t mqtt;
+    http_message_t http;
+    int found[IOT_DIFF_MAX_FIELDS];     // extract_json_value() result
+    char values[IOT_DIFF_MAX_FIELDS][MAX_VALUE_SIZE];
+} iot_diff_legacy_t;
+
+typedef struct {
+    iot_diff_status_t status;
+    int kind;                   // iot_msg_kind_t of the recognized message
+    unsigned compared;          // fields compared, including topic and payload
+    unsigned skipped;           // JSON fields outside the legacy domain
+    char detail[160];           // first difference for IOT_DIFF_DIVERGED
+} iot_diff_result_t;
+
+// Returns 1 if line[0..len) is a single line (no NUL or '\n') that the
+// legacy dispatch and extraction can process within their buffers.
+int iot_diff_legacy_safe(const char* line, size_t len);
+
+// Runs the legacy dispatch of main() on a NUL-terminated line that passed
+// iot_diff_legacy_safe(): parse_mqtt_topic() or parse_http_request(), then
+// extract_json_value() for each analysis field. This is the timed legacy path.
+void iot_diff_parse_legacy(const char* line, iot_diff_legacy_t* out);
+
+// Compares a legacy result with entry i of a batch parsed from msg.
+iot_diff_status_t iot_diff_compare(const iot_span_t* msg, const iot_diff_legacy_t* legacy,
+                                   const iot_batch_t* batch, size_t i, iot_diff_result_t* out);
+
+// Runs both parsers on line[0..len) (NUL-terminated at len) and compares
+// them. scratch must have a capacity of at least one message.
+iot_diff_status_t iot_diff_check(const char* line, size_t len, iot_batch_t* scratch,
+                                 iot_diff_result_t* out);
+
+const char* iot_diff_status_name(iot_diff_status_t status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IOT_DIFF_H
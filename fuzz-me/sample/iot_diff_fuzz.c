@@ -0,0 +1,426 @@
+// Differential fuzzer: mutates the sample inputs, runs every line through the
+// legacy parser and the zero-copy batch parser (iot_diff.h), reports each
+// divergence and prints the legacy/hardened speedup distribution over the
+// inputs both parsers accept. Exits with 1 if any divergence was found, so it
+// can gate the switch from the legacy parser.
+//
+//   iot_diff_fuzz [-n inputs] [-s seed] [-r reps] [-c timings.csv]
+//                 [-o divergence_dir] [seed_file]
+#define _POSIX_C_SOURCE 199309L
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "iot_diff.h"
+
+#ifndef IOT_SAMPLE_INPUTS
+#define IOT_SAMPLE_INPUTS "../radamsa/sample_inputs.txt"
+#endif
+
+#define MAX_LINE 384
+#define MAX_SEEDS 4096
+#define MAX_REPORTED 10
+#define TIMING_ROUNDS 3
+
+typedef struct {
+    char text[MAX_LINE + 1];
+    size_t len;
+} line_t;
+
+static line_t seeds[MAX_SEEDS];
+static size_t num_seeds;
+static size_t num_initial;
+
+static uint32_t rng_state = 12345;
+
+static uint32_t rng(void)
+{
+    rng_state = rng_state * 1103515245u + 12345u;
+    return rng_state >> 8;
+}
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static int load_seeds(const char* path)
+{
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        perror(path);
+        return -1;
+    }
+    char buf[1024];
+    while (num_seeds < MAX_SEEDS && fgets(buf, sizeof(buf), f)) {
+        size_t len = strcspn(buf, "\n");
+        if (len == 0 || len > MAX_LINE) {
+            continue;
+        }
+        memcpy(seeds[num_seeds].text, buf, len);
+        seeds[num_seeds].text[len] = '\0';
+        seeds[num_seeds++].len = len;
+    }
+    fclose(f);
+    num_initial = num_seeds;
+    return num_seeds ? 0 : -1;
+}
+
+// Mutation helpers; all keep the line NUL-terminated and within MAX_LINE
+static void replace(line_t* l, size_t at, size_t n, const char* with, size_t with_len)
+{
+    if (at > l->len) {
+        at = l->len;
+    }
+    if (n > l->len - at) {
+        n = l->len - at;
+    }
+    if (l->len - n + with_len > MAX_LINE) {
+        return;
+    }
+    memmove(l->text + at + with_len, l->text + at + n, l->len - at - n + 1);
+    memcpy(l->text + at, with, with_len);
+    l->len = l->len - n + with_len;
+}
+
+static size_t pick(const line_t* l)
+{
+    return l->len ? rng() % (l->len + 1) : 0;
+}
+
+// Position just past a random ':' of the payload, or 0
+static size_t random_colon(const line_t* l)
+{
+    size_t found = 0, seen = 0;
+    for (size_t i = 0; i < l->len; ++i) {
+        if (l->text[i] == ':' && rng() % ++seen == 0) {
+            found = i + 1;
+        }
+    }
+    return found;
+}
+
+// Length of the JSON value starting at l->text[at], roughly
+static size_t value_len(const line_t* l, size_t at)
+{
+    size_t i = at;
+    if (i < l->len && l->text[i] == '"') {
+        for (++i; i < l->len && l->text[i] != '"'; ++i) {
+        }
+        return i < l->len ? i + 1 - at : i - at;
+    }
+    while (i < l->len && l->text[i] != ',' && l->text[i] != '}') {
+        i++;
+    }
+    return i - at;
+}
+
+static void mutate(line_t* l)
+{
+    static const char* const values[] = {
+        "0", "-0", "42", "-17", "23.5", "1e3", "-0.25", "2.2250738585072011e-308", "9223372036854775807", "9223372036854775808",
+        "00012", "+5", "-", "true", "false", "null", "\"\"", "\"on\"", "\"a\\\"b\"",
+        "\"sensor01\"", "{\"status\":\"nested\"}", "[1,2]", " \"spaced\"", "\t7",
+    };
+    static const char* const members[] = {
+        "\"device_id\":\"dup\"", "\"status\":\"idle\"", "\"temperature\":-3",
+        "\"action\":\"get\"", "\"value\":12", "\"status\" :\"ws\"", "\"x\":{\"value\":1}",
+    };
+    static const char* const prefixes[] = { "mqtt", "GET ", "POST ", "GETX ", "POS", "mqt" };
+    static const char alphabet[] = "{}[]\":, \\-0123456789.eEtfn/+#a";
+    char buf[80];
+
+    switch (rng() % 10) {
+    case 0: case 1: {   // replace a value
+        size_t at = random_colon(l);
+        if (at) {
+            const char* v = values[rng() % (sizeof(values) / sizeof(values[0]))];
+            replace(l, at, value_len(l, at), v, strlen(v));
+        }
+        break;
+    }
+    case 2: {           // long string value
+        size_t at = random_colon(l);
+        size_t n = 1 + rng() % 70;
+        if (at && n + 2 < sizeof(buf)) {
+            buf[0] = '"';
+            for (size_t i = 1; i <= n; ++i) {
+                buf[i] = (char)('a' + rng() % 26);
+            }
+            buf[n + 1] = '"';
+            replace(l, at, value_len(l, at), buf, n + 2);
+        }
+        break;
+    }
+    case 3: {           // insert a member after '{' or ','
+        const char* m = members[rng() % (sizeof(members) / sizeof(members[0]))];
+        char* brace = strchr(l->text, '{');
+        if (brace) {
+            int n = snprintf(buf, sizeof(buf), "%s,", m);
+            replace(l, (size_t)(brace - l->text) + 1, 0, buf, (size_t)n);
+        }
+        break;
+    }
+    case 4: {           // whitespace around ':' and ','
+        static const char* const ws[] = { " ", "\t", "  ", "\r", "\v" };
+        const char* w = ws[rng() % 5];
+        size_t at = random_colon(l);
+        if (at) {
+            replace(l, at - (rng() & 1), 0, w, strlen(w));
+        }
+        break;
+    }
+    case 5: {           // message prefix
+        const char* p = prefixes[rng() % (sizeof(prefixes) / sizeof(prefixes[0]))];
+        size_t old = l->text[0] == 'm' ? 4 : l->text[0] == 'G' ? 4 : l->text[0] == 'P' ? 5 : 0;
+        replace(l, 0, old, p, strlen(p));
+        break;
+    }
+    case 6: {           // longer topic or path
+        size_t n = 1 + rng() % 40;
+        char* slash = strchr(l->text, '/');
+        if (slash && n < sizeof(buf)) {
+            for (size_t i = 0; i < n; ++i) {
+                buf[i] = (char)('a' + rng() % 26);
+            }
+            replace(l, (size_t)(slash - l->text) + 1, 0, buf, n);
+        }
+        break;
+    }
+    case 7:             // truncate
+        if (l->len) {
+            l->len = rng() % l->len;
+            l->text[l->len] = '\0';
+        }
+        break;
+    case 8: {           // delete a range
+        size_t at = pick(l);
+        replace(l, at, 1 + rng() % 4, "", 0);
+        break;
+    }
+    default: {          // insert a structural byte
+        char c = alphabet[rng() % (sizeof(alphabet) - 1)];
+        replace(l, pick(l), 0, &c, 1);
+        break;
+    }
+    }
+}
+
+static int compare_double(const void* a, const void* b)
+{
+    double x = *(const double*)a, y = *(const double*)b;
+    return x < y ? -1 : x > y;
+}
+
+static double percentile(const double* sorted, size_t n, double p)
+{
+    return sorted[(size_t)(p / 100.0 * (double)(n - 1) + 0.5)];
+}
+
+static void print_distribution(const char* name, double* speedup, size_t n)
+{
+    if (n == 0) {
+        return;
+    }
+    qsort(speedup, n, sizeof(*speedup), compare_double);
+    double log_sum = 0;
+    for (size_t i = 0; i < n; ++i) {
+        log_sum += log(speedup[i]);
+    }
+    printf("%-6s n=%-8zu geomean %5.2fx  min %5.2fx  p1 %5.2fx  p10 %5.2fx  p50 %5.2fx  "
+           "p90 %5.2fx  p99 %5.2fx  max %5.2fx\n", name, n, exp(log_sum / (double)n), speedup[0],
+           percentile(speedup, n, 1), percentile(speedup, n, 10), percentile(speedup, n, 50),
+           percentile(speedup, n, 90), percentile(speedup, n, 99), speedup[n - 1]);
+}
+
+// Speedup histogram in half-octave buckets from 1/4x to 64x
+static void print_histogram(const double* sorted, size_t n)
+{
+    enum { BUCKETS = 16 };
+    size_t counts[BUCKETS] = { 0 };
+    size_t peak = 1;
+    for (size_t i = 0; i < n; ++i) {
+        int b = (int)floor(2.0 * log2(sorted[i])) + 4;
+        b = b < 0 ? 0 : b >= BUCKETS ? BUCKETS - 1 : b;
+        if (++counts[b] > peak) {
+            peak = counts[b];
+        }
+    }
+    printf("\nspeedup (legacy ns / hardened ns)\n");
+    for (int b = 0; b < BUCKETS; ++b) {
+        if (!counts[b]) {
+            continue;
+        }
+        char bar[51];
+        size_t w = counts[b] * 50 / peak;
+        memset(bar, '#', w);
+        bar[w] = '\0';
+        printf("  %6.2fx - %6.2fx %8zu %s\n", pow(2.0, (b - 4) / 2.0), pow(2.0, (b - 3) / 2.0),
+               counts[b], bar);
+    }
+}
+
+static void save_divergence(const char* dir, size_t index, const line_t* l)
+{
+    char path[512];
+    snprintf(path, sizeof(path), "%s/diverge-%zu.txt", dir, index);
+    FILE* f = fopen(path, "w");
+    if (f) {
+        fprintf(f, "%s\n", l->text);
+        fclose(f);
+    }
+}
+
+static void usage(const char* argv0)
+{
+    fprintf(stderr, "usage: %s [-n inputs] [-s seed] [-r reps] [-c timings.csv] "
+            "[-o divergence_dir] [seed_file]\n", argv0);
+}
+
+int main(int argc, char** argv)
+{
+    size_t inputs = 200000;
+    unsigned reps = 8;
+    const char* csv_path = NULL;
+    const char* out_dir = NULL;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:s:r:c:o:h")) != -1) {
+        switch (opt) {
+        case 'n': inputs = strtoul(optarg, NULL, 10); break;
+        case 's': rng_state = (uint32_t)strtoul(optarg, NULL, 10); break;
+        case 'r': reps = (unsigned)strtoul(optarg, NULL, 10); break;
+        case 'c': csv_path = optarg; break;
+        case 'o': out_dir = optarg; break;
+        default: usage(argv[0]); return 2;
+        }
+    }
+    if (reps == 0) {
+        reps = 1;
+    }
+    if (load_seeds(optind < argc ? argv[optind] : IOT_SAMPLE_INPUTS) != 0) {
+        fprintf(stderr, "no seed inputs\n");
+        return 2;
+    }
+
+    FILE* csv = NULL;
+    if (csv_path) {
+        csv = fopen(csv_path, "w");
+        if (!csv) {
+            perror(csv_path);
+            return 2;
+        }
+        fprintf(csv, "kind,len,legacy_ns,hardened_ns,speedup\n");
+    }
+    double* speedup[2] = { malloc(inputs * sizeof(double)), malloc(inputs * sizeof(double)) };
+    iot_batch_t batch;
+    if (!speedup[0] || !speedup[1] || iot_batch_init(&batch, 1) != 0) {
+        fprintf(stderr, "out of memory\n");
+        return 2;
+    }
+
+    size_t counts[IOT_DIFF_STATUS_COUNT] = { 0 };
+    size_t timed[2] = { 0, 0 };
+    size_t compared = 0, skipped = 0;
+    double legacy_total = 0, hardened_total = 0;
+
+    for (size_t i = 0; i < inputs; ++i) {
+        line_t l = seeds[rng() % num_seeds];
+        for (unsigned m = 1 + rng() % 4; m; --m) {
+            mutate(&l);
+        }
+        iot_diff_result_t res;
+        iot_diff_status_t st = iot_diff_check(l.text, l.len, &batch, &res);
+        counts[st]++;
+        compared += res.compared;
+        skipped += res.skipped;
+
+        if (st == IOT_DIFF_DIVERGED) {
+            if (counts[st] <= MAX_REPORTED) {
+                printf("DIVERGED %s\n  input: %s\n", res.detail, l.text);
+            }
+            if (out_dir) {
+                save_divergence(out_dir, i, &l);
+            }
+            continue;
+        }
+        if (st != IOT_DIFF_MATCH) {
+            continue;
+        }
+
+        // Keep some accepted inputs as seeds for further mutation
+        if (rng() % 64 == 0) {
+            if (num_seeds < MAX_SEEDS) {
+                seeds[num_seeds++] = l;
+            } else if (num_initial < MAX_SEEDS) {
+                seeds[num_initial + rng() % (MAX_SEEDS - num_initial)] = l;
+            }
+        }
+
+        iot_diff_legacy_t legacy;
+        iot_span_t msg = { l.text, l.len };
+        // Best of a few rounds, so a preempted round does not end up in the tail
+        double legacy_ns = INFINITY, hardened_ns = INFINITY;
+        for (int round = 0; round < TIMING_ROUNDS; ++round) {
+            double t0 = now_ns();
+            for (unsigned r = 0; r < reps; ++r) {
+                iot_diff_parse_legacy(l.text, &legacy);
+            }
+            double t1 = now_ns();
+            for (unsigned r = 0; r < reps; ++r) {
+                iot_batch_parse(&batch, &msg, 1);
+            }
+            double t2 = now_ns();
+            legacy_ns = fmin(legacy_ns, (t1 - t0) / reps);
+            hardened_ns = fmin(hardened_ns, (t2 - t1) / reps);
+        }
+        int http = res.kind != IOT_MSG_MQTT;
+        speedup[http][timed[http]++] = legacy_ns / hardened_ns;
+        legacy_total += legacy_ns;
+        hardened_total += hardened_ns;
+        if (csv) {
+            fprintf(csv, "%s,%zu,%.1f,%.1f,%.3f\n", http ? "http" : "mqtt", l.len, legacy_ns,
+                    hardened_ns, legacy_ns / hardened_ns);
+        }
+    }
+
+    printf("%zu inputs:", inputs);
+    for (int s = 0; s < IOT_DIFF_STATUS_COUNT; ++s) {
+        printf(" %s %zu%s", iot_diff_status_name((iot_diff_status_t)s), counts[s],
+               s + 1 < IOT_DIFF_STATUS_COUNT ? "," : "\n");
+    }
+    printf("%zu fields compared, %zu outside the legacy domain\n", compared, skipped);
+
+    size_t total = timed[0] + timed[1];
+    if (total) {
+        printf("\nmean per message: legacy %.1f ns, hardened %.1f ns\n",
+               legacy_total / (double)total, hardened_total / (double)total);
+        print_distribution("mqtt", speedup[0], timed[0]);
+        print_distribution("http", speedup[1], timed[1]);
+        double* all = malloc(total * sizeof(double));
+        if (all) {
+            memcpy(all, speedup[0], timed[0] * sizeof(double));
+            memcpy(all + timed[0], speedup[1], timed[1] * sizeof(double));
+            print_distribution("all", all, total);
+            print_histogram(all, total);
+            free(all);
+        }
+    }
+
+    if (csv) {
+        fclose(csv);
+    }
+    free(speedup[0]);
+    free(speedup[1]);
+    iot_batch_free(&batch);
+    if (counts[IOT_DIFF_DIVERGED]) {
+        printf("\n%zu divergences\n", counts[IOT_DIFF_DIVERGED]);
+        return 1;
+    }
+    return 0;
+}
@@ -26,6 +26,7 @@ int extract_json_value(const char* json, const char* key, char* value);
 void parse_http_request(const char* input, http_message_t* msg);
 void print_mqtt_analysis(const mqtt_message_t* msg);
 void print_http_analysis(const http_message_t* msg);
+void dispatch_message(const char* input);
 
 // Subtle bug #1: No bounds checking on strcpy
 void parse_mqtt_topic(const char* input, mqtt_message_t* msg) {
@@ -144,6 +145,30 @@ void print_http_analysis(const http_message_t* msg) {
     printf("\n");
 }
 
+// Parses one input line (without the newline) by its prefix and prints the
+// analysis. Shared by main() and the fuzz drivers (iot_replay.c), so every
+// engine and the crash triage replay exercise the same dispatch.
+void dispatch_message(const char* input) {
+    if (strncmp(input, "mqtt", 4) == 0) {
+        mqtt_message_t mqtt_msg = {0};
+        parse_mqtt_topic(input, &mqtt_msg);
+        print_mqtt_analysis(&mqtt_msg);
+    } else if (strncmp(input, "GET", 3) == 0 || strncmp(input, "POST", 4) == 0) {
+        http_message_t http_msg = {0};
+        parse_http_request(input, &http_msg);
+        print_http_analysis(&http_msg);
+    } else {
+        // Subtle bug #5: Potential null pointer dereference
+        char* unknown_format = NULL;
+        if (strlen(input) > 10) {
+            unknown_format = malloc(20);
+            strcpy(unknown_format, "Unknown format");
+        }
+        printf("Error: %s\n", unknown_format); // Potential NULL deref
+        free(unknown_format);
+    }
+}
+
 // Interactive main function - disabled when building for fuzz testing
 // Define FUZZTEST_BUILD or FUZZING_BUILD_MODE_UNSAFE_FOR_PRODUCTION to disable
 #if !defined(FUZZTEST_BUILD) && !defined(FUZZING_BUILD_MODE_UNSAFE_FOR_PRODUCTION)
@@ -160,25 +185,7 @@ int main(void) {
     if (fgets(input, sizeof(input), stdin)) {
         // Remove newline
         input[strcspn(input, "\n")] = '\0';
-        
-        if (strncmp(input, "mqtt", 4) == 0) {
-            mqtt_message_t mqtt_msg = {0};
-            parse_mqtt_topic(input, &mqtt_msg);
-            print_mqtt_analysis(&mqtt_msg);
-        } else if (strncmp(input, "GET", 3) == 0 || strncmp(input, "POST", 4) == 0) {
-            http_message_t http_msg = {0};
-            parse_http_request(input, &http_msg);
-            print_http_analysis(&http_msg);
-        } else {
-            // Subtle bug #5: Potential null pointer dereference
-            char* unknown_format = NULL;
-            if (strlen(input) > 10) {
-                unknown_format = malloc(20);
-                strcpy(unknown_format, "Unknown format");
-            }
-            printf("Error: %s\n", unknown_format); // Potential NULL deref
-            free(unknown_format);
-        }
+        dispatch_message(input);
     }
     
     return 0;
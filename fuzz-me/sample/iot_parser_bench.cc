@@ -0,0 +1,345 @@
+// Google Benchmark suite for the parser entry points.
+//
+// Payloads are generated from the messages in radamsa/sample_inputs.txt: the
+// topics, paths and JSON members of the samples are reused and padded to the
+// requested size and key count, with "temperature" always as the last member
+// (the worst case for key lookups). A share of the inputs is corrupted to
+// measure the error paths as well.
+//
+// The legacy parse_mqtt_topic() / parse_http_request() copy into fixed 256
+// byte buffers, so they are only measured up to that size; the scanning entry
+// points run from 32 B to 64 KiB.
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "iot_batch.h"
+#include "iot_parser.h"
+#include "json_number.h"
+#include "json_schema.hpp"
+
+// Allocation counter. The target links with -Wl,--wrap=malloc, so every
+// malloc() made by the parser code ends up here.
+static std::atomic<size_t> g_allocs{0};
+
+extern "C" void* __real_malloc(size_t size);
+extern "C" void* __wrap_malloc(size_t size)
+{
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    return __real_malloc(size);
+}
+
+namespace {
+
+constexpr size_t kInputs = 64;          // inputs per benchmark, cycled
+constexpr size_t kLegacyMaxSize = 192;  // payload limit for the 256 byte buffers
+
+struct sample {
+    std::string header;     // "mqtt/home/temperature" or "POST /api/data"
+    std::vector<std::string> members;
+};
+
+uint32_t g_rng = 12345;
+
+uint32_t rng()
+{
+    g_rng = g_rng * 1103515245u + 12345u;
+    return g_rng >> 8;
+}
+
+std::vector<sample> parse_samples(std::istream& in)
+{
+    std::vector<sample> out;
+    std::string line;
+    while (std::getline(in, line)) {
+        size_t brace = line.find('{');
+        if (brace == std::string::npos || brace == 0) {
+            continue;
+        }
+        sample s;
+        s.header = line.substr(0, brace - 1);
+        // Sample bodies are flat objects without commas inside values
+        std::string body = line.substr(brace + 1, line.rfind('}') - brace - 1);
+        size_t pos = 0;
+        while (pos < body.size()) {
+            size_t comma = body.find(',', pos);
+            std::string member = body.substr(pos, comma - pos);
+            if (member.find("\"temperature\"") == std::string::npos) {
+                s.members.push_back(member);
+            }
+            pos = comma == std::string::npos ? body.size() : comma + 1;
+        }
+        out.push_back(s);
+    }
+    return out;
+}
+
+const std::vector<sample>& samples()
+{
+    static const std::vector<sample> all = [] {
+        std::ifstream file(IOT_SAMPLE_INPUTS);
+        std::vector<sample> s = parse_samples(file);
+        if (s.empty()) {
+            fprintf(stderr, "warning: %s not readable, using built-in samples\n", IOT_SAMPLE_INPUTS);
+            std::istringstream builtin(
+                "mqtt/home/temperature {\"device_id\":\"sensor01\",\"temperature\":23.5,\"status\":\"active\"}\n"
+                "POST /device/control {\"action\":\"set\",\"value\":\"on\",\"device\":\"fan\"}\n");
+            s = parse_samples(builtin);
+        }
+        return s;
+    }();
+    return all;
+}
+
+// JSON object of about `size` bytes with `keys` members, the last one being
+// "temperature". String values of the other members carry the padding; with
+// no string member, a "pad" string member is put in front of temperature (one
+// member more than `keys`), so every parser has to walk the whole payload.
+std::string make_payload(const sample& s, size_t size, size_t keys)
+{
+    std::vector<std::string> members;
+    for (size_t i = 0; i + 1 < keys; ++i) {
+        if (i < s.members.size()) {
+            members.push_back(s.members[i]);
+        } else {
+            members.push_back("\"k" + std::to_string(i) + "\":\"v\"");
+        }
+    }
+    std::string temperature = "\"temperature\":23.5";
+    size_t len = 2 + temperature.size();
+    for (const std::string& m : members) {
+        len += m.size() + 1;
+    }
+    std::vector<std::string*> strings;
+    for (std::string& m : members) {
+        if (m.back() == '"') {
+            strings.push_back(&m);
+        }
+    }
+    if (strings.empty() && size > len) {
+        // Padding the temperature's fraction would let strtol() stop at the '.'
+        members.push_back("\"pad\":\"\"");
+        len += members.back().size() + 1;
+        strings.push_back(&members.back());
+    }
+    size_t pad = size > len ? size - len : 0;
+    for (size_t i = 0; i < strings.size(); ++i) {
+        size_t share = pad / strings.size() + (i < pad % strings.size());
+        strings[i]->insert(strings[i]->size() - 1, share, 'x');
+    }
+    std::string out = "{";
+    for (const std::string& m : members) {
+        out += m + ",";
+    }
+    return out + temperature + "}";
+}
+
+// Breaks the JSON: truncation, a missing quote, colon or closing brace
+void corrupt(std::string& json)
+{
+    size_t at = 1 + rng() % (json.size() - 1);
+    switch (rng() % 3) {
+    case 0:
+        json.resize(at);
+        break;
+    case 1: {
+        size_t p = json.find_first_of("\":", at);
+        json[p == std::string::npos ? at : p] = 'x';
+        break;
+    }
+    default:
+        json.back() = ',';
+        break;
+    }
+}
+
+struct input_set {
+    std::vector<std::string> messages;  // header + ' ' + payload
+    std::vector<std::string> payloads;
+    size_t bytes = 0;                   // payload bytes over all inputs
+};
+
+// kInputs MQTT or HTTP inputs, malformed_pct percent of them corrupted
+input_set make_inputs(bool mqtt, size_t size, size_t keys, int malformed_pct)
+{
+    g_rng = 12345;
+    input_set set;
+    std::vector<const sample*> pool;
+    for (const sample& s : samples()) {
+        if ((s.header.compare(0, 4, "mqtt") == 0) == mqtt) {
+            pool.push_back(&s);
+        }
+    }
+    for (size_t i = 0; i < kInputs; ++i) {
+        const sample& s = *pool[i % pool.size()];
+        std::string payload = make_payload(s, size, keys);
+        if ((int)(rng() % 100) < malformed_pct) {
+            corrupt(payload);
+        }
+        set.bytes += payload.size();
+        set.messages.push_back(s.header + " " + payload);
+        set.payloads.push_back(payload);
+    }
+    return set;
+}
+
+void report(benchmark::State& state, const input_set& set, size_t allocs_before)
+{
+    size_t per_input = set.bytes / set.payloads.size();
+    state.SetBytesProcessed((int64_t)(state.iterations() * per_input));
+    state.SetItemsProcessed(state.iterations());
+    state.counters["allocs/op"] = benchmark::Counter(
+        (double)(g_allocs.load() - allocs_before), benchmark::Counter::kAvgIterations);
+}
+
+// ---------------------------------------------------------------------------
+// Legacy entry points
+
+void BM_ParseMqttTopic(benchmark::State& state)
+{
+    input_set set = make_inputs(true, (size_t)state.range(0), (size_t)state.range(1), (int)state.range(2));
+    mqtt_message_t msg;
+    size_t i = 0;
+    size_t allocs = g_allocs.load();
+    for (auto _ : state) {
+        parse_mqtt_topic(set.messages[i++ % kInputs].c_str(), &msg);
+        benchmark::DoNotOptimize(msg);
+    }
+    report(state, set, allocs);
+}
+
+void BM_ParseHttpRequest(benchmark::State& state)
+{
+    input_set set = make_inputs(false, (size_t)state.range(0), (size_t)state.range(1), (int)state.range(2));
+    http_message_t msg;
+    size_t i = 0;
+    size_t allocs = g_allocs.load();
+    for (auto _ : state) {
+        parse_http_request(set.messages[i++ % kInputs].c_str(), &msg);
+        benchmark::DoNotOptimize(msg);
+    }
+    report(state, set, allocs);
+}
+
+void BM_ExtractJsonValue(benchmark::State& state)
+{
+    input_set set = make_inputs(true, (size_t)state.range(0), (size_t)state.range(1), (int)state.range(2));
+    char value[MAX_VALUE_SIZE];
+    size_t i = 0;
+    size_t allocs = g_allocs.load();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(extract_json_value(set.payloads[i++ % kInputs].c_str(), "temperature", value));
+    }
+    report(state, set, allocs);
+}
+
+// ---------------------------------------------------------------------------
+// Typed and batch entry points
+
+void BM_ExtractJsonDouble(benchmark::State& state)
+{
+    input_set set = make_inputs(true, (size_t)state.range(0), (size_t)state.range(1), (int)state.range(2));
+    double value = 0;
+    size_t i = 0;
+    size_t allocs = g_allocs.load();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(extract_json_double(set.payloads[i++ % kInputs].c_str(), "temperature", &value));
+    }
+    report(state, set, allocs);
+}
+
+struct reading {
+    std::string_view device_id;
+    double temperature = 0;
+    std::string_view status;
+};
+
+constexpr auto kReadingSchema = json_schema::make_schema(
+    json_schema::bind("device_id", &reading::device_id),
+    json_schema::bind("temperature", &reading::temperature),
+    json_schema::bind("status", &reading::status));
+
+void BM_SchemaParse(benchmark::State& state)
+{
+    input_set set = make_inputs(true, (size_t)state.range(0), (size_t)state.range(1), (int)state.range(2));
+    size_t i = 0;
+    size_t allocs = g_allocs.load();
+    for (auto _ : state) {
+        const std::string& p = set.payloads[i++ % kInputs];
+        reading r;
+        benchmark::DoNotOptimize(kReadingSchema.parse(p.data(), p.size(), r));
+    }
+    report(state, set, allocs);
+}
+
+// One op is one message; each iteration parses all kInputs messages
+void BM_BatchParse(benchmark::State& state)
+{
+    input_set set = make_inputs(true, (size_t)state.range(0), (size_t)state.range(1), (int)state.range(2));
+    std::vector<iot_span_t> msgs;
+    for (const std::string& m : set.messages) {
+        msgs.push_back({ m.data(), m.size() });
+    }
+    iot_batch_t batch;
+    if (iot_batch_init(&batch, msgs.size()) != 0) {
+        state.SkipWithError("out of memory");
+        return;
+    }
+    size_t allocs = g_allocs.load();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(iot_batch_parse(&batch, msgs.data(), msgs.size()));
+    }
+    state.SetBytesProcessed((int64_t)(state.iterations() * set.bytes));
+    state.SetItemsProcessed((int64_t)(state.iterations() * msgs.size()));
+    state.counters["allocs/op"] = benchmark::Counter(
+        (double)(g_allocs.load() - allocs) / (double)msgs.size(), benchmark::Counter::kAvgIterations);
+    iot_batch_free(&batch);
+}
+
+// Argument grid: {payload size, key count, malformed %}. Combinations whose
+// key count does not fit the payload size are left out.
+void grid(benchmark::internal::Benchmark* b, size_t max_size)
+{
+    b->ArgNames({ "size", "keys", "malformed" });
+    for (size_t size : { 32, 128, 512, 4096, 65536 }) {
+        if (size > max_size) {
+            break;
+        }
+        for (size_t keys : { 1, 4, 16, 64 }) {
+            if (keys * 24 > size) {
+                continue;
+            }
+            for (int malformed : { 0, 10, 50 }) {
+                b->Args({ (int64_t)size, (int64_t)keys, malformed });
+            }
+        }
+    }
+}
+
+void legacy_grid(benchmark::internal::Benchmark* b)
+{
+    grid(b, kLegacyMaxSize);
+}
+
+void full_grid(benchmark::internal::Benchmark* b)
+{
+    grid(b, 64 * 1024);
+}
+
+BENCHMARK(BM_ParseMqttTopic)->Apply(legacy_grid);
+BENCHMARK(BM_ParseHttpRequest)->Apply(legacy_grid);
+BENCHMARK(BM_ExtractJsonValue)->Apply(full_grid);
+BENCHMARK(BM_ExtractJsonDouble)->Apply(full_grid);
+BENCHMARK(BM_SchemaParse)->Apply(full_grid);
+BENCHMARK(BM_BatchParse)->Apply(full_grid);
+
+} // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,26 @@
+#include "iot_replay.h"
+#include "iot_parser.h"
+
+#include <string.h>
+
+#define INPUT_BUFFER_SIZE (MAX_BUFFER_SIZE * 2)    // fgets() buffer of main()
+
+void iot_parser_replay(const uint8_t* data, size_t len)
+{
+    char input[INPUT_BUFFER_SIZE];
+    // fgets() semantics: stop after the first newline or when the buffer is full
+    size_t n = 0;
+    while (n < len && n < sizeof(input) - 1) {
+        input[n] = (char)data[n];
+        if (data[n++] == '\n') {
+            break;
+        }
+    }
+    if (n == 0) {
+        return;
+    }
+    input[n] = '\0';
+    input[strcspn(input, "\n")] = '\0';
+
+    dispatch_message(input);
+}
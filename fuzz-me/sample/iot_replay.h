@@ -0,0 +1,21 @@
+#ifndef IOT_REPLAY_H
+#define IOT_REPLAY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Runs one input through dispatch_message(), like the interactive main(): the
+// first line (up to the fgets() buffer size) is parsed as an MQTT or HTTP
+// message and analyzed. For in-process fuzz drivers that link the parser
+// built with FUZZTEST_BUILD.
+void iot_parser_replay(const uint8_t* data, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IOT_REPLAY_H
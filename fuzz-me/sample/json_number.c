@@ -0,0 +1,472 @@
+#include "json_number.h"
+#include "json_scan.h"
+
+#include <float.h>
+#include <math.h>
+#include <string.h>
+
+#define MAX_MANTISSA_DIGITS 19
+#define MAX_EXACT_POW10 22
+#define MAX_EXPONENT 100000
+#define BIG_LIMBS 40            // 1280 bits; comparisons below need under 1000
+
+// Powers of ten that are exactly representable as doubles
+static const double pow10_exact[MAX_EXACT_POW10 + 1] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+// Decimal value mantissa * 10^exp10, keeping the first 19 significant digits
+typedef struct {
+    uint64_t mantissa;
+    int32_t exp10;
+    int digits;
+    int negative;
+    int truncated;      // non-zero digits beyond the first 19 were dropped
+} decimal_t;
+
+static int is_digit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+static void add_digit(decimal_t* d, char c, int fraction)
+{
+    if (d->mantissa == 0 && c == '0') {
+        // Leading zeros only shift the exponent
+        d->exp10 -= fraction;
+        return;
+    }
+    if (d->digits < MAX_MANTISSA_DIGITS) {
+        d->mantissa = d->mantissa * 10 + (uint64_t)(c - '0');
+        d->exp10 -= fraction;
+    } else {
+        d->truncated |= c != '0';
+        d->exp10 += !fraction;
+    }
+    d->digits++;
+}
+
+// Returns the end of the number or NULL if [p, last) does not start with one
+static const char* scan_decimal(const char* p, const char* last, decimal_t* d)
+{
+    memset(d, 0, sizeof(*d));
+    if (p < last && *p == '-') {
+        d->negative = 1;
+        p++;
+    }
+    if (p == last || !is_digit(*p)) {
+        return NULL;
+    }
+    if (*p == '0') {
+        p++;
+    } else {
+        while (p < last && is_digit(*p)) {
+            add_digit(d, *p++, 0);
+        }
+    }
+    if (p < last && *p == '.') {
+        if (last - p < 2 || !is_digit(p[1])) {
+            return NULL;
+        }
+        for (p++; p < last && is_digit(*p); p++) {
+            add_digit(d, *p, 1);
+        }
+    }
+    if (p < last && (*p == 'e' || *p == 'E')) {
+        const char* q = p + 1;
+        int exp_negative = 0;
+        if (q < last && (*q == '+' || *q == '-')) {
+            exp_negative = *q++ == '-';
+        }
+        if (q == last || !is_digit(*q)) {
+            return NULL;
+        }
+        int32_t e = 0;
+        for (; q < last && is_digit(*q); q++) {
+            if (e < MAX_EXPONENT) {
+                e = e * 10 + (*q - '0');
+            }
+        }
+        d->exp10 += exp_negative ? -e : e;
+        p = q;
+    }
+    return p;
+}
+
+// ---- exact slow path -------------------------------------------------------
+//
+// Decimals the fast path cannot take are rounded by correcting an
+// approximation: the candidate double b moves one ulp at a time until the
+// decimal lies between the midpoints to its neighbours, each midpoint being
+// compared with the decimal exactly in big-integer arithmetic (the approach
+// of Clinger's AlgorithmR). The approximation is within a few ulps, so this
+// takes one or two steps.
+
+typedef struct {
+    uint32_t limb[BIG_LIMBS];   // little-endian base 2^32
+    int len;
+} bigint_t;
+
+static void big_set(bigint_t* b, uint64_t v)
+{
+    b->limb[0] = (uint32_t)v;
+    b->limb[1] = (uint32_t)(v >> 32);
+    b->len = b->limb[1] ? 2 : b->limb[0] ? 1 : 0;
+}
+
+// Limbs past BIG_LIMBS are dropped; the exponent bounds in
+// decimal_to_double_slow() keep every operand well below that
+static void big_mul_small(bigint_t* b, uint32_t f)
+{
+    uint64_t carry = 0;
+    for (int i = 0; i < b->len; i++) {
+        uint64_t t = (uint64_t)b->limb[i] * f + carry;
+        b->limb[i] = (uint32_t)t;
+        carry = t >> 32;
+    }
+    if (carry && b->len < BIG_LIMBS) {
+        b->limb[b->len++] = (uint32_t)carry;
+    }
+}
+
+static void big_mul_pow5(bigint_t* b, int n)
+{
+    for (; n >= 13; n -= 13) {
+        big_mul_small(b, 1220703125u);      // 5^13, the largest that fits
+    }
+    uint32_t f = 1;
+    for (; n > 0; n--) {
+        f *= 5;
+    }
+    big_mul_small(b, f);
+}
+
+static void big_add(bigint_t* a, const bigint_t* b)
+{
+    uint64_t carry = 0;
+    int len = a->len > b->len ? a->len : b->len;
+    for (int i = 0; i < len; i++) {
+        uint64_t t = carry + (i < a->len ? a->limb[i] : 0) + (i < b->len ? b->limb[i] : 0);
+        a->limb[i] = (uint32_t)t;
+        carry = t >> 32;
+    }
+    a->len = len;
+    if (carry && a->len < BIG_LIMBS) {
+        a->limb[a->len++] = (uint32_t)carry;
+    }
+}
+
+static void big_shl(bigint_t* b, int n);
+
+static void big_mul_u64(bigint_t* b, uint64_t f)
+{
+    bigint_t hi = *b;
+    big_mul_small(b, (uint32_t)f);
+    big_mul_small(&hi, (uint32_t)(f >> 32));
+    big_shl(&hi, 32);
+    big_add(b, &hi);
+}
+
+static void big_shl(bigint_t* b, int n)
+{
+    if (b->len == 0) {
+        return;
+    }
+    int words = n / 32;
+    int bits = n % 32;
+    int len = b->len + words + 1;
+    if (len > BIG_LIMBS) {
+        len = BIG_LIMBS;
+    }
+    for (int i = len - 1; i >= 0; i--) {
+        int src = i - words;
+        uint32_t hi = src >= 0 && src < b->len ? b->limb[src] : 0;
+        uint32_t lo = src >= 1 && src - 1 < b->len ? b->limb[src - 1] : 0;
+        b->limb[i] = bits ? hi << bits | lo >> (32 - bits) : hi;
+    }
+    while (len > 0 && b->limb[len - 1] == 0) {
+        len--;
+    }
+    b->len = len;
+}
+
+static int big_cmp(const bigint_t* a, const bigint_t* b)
+{
+    if (a->len != b->len) {
+        return a->len < b->len ? -1 : 1;
+    }
+    for (int i = a->len - 1; i >= 0; i--) {
+        if (a->limb[i] != b->limb[i]) {
+            return a->limb[i] < b->limb[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+// Splits a finite b >= 0 into mb * 2^eb with eb at least the subnormal
+// exponent, so that the next double up is (mb + 1) * 2^eb
+static void split_double(double b, uint64_t* mb, int* eb)
+{
+    int exp2 = 0;
+    frexp(b, &exp2);
+    *eb = b == 0.0 || exp2 - 53 < -1074 ? -1074 : exp2 - 53;
+    *mb = (uint64_t)ldexp(b, -*eb);
+}
+
+// Sign of m * 10^e - (2 * mb + 1) * 2^(eb - 1): the decimal against the
+// midpoint between mb * 2^eb and the next double up. scaled is m * 5^e for
+// e >= 0 and 5^-e otherwise, computed once per number.
+static int compare_midpoint(const bigint_t* scaled, uint64_t m, int32_t e, uint64_t mb, int eb)
+{
+    bigint_t lhs, rhs;
+    if (e >= 0) {
+        lhs = *scaled;
+        big_set(&rhs, 2 * mb + 1);
+    } else {
+        big_set(&lhs, m);
+        rhs = *scaled;
+        big_mul_u64(&rhs, 2 * mb + 1);
+    }
+    int rhs_exp2 = eb - 1;
+    if (e > rhs_exp2) {
+        big_shl(&lhs, e - rhs_exp2);
+    } else {
+        big_shl(&rhs, rhs_exp2 - e);
+    }
+    return big_cmp(&lhs, &rhs);
+}
+
+// m * 10^e within a few ulps: one rounding per factor of at most 10^22
+static double approximate(uint64_t m, int32_t e)
+{
+    double v = (double)m;
+    int32_t n = e < 0 ? -e : e;
+    while (n > 0) {
+        int32_t k = n > MAX_EXACT_POW10 ? MAX_EXACT_POW10 : n;
+        v = e < 0 ? v / pow10_exact[k] : v * pow10_exact[k];
+        n -= k;
+    }
+    return v;
+}
+
+// Correctly rounded m * 10^e for m > 0
+static double decimal_to_double_slow(uint64_t m, int32_t e)
+{
+    if (e > 309) {
+        return HUGE_VAL;        // at least 10^310
+    }
+    if (e < -343) {
+        return 0.0;             // below 10^-324, under half the smallest subnormal
+    }
+    double b = approximate(m, e);
+    if (isinf(b)) {
+        b = DBL_MAX;
+    }
+    bigint_t scaled;
+    big_set(&scaled, e >= 0 ? m : 1);
+    big_mul_pow5(&scaled, e >= 0 ? e : -e);
+    uint64_t mb;
+    int eb;
+    for (;;) {
+        // Up while the decimal is above the upper midpoint; ties to even
+        split_double(b, &mb, &eb);
+        int c = compare_midpoint(&scaled, m, e, mb, eb);
+        if (c > 0 || (c == 0 && (mb & 1))) {
+            b = nextafter(b, HUGE_VAL);
+            if (isinf(b)) {
+                return b;
+            }
+            continue;
+        }
+        if (b == 0.0) {
+            return b;
+        }
+        // Down while it is below the lower one
+        double below = nextafter(b, 0.0);
+        split_double(below, &mb, &eb);
+        c = compare_midpoint(&scaled, m, e, mb, eb);
+        if (c < 0 || (c == 0 && !(mb & 1))) {
+            b = below;
+            continue;
+        }
+        return b;
+    }
+}
+
+static double decimal_to_double(const decimal_t* d, json_number_status_t* status)
+{
+    double v;
+    *status = d->truncated ? JSON_NUMBER_INEXACT : JSON_NUMBER_OK;
+    if (d->mantissa == 0) {
+        v = 0.0;
+    } else if (d->mantissa <= (UINT64_C(1) << 53) &&
+               d->exp10 >= -MAX_EXACT_POW10 && d->exp10 <= MAX_EXACT_POW10) {
+        // Both operands are exact, so one IEEE operation rounds correctly
+        v = (double)d->mantissa;
+        v = d->exp10 < 0 ? v / pow10_exact[-d->exp10] : v * pow10_exact[d->exp10];
+    } else {
+        v = decimal_to_double_slow(d->mantissa, d->exp10);
+        if (isinf(v)) {
+            *status = JSON_NUMBER_OVERFLOW;
+        } else if (v == 0.0 || fpclassify(v) == FP_SUBNORMAL) {
+            *status = JSON_NUMBER_INEXACT;
+        }
+    }
+    return d->negative ? -v : v;
+}
+
+const char* json_parse_int64(const char* first, const char* last,
+                             int64_t* value, json_number_status_t* status)
+{
+    const char* p = first;
+    int negative = 0;
+    if (p < last && *p == '-') {
+        negative = 1;
+        p++;
+    }
+    if (p == last || !is_digit(*p)) {
+        *status = JSON_NUMBER_INVALID;
+        return first;
+    }
+    // Magnitude limit: 2^63 for negative numbers, 2^63 - 1 otherwise
+    const uint64_t limit = (uint64_t)INT64_MAX + (uint64_t)negative;
+    uint64_t acc = 0;
+    int overflow = 0;
+    if (*p == '0') {
+        p++;
+    } else {
+        for (; p < last && is_digit(*p); p++) {
+            uint64_t digit = (uint64_t)(*p - '0');
+            if (acc > (limit - digit) / 10) {
+                overflow = 1;
+            } else {
+                acc = acc * 10 + digit;
+            }
+        }
+    }
+    if (overflow) {
+        *value = negative ? INT64_MIN : INT64_MAX;
+        *status = JSON_NUMBER_OVERFLOW;
+    } else {
+        *value = negative ? (int64_t)(0 - acc) : (int64_t)acc;
+        *status = JSON_NUMBER_OK;
+    }
+    return p;
+}
+
+const char* json_parse_uint64(const char* first, const char* last,
+                              uint64_t* value, json_number_status_t* status)
+{
+    const char* p = first;
+    int negative = 0;
+    if (p < last && *p == '-') {
+        negative = 1;
+        p++;
+    }
+    if (p == last || !is_digit(*p)) {
+        *status = JSON_NUMBER_INVALID;
+        return first;
+    }
+    uint64_t acc = 0;
+    int overflow = 0;
+    if (*p == '0') {
+        p++;
+    } else {
+        overflow = negative;
+        for (; p < last && is_digit(*p); p++) {
+            uint64_t digit = (uint64_t)(*p - '0');
+            if (acc > (UINT64_MAX - digit) / 10) {
+                overflow = 1;
+            } else {
+                acc = acc * 10 + digit;
+            }
+        }
+    }
+    if (overflow) {
+        *value = negative ? 0 : UINT64_MAX;
+        *status = JSON_NUMBER_OVERFLOW;
+    } else {
+        *value = acc;
+        *status = JSON_NUMBER_OK;
+    }
+    return p;
+}
+
+const char* json_parse_double(const char* first, const char* last,
+                              double* value, json_number_status_t* status)
+{
+    decimal_t d;
+    const char* end = scan_decimal(first, last, &d);
+    if (!end) {
+        *status = JSON_NUMBER_INVALID;
+        return first;
+    }
+    *value = decimal_to_double(&d, status);
+    return end;
+}
+
+// Finds key among the members of a flat object and returns its number token
+static int find_number(const char* json, const char* key, json_span_t* token)
+{
+    if (!json || !key) {
+        return 0;
+    }
+    size_t key_len = strlen(key);
+    json_scanner_t scanner;
+    json_member_t m;
+    json_scan_init(&scanner, json, strlen(json));
+    while (json_scan_next(&scanner, &m) == 1) {
+        if (m.key.len == key_len && memcmp(m.key.ptr, key, key_len) == 0) {
+            if (m.type != JSON_SCAN_NUMBER) {
+                return 0;
+            }
+            *token = m.value;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+json_number_status_t extract_json_int64(const char* json, const char* key, int64_t* value)
+{
+    json_span_t token;
+    if (!find_number(json, key, &token)) {
+        return JSON_NUMBER_NOT_FOUND;
+    }
+    const char* last = token.ptr + token.len;
+    json_number_status_t status;
+    if (json_parse_int64(token.ptr, last, value, &status) == last) {
+        return status;
+    }
+
+    // Fraction or exponent: go through the decimal form and truncate
+    double d;
+    if (json_parse_double(token.ptr, last, &d, &status) != last) {
+        return JSON_NUMBER_INVALID;
+    }
+    // Only [-2^63, 2^63) truncates into int64_t
+    if (status == JSON_NUMBER_OVERFLOW || d >= 9223372036854775808.0 || d < -9223372036854775808.0) {
+        *value = d < 0 ? INT64_MIN : INT64_MAX;
+        return JSON_NUMBER_OVERFLOW;
+    }
+    *value = (int64_t)d;
+    if ((double)*value != d) {
+        status = JSON_NUMBER_INEXACT;
+    }
+    return status;
+}
+
+json_number_status_t extract_json_double(const char* json, const char* key, double* value)
+{
+    json_span_t token;
+    if (!find_number(json, key, &token)) {
+        return JSON_NUMBER_NOT_FOUND;
+    }
+    const char* last = token.ptr + token.len;
+    json_number_status_t status;
+    if (json_parse_double(token.ptr, last, value, &status) != last) {
+        return JSON_NUMBER_INVALID;
+    }
+    return status;
+}
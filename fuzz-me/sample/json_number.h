@@ -0,0 +1,58 @@
+#ifndef JSON_NUMBER_H
+#define JSON_NUMBER_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Checked conversion of JSON number tokens to native types.
+//
+// The parse functions follow std::from_chars: they convert the longest valid
+// prefix of [first, last), store the value and return a pointer past the last
+// character consumed (first on failure). Input does not have to be
+// NUL-terminated. The status reports what was lost on the way:
+//
+//   JSON_NUMBER_OK        value is exact (doubles: correctly rounded)
+//   JSON_NUMBER_INEXACT   value was rounded: a fraction was dropped for an
+//                         integer, more than 19 significant digits were given,
+//                         or a double underflowed
+//   JSON_NUMBER_OVERFLOW  out of range; the value is saturated (INT64_MIN/MAX
+//                         or +/-HUGE_VAL)
+//   JSON_NUMBER_INVALID   not a JSON number; the value is left untouched
+
+typedef enum {
+    JSON_NUMBER_OK = 0,
+    JSON_NUMBER_INEXACT,
+    JSON_NUMBER_OVERFLOW,
+    JSON_NUMBER_INVALID,
+    JSON_NUMBER_NOT_FOUND,  // extract_json_*() only: key is missing or not a number
+} json_number_status_t;
+
+// Integer grammar only (-?digits); stops at '.', 'e' or 'E'.
+const char* json_parse_int64(const char* first, const char* last,
+                             int64_t* value, json_number_status_t* status);
+
+// Same grammar with the full uint64_t range. Negative numbers other than -0
+// are out of range and saturate to 0.
+const char* json_parse_uint64(const char* first, const char* last,
+                              uint64_t* value, json_number_status_t* status);
+
+// Full JSON number grammar (-?int(.frac)?([eE][+-]?exp)?).
+const char* json_parse_double(const char* first, const char* last,
+                              double* value, json_number_status_t* status);
+
+// Typed counterparts of extract_json_value() for numeric members of a flat
+// JSON object. The value is converted straight from the payload, so "25.5"
+// stays 25.5 and out-of-range input is reported instead of wrapped.
+// extract_json_int64() accepts fractional tokens and truncates them toward
+// zero with JSON_NUMBER_INEXACT.
+json_number_status_t extract_json_int64(const char* json, const char* key, int64_t* value);
+json_number_status_t extract_json_double(const char* json, const char* key, double* value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // JSON_NUMBER_H
@@ -0,0 +1,230 @@
+#ifndef JSON_SCAN_H
+#define JSON_SCAN_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Single-pass scanner over the members of a flat JSON object such as the
+// payloads handled by the IoT parser. Each call to json_scan_next() yields one
+// key/value pair as spans into the input; nothing is copied or decoded, so the
+// caller decides what (if anything) to convert. Nested objects and arrays are
+// returned as raw spans and not descended into.
+//
+// Header-only so it can be shared by the C parser fast paths and the C++
+// helpers built on top of it.
+
+typedef enum {
+    JSON_SCAN_STRING,   // value excludes the quotes, escapes are left as-is
+    JSON_SCAN_NUMBER,
+    JSON_SCAN_TRUE,
+    JSON_SCAN_FALSE,
+    JSON_SCAN_NULL,
+    JSON_SCAN_OBJECT,   // value spans the whole {...}
+    JSON_SCAN_ARRAY,    // value spans the whole [...]
+} json_scan_type_t;
+
+typedef struct {
+    const char* ptr;
+    size_t len;
+} json_span_t;
+
+typedef struct {
+    json_span_t key;    // excludes the quotes, escapes are left as-is
+    json_span_t value;
+    json_scan_type_t type;
+    int escaped;        // key or string value contains backslash escapes
+} json_member_t;
+
+typedef struct {
+    const char* cur;
+    const char* end;
+    int state;          // 0: before '{', 1: first member, 2: later members, 3: done
+} json_scanner_t;
+
+static inline void json_scan_init(json_scanner_t* s, const char* json, size_t len)
+{
+    s->cur = json;
+    s->end = json + len;
+    s->state = 0;
+}
+
+static inline const char* json_scan_ws(const char* p, const char* end)
+{
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) {
+        p++;
+    }
+    return p;
+}
+
+// p points just past the opening quote; returns the closing quote or NULL
+static inline const char* json_scan_string(const char* p, const char* end, int* escaped)
+{
+    while (p < end) {
+        if (*p == '"') {
+            return p;
+        }
+        if (*p == '\\') {
+            if (end - p < 2) {
+                return NULL;
+            }
+            *escaped = 1;
+            p += 2;
+            continue;
+        }
+        p++;
+    }
+    return NULL;
+}
+
+// p points at '{' or '['; returns the position past the matching bracket or NULL
+static inline const char* json_scan_container(const char* p, const char* end)
+{
+    size_t depth = 0;
+    int escaped = 0;
+    while (p < end) {
+        char c = *p++;
+        if (c == '"') {
+            p = json_scan_string(p, end, &escaped);
+            if (!p) {
+                return NULL;
+            }
+            p++;
+        } else if (c == '{' || c == '[') {
+            depth++;
+        } else if (c == '}' || c == ']') {
+            if (--depth == 0) {
+                return p;
+            }
+        }
+    }
+    return NULL;
+}
+
+static inline int json_scan_literal(const char* p, const char* end, const char* lit, size_t len)
+{
+    if ((size_t)(end - p) < len) {
+        return 0;
+    }
+    for (size_t i = 0; i < len; ++i) {
+        if (p[i] != lit[i]) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// Returns 1 and fills *m for each member, 0 at the closing '}' and -1 if the
+// input is not a well-formed object. After 0 or -1 the scanner stays put.
+static inline int json_scan_next(json_scanner_t* s, json_member_t* m)
+{
+    const char* end = s->end;
+    const char* p = json_scan_ws(s->cur, end);
+    if (s->state == 3) {
+        return 0;
+    }
+    if (s->state == 0) {
+        if (p == end || *p != '{') {
+            return -1;
+        }
+        p = json_scan_ws(p + 1, end);
+        s->state = 1;
+    }
+    if (p == end) {
+        return -1;
+    }
+    if (*p == '}') {
+        s->cur = p + 1;
+        s->state = 3;
+        return 0;
+    }
+    if (s->state == 2) {
+        if (*p != ',') {
+            return -1;
+        }
+        p = json_scan_ws(p + 1, end);
+    }
+    if (p == end || *p != '"') {
+        return -1;
+    }
+
+    m->escaped = 0;
+    m->key.ptr = p + 1;
+    p = json_scan_string(p + 1, end, &m->escaped);
+    if (!p) {
+        return -1;
+    }
+    m->key.len = (size_t)(p - m->key.ptr);
+    p = json_scan_ws(p + 1, end);
+    if (p == end || *p != ':') {
+        return -1;
+    }
+    p = json_scan_ws(p + 1, end);
+    if (p == end) {
+        return -1;
+    }
+
+    const char* v = p;
+    switch (*p) {
+    case '"':
+        m->type = JSON_SCAN_STRING;
+        v = p + 1;
+        p = json_scan_string(v, end, &m->escaped);
+        if (!p) {
+            return -1;
+        }
+        m->value.ptr = v;
+        m->value.len = (size_t)(p - v);
+        p++;
+        break;
+    case '{':
+    case '[':
+        m->type = *p == '{' ? JSON_SCAN_OBJECT : JSON_SCAN_ARRAY;
+        p = json_scan_container(p, end);
+        if (!p) {
+            return -1;
+        }
+        m->value.ptr = v;
+        m->value.len = (size_t)(p - v);
+        break;
+    case 't':
+    case 'f':
+    case 'n': {
+        static const char* const lits[] = { "true", "false", "null" };
+        static const json_scan_type_t types[] = { JSON_SCAN_TRUE, JSON_SCAN_FALSE, JSON_SCAN_NULL };
+        int i = *p == 't' ? 0 : *p == 'f' ? 1 : 2;
+        size_t len = i == 1 ? 5 : 4;
+        if (!json_scan_literal(p, end, lits[i], len)) {
+            return -1;
+        }
+        m->type = types[i];
+        m->value.ptr = v;
+        m->value.len = len;
+        p += len;
+        break;
+    }
+    default:
+        while (p < end && ((*p >= '0' && *p <= '9') || *p == '-' || *p == '+' ||
+                           *p == '.' || *p == 'e' || *p == 'E')) {
+            p++;
+        }
+        if (p == v) {
+            return -1;
+        }
+        m->type = JSON_SCAN_NUMBER;
+        m->value.ptr = v;
+        m->value.len = (size_t)(p - v);
+        break;
+    }
+    s->cur = p;
+    s->state = 2;
+    return 1;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // JSON_SCAN_H
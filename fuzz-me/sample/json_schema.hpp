@@ -0,0 +1,255 @@
+#ifndef JSON_SCHEMA_HPP
+#define JSON_SCHEMA_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "json_number.h"
+#include "json_scan.h"
+
+// Compile-time key tables for JSON payloads with a known schema.
+//
+// A schema binds JSON key names to members of a struct:
+//
+//   struct sensor_reading {
+//       std::string_view device_id;
+//       double temperature;
+//       bool active;
+//   };
+//   static constexpr auto sensor_schema = json_schema::make_schema(
+//       json_schema::bind("device_id", &sensor_reading::device_id),
+//       json_schema::bind("temperature", &sensor_reading::temperature),
+//       json_schema::bind("active", &sensor_reading::active));
+//
+//   sensor_reading r{};
+//   auto res = sensor_schema.parse(payload, len, r);
+//
+// make_schema() searches a seed for which the key hashes are collision free
+// in a small power-of-two table, entirely at compile time (make_schema() is
+// consteval from C++20 on; in C++17 declare the schema constexpr as above). parse() walks the
+// payload once with json_scan_next(), hashes each key, verifies it against the
+// one candidate name and hands the value to the typed setter of that member.
+// Nothing is formatted or copied; strings are views into the payload.
+//
+// Supported member types: integers, floating point, bool and std::string_view.
+
+namespace json_schema {
+
+constexpr uint32_t hash(std::string_view s, uint32_t seed)
+{
+    uint32_t h = 2166136261u ^ (seed * 0x9E3779B1u);
+    for (char c : s) {
+        h ^= static_cast<uint8_t>(c);
+        h *= 16777619u;
+    }
+    return h ^ (h >> 16);
+}
+
+constexpr std::size_t table_size_for(std::size_t n)
+{
+    std::size_t size = 2;
+    while (size < 2 * n) {
+        size *= 2;
+    }
+    return size;
+}
+
+#if defined(__cpp_consteval)
+#define JSON_SCHEMA_CONSTEVAL consteval
+#else
+#define JSON_SCHEMA_CONSTEVAL constexpr
+#endif
+
+// Deliberately not constexpr: reaching it fails constant evaluation, which is
+// how duplicate key names are reported at compile time. A C++17 schema built
+// at runtime aborts instead of silently matching no key.
+[[noreturn]] inline void perfect_hash_seed_not_found() { std::abort(); }
+
+template <std::size_t N>
+struct perfect_hash {
+    static constexpr std::size_t table_size = table_size_for(N);
+    static constexpr uint32_t max_seed = 1u << 16;
+
+    uint32_t seed = 0;
+    std::array<uint8_t, table_size> slots{};    // field index + 1, 0 when empty
+
+    constexpr explicit perfect_hash(const std::array<std::string_view, N>& keys)
+    {
+        static_assert(N < 255, "too many keys for an 8-bit slot table");
+        for (seed = 0; seed < max_seed; ++seed) {
+            std::array<uint8_t, table_size> candidate{};
+            bool collision = false;
+            for (std::size_t i = 0; i < N && !collision; ++i) {
+                std::size_t slot = hash(keys[i], seed) & (table_size - 1);
+                collision = candidate[slot] != 0;
+                candidate[slot] = static_cast<uint8_t>(i + 1);
+            }
+            if (!collision) {
+                slots = candidate;
+                return;
+            }
+        }
+        perfect_hash_seed_not_found();
+    }
+
+    // Index of the only key that can be equal to key, or -1
+    constexpr int candidate(std::string_view key) const
+    {
+        return static_cast<int>(slots[hash(key, seed) & (table_size - 1)]) - 1;
+    }
+};
+
+template <typename Obj, typename Member>
+struct field {
+    std::string_view name;
+    Member Obj::*member;
+};
+
+template <typename Obj, typename Member>
+constexpr field<Obj, Member> bind(std::string_view name, Member Obj::*member)
+{
+    return { name, member };
+}
+
+struct parse_result {
+    uint32_t seen = 0;      // bit i: field i was assigned
+    uint32_t invalid = 0;   // bit i: field i was present with an unusable value
+    uint32_t unknown = 0;   // keys that are not part of the schema
+    bool ok = false;        // false if the payload is not a well-formed object
+};
+
+// Typed setters. Each returns false if the JSON value cannot be stored in the
+// member (wrong type, integer with a fraction, out of range). Numbers go
+// through the checked parsers in json_number.h.
+template <typename Member>
+bool assign(Member& out, const json_member_t& m)
+{
+    const char* first = m.value.ptr;
+    const char* last = m.value.ptr + m.value.len;
+    if constexpr (std::is_same_v<Member, std::string_view>) {
+        if (m.type != JSON_SCAN_STRING) {
+            return false;
+        }
+        out = std::string_view(first, m.value.len);
+        return true;
+    } else if constexpr (std::is_same_v<Member, bool>) {
+        if (m.type != JSON_SCAN_TRUE && m.type != JSON_SCAN_FALSE) {
+            return false;
+        }
+        out = m.type == JSON_SCAN_TRUE;
+        return true;
+    } else if constexpr (std::is_integral_v<Member> && std::is_unsigned_v<Member>) {
+        uint64_t value = 0;
+        json_number_status_t status;
+        if (m.type != JSON_SCAN_NUMBER || json_parse_uint64(first, last, &value, &status) != last ||
+            status != JSON_NUMBER_OK || value > std::numeric_limits<Member>::max()) {
+            return false;
+        }
+        out = static_cast<Member>(value);
+        return true;
+    } else if constexpr (std::is_integral_v<Member>) {
+        int64_t value = 0;
+        json_number_status_t status;
+        if (m.type != JSON_SCAN_NUMBER || json_parse_int64(first, last, &value, &status) != last ||
+            status != JSON_NUMBER_OK) {
+            return false;
+        }
+        if constexpr (sizeof(Member) < sizeof(int64_t)) {
+            if (value < std::numeric_limits<Member>::min() || value > std::numeric_limits<Member>::max()) {
+                return false;
+            }
+        }
+        out = static_cast<Member>(value);
+        return true;
+    } else if constexpr (std::is_floating_point_v<Member>) {
+        double value = 0;
+        json_number_status_t status;
+        if (m.type != JSON_SCAN_NUMBER || json_parse_double(first, last, &value, &status) != last ||
+            status == JSON_NUMBER_OVERFLOW) {
+            return false;
+        }
+        // A double beyond the member's range would become inf (float)
+        if (value < std::numeric_limits<Member>::lowest() || value > std::numeric_limits<Member>::max()) {
+            return false;
+        }
+        out = static_cast<Member>(value);
+        return true;
+    } else {
+        static_assert(std::is_same_v<Member, void>, "unsupported member type");
+        return false;
+    }
+}
+
+template <typename Obj, typename... Fields>
+class schema {
+public:
+    static constexpr std::size_t size = sizeof...(Fields);
+    static_assert(size > 0 && size <= 32, "a schema holds 1 to 32 fields");
+
+    constexpr explicit schema(Fields... fields)
+        : fields_(fields...), names_{ fields.name... }, hash_(names_) {}
+
+    // Field index of key, or -1 for keys outside the schema
+    constexpr int index_of(std::string_view key) const
+    {
+        int i = hash_.candidate(key);
+        return i >= 0 && names_[static_cast<std::size_t>(i)] == key ? i : -1;
+    }
+
+    parse_result parse(const char* json, std::size_t len, Obj& out) const
+    {
+        parse_result res;
+        json_scanner_t scanner;
+        json_member_t m;
+        int rc;
+        json_scan_init(&scanner, json, len);
+        while ((rc = json_scan_next(&scanner, &m)) == 1) {
+            int i = index_of(std::string_view(m.key.ptr, m.key.len));
+            if (i < 0) {
+                res.unknown++;
+                continue;
+            }
+            uint32_t bit = 1u << i;
+            if (dispatch(static_cast<std::size_t>(i), m, out, std::index_sequence_for<Fields...>{})) {
+                res.seen |= bit;
+                res.invalid &= ~bit;
+            } else {
+                res.invalid |= bit;
+            }
+        }
+        res.ok = rc == 0;
+        return res;
+    }
+
+private:
+    // Expands to a chain of index comparisons that compilers lower to a jump
+    // table, i.e. a switch over the field index with one typed setter per case.
+    template <std::size_t... I>
+    bool dispatch(std::size_t index, const json_member_t& m, Obj& out, std::index_sequence<I...>) const
+    {
+        bool ok = false;
+        (void)((index == I && (ok = assign(out.*(std::get<I>(fields_).member), m), true)) || ...);
+        return ok;
+    }
+
+    std::tuple<Fields...> fields_;
+    std::array<std::string_view, size> names_;
+    perfect_hash<size> hash_;
+};
+
+template <typename Obj, typename... Members>
+JSON_SCHEMA_CONSTEVAL auto make_schema(field<Obj, Members>... fields)
+{
+    return schema<Obj, field<Obj, Members>...>(fields...);
+}
+
+} // namespace json_schema
+
+#endif // JSON_SCHEMA_HPP
@@ -0,0 +1,124 @@
+// Compares the compile-time key table (json_schema.hpp) with per-key lookups
+// through extract_json_value() on the analysis payloads of the parser.
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string_view>
+
+#include "iot_parser.h"
+#include "json_number.h"
+#include "json_schema.hpp"
+
+namespace {
+
+struct mqtt_reading {
+    std::string_view device_id;
+    double temperature = 0;
+    std::string_view status;
+};
+
+struct http_command {
+    std::string_view action;
+    int64_t value = 0;
+    bool enabled = false;
+};
+
+constexpr auto mqtt_schema = json_schema::make_schema(
+    json_schema::bind("device_id", &mqtt_reading::device_id),
+    json_schema::bind("temperature", &mqtt_reading::temperature),
+    json_schema::bind("status", &mqtt_reading::status));
+
+constexpr auto http_schema = json_schema::make_schema(
+    json_schema::bind("action", &http_command::action),
+    json_schema::bind("value", &http_command::value),
+    json_schema::bind("enabled", &http_command::enabled));
+
+static_assert(mqtt_schema.index_of("temperature") == 1, "key table is built at compile time");
+static_assert(mqtt_schema.index_of("humidity") == -1, "unknown keys are rejected");
+
+constexpr int kIterations = 1000000;
+
+template <typename Fn>
+double ns_per_op(Fn&& fn)
+{
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < kIterations; ++i) {
+        fn();
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / kIterations;
+}
+
+// Keeps results observable so the loops are not optimized away
+volatile size_t g_sink;
+
+void compare(const char* label, const char* payload, const char* const* keys, size_t nkeys,
+             double (*schema_run)(const char*, size_t))
+{
+    size_t len = strlen(payload);
+    double legacy = ns_per_op([&] {
+        char value[MAX_VALUE_SIZE];
+        size_t total = 0;
+        for (size_t k = 0; k < nkeys; ++k) {
+            total += (size_t)extract_json_value(payload, keys[k], value);
+        }
+        g_sink = total;
+    });
+    double fast = schema_run(payload, len);
+    printf("%-6s extract_json_value x%zu: %7.1f ns  schema.parse: %7.1f ns  (%.1fx)\n",
+           label, nkeys, legacy, fast, legacy / fast);
+}
+
+double run_mqtt_schema(const char* payload, size_t len)
+{
+    return ns_per_op([&] {
+        mqtt_reading r;
+        g_sink = mqtt_schema.parse(payload, len, r).seen;
+    });
+}
+
+double run_http_schema(const char* payload, size_t len)
+{
+    return ns_per_op([&] {
+        http_command c;
+        g_sink = http_schema.parse(payload, len, c).seen;
+    });
+}
+
+void compare_numeric(const char* payload)
+{
+    double legacy = ns_per_op([&] {
+        char value[MAX_VALUE_SIZE];
+        extract_json_value(payload, "temperature", value);
+        g_sink = (size_t)strtod(value, nullptr);
+    });
+    double typed = ns_per_op([&] {
+        double value = 0;
+        extract_json_double(payload, "temperature", &value);
+        g_sink = (size_t)value;
+    });
+    printf("NUM    extract_json_value+strtod: %7.1f ns  extract_json_double: %7.1f ns  (%.1fx)\n",
+           legacy, typed, legacy / typed);
+}
+
+} // namespace
+
+int main()
+{
+    static const char* const mqtt_keys[] = { "device_id", "temperature", "status" };
+    static const char* const http_keys[] = { "action", "value", "enabled" };
+    const char* mqtt_payload = "{\"device_id\":\"sensor01\",\"temperature\":23.5,\"status\":\"active\"}";
+    const char* http_payload = "{\"action\":\"set\",\"value\":42,\"device\":\"fan\",\"enabled\":true}";
+
+    mqtt_reading r;
+    json_schema::parse_result res = mqtt_schema.parse(mqtt_payload, strlen(mqtt_payload), r);
+    printf("device_id=%.*s temperature=%g status=%.*s (seen=0x%x ok=%d)\n",
+           (int)r.device_id.size(), r.device_id.data(), r.temperature,
+           (int)r.status.size(), r.status.data(), res.seen, res.ok);
+
+    compare("MQTT", mqtt_payload, mqtt_keys, 3, run_mqtt_schema);
+    compare("HTTP", http_payload, http_keys, 3, run_http_schema);
+    compare_numeric(mqtt_payload);
+    return 0;
+}
@@ -0,0 +1,597 @@
+#include "topic_trie.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// Index 0 is the root node and the reserved "end" slot of the subscriber
+// arena, so it doubles as the "none" marker for child and list links.
+#define NONE 0u
+#define LEVEL_PLUS UINT32_MAX
+#define LEVEL_FREE (UINT32_MAX - 1)
+
+typedef struct {
+    uint32_t offset;    // into level_chars
+    uint32_t len;
+    uint32_t hash;
+} level_t;
+
+typedef struct {
+    uint32_t parent;    // next free node while on the free list
+    uint32_t level;     // interned level id, LEVEL_PLUS or LEVEL_FREE
+    uint32_t plus;      // '+' child
+    uint32_t subs;      // filters ending at this node
+    uint32_t hash_subs; // filters ending at this node's '#' child
+    uint32_t children;  // exact children plus the '+' child
+} node_t;
+
+typedef struct {
+    uint32_t parent;
+    uint32_t level;
+    uint32_t child;     // NONE marks an empty slot
+} edge_t;
+
+typedef struct {
+    uint32_t id;
+    uint32_t next;
+} sub_t;
+
+struct topic_trie {
+    node_t* nodes;
+    uint32_t node_count;
+    uint32_t node_cap;
+    uint32_t node_free;
+    uint32_t node_live;
+
+    level_t* levels;
+    uint32_t level_count;
+    uint32_t level_cap;
+    char* level_chars;
+    uint32_t level_chars_len;
+    uint32_t level_chars_cap;
+    uint32_t* level_slots;      // level id + 1, 0 marks an empty slot
+    uint32_t level_slot_mask;
+
+    edge_t* edges;
+    uint32_t edge_count;
+    uint32_t edge_mask;
+
+    sub_t* subs;
+    uint32_t sub_count;
+    uint32_t sub_cap;
+    uint32_t sub_free;
+    uint32_t sub_live;
+};
+
+static uint32_t hash_bytes(const char* s, size_t len)
+{
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; ++i) {
+        h ^= (uint8_t)s[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static uint32_t hash_edge(uint32_t parent, uint32_t level)
+{
+    uint32_t h = parent * 0x9E3779B1u ^ level * 0x85EBCA77u;
+    return h ^ (h >> 15);
+}
+
+static int grow(void** ptr, uint32_t* cap, uint32_t need, size_t elem)
+{
+    if (need <= *cap) {
+        return 0;
+    }
+    uint32_t new_cap = *cap ? *cap : 16;
+    while (new_cap < need) {
+        new_cap *= 2;
+    }
+    void* p = realloc(*ptr, (size_t)new_cap * elem);
+    if (!p) {
+        return -1;
+    }
+    *ptr = p;
+    *cap = new_cap;
+    return 0;
+}
+
+// ---- level interning -------------------------------------------------------
+
+static uint32_t level_find(const topic_trie_t* trie, const char* s, size_t len, uint32_t hash)
+{
+    for (uint32_t i = hash & trie->level_slot_mask;; i = (i + 1) & trie->level_slot_mask) {
+        uint32_t slot = trie->level_slots[i];
+        if (slot == 0) {
+            return LEVEL_FREE;
+        }
+        const level_t* l = &trie->levels[slot - 1];
+        // level_chars is still NULL while only empty levels are interned
+        if (l->hash == hash && l->len == len &&
+            (len == 0 || memcmp(trie->level_chars + l->offset, s, len) == 0)) {
+            return slot - 1;
+        }
+    }
+}
+
+static void level_slot_insert(topic_trie_t* trie, uint32_t id)
+{
+    uint32_t i = trie->levels[id].hash & trie->level_slot_mask;
+    while (trie->level_slots[i] != 0) {
+        i = (i + 1) & trie->level_slot_mask;
+    }
+    trie->level_slots[i] = id + 1;
+}
+
+static uint32_t level_intern(topic_trie_t* trie, const char* s, size_t len)
+{
+    uint32_t hash = hash_bytes(s, len);
+    uint32_t id = level_find(trie, s, len, hash);
+    if (id != LEVEL_FREE) {
+        return id;
+    }
+    if ((trie->level_count + 1) * 2 > trie->level_slot_mask + 1) {
+        uint32_t slots = (trie->level_slot_mask + 1) * 2;
+        uint32_t* table = calloc(slots, sizeof(*table));
+        if (!table) {
+            return LEVEL_FREE;
+        }
+        free(trie->level_slots);
+        trie->level_slots = table;
+        trie->level_slot_mask = slots - 1;
+        for (uint32_t i = 0; i < trie->level_count; ++i) {
+            level_slot_insert(trie, i);
+        }
+    }
+    if (grow((void**)&trie->levels, &trie->level_cap, trie->level_count + 1, sizeof(level_t)) != 0 ||
+        grow((void**)&trie->level_chars, &trie->level_chars_cap,
+             trie->level_chars_len + (uint32_t)len, 1) != 0) {
+        return LEVEL_FREE;
+    }
+    id = trie->level_count++;
+    level_t* l = &trie->levels[id];
+    l->offset = trie->level_chars_len;
+    l->len = (uint32_t)len;
+    l->hash = hash;
+    if (len) {
+        memcpy(trie->level_chars + l->offset, s, len);
+    }
+    trie->level_chars_len += (uint32_t)len;
+    level_slot_insert(trie, id);
+    return id;
+}
+
+// ---- (parent, level) -> child edges ----------------------------------------
+
+static uint32_t edge_find(const topic_trie_t* trie, uint32_t parent, uint32_t level)
+{
+    for (uint32_t i = hash_edge(parent, level) & trie->edge_mask;; i = (i + 1) & trie->edge_mask) {
+        const edge_t* e = &trie->edges[i];
+        if (e->child == NONE) {
+            return NONE;
+        }
+        if (e->parent == parent && e->level == level) {
+            return e->child;
+        }
+    }
+}
+
+static void edge_place(edge_t* edges, uint32_t mask, const edge_t* e)
+{
+    uint32_t i = hash_edge(e->parent, e->level) & mask;
+    while (edges[i].child != NONE) {
+        i = (i + 1) & mask;
+    }
+    edges[i] = *e;
+}
+
+static int edge_insert(topic_trie_t* trie, uint32_t parent, uint32_t level, uint32_t child)
+{
+    if ((trie->edge_count + 1) * 2 > trie->edge_mask + 1) {
+        uint32_t slots = (trie->edge_mask + 1) * 2;
+        edge_t* table = calloc(slots, sizeof(*table));
+        if (!table) {
+            return -1;
+        }
+        for (uint32_t i = 0; i <= trie->edge_mask; ++i) {
+            if (trie->edges[i].child != NONE) {
+                edge_place(table, slots - 1, &trie->edges[i]);
+            }
+        }
+        free(trie->edges);
+        trie->edges = table;
+        trie->edge_mask = slots - 1;
+    }
+    edge_t e = { parent, level, child };
+    edge_place(trie->edges, trie->edge_mask, &e);
+    trie->edge_count++;
+    return 0;
+}
+
+// Linear-probing delete with backward shift, so lookups never need tombstones.
+static void edge_delete(topic_trie_t* trie, uint32_t parent, uint32_t level)
+{
+    uint32_t mask = trie->edge_mask;
+    uint32_t i = hash_edge(parent, level) & mask;
+    while (trie->edges[i].parent != parent || trie->edges[i].level != level ||
+           trie->edges[i].child == NONE) {
+        i = (i + 1) & mask;
+    }
+    for (uint32_t j = (i + 1) & mask; trie->edges[j].child != NONE; j = (j + 1) & mask) {
+        uint32_t home = hash_edge(trie->edges[j].parent, trie->edges[j].level) & mask;
+        // Move j into the hole at i unless its home slot lies in (i, j]
+        if (((j - home) & mask) >= ((j - i) & mask)) {
+            trie->edges[i] = trie->edges[j];
+            i = j;
+        }
+    }
+    trie->edges[i].child = NONE;
+    trie->edge_count--;
+}
+
+// ---- nodes and subscriber lists --------------------------------------------
+
+static uint32_t node_alloc(topic_trie_t* trie, uint32_t parent, uint32_t level)
+{
+    uint32_t n = trie->node_free;
+    if (n != NONE) {
+        trie->node_free = trie->nodes[n].parent;
+    } else {
+        if (grow((void**)&trie->nodes, &trie->node_cap, trie->node_count + 1, sizeof(node_t)) != 0) {
+            return NONE;
+        }
+        n = trie->node_count++;
+    }
+    node_t* node = &trie->nodes[n];
+    memset(node, 0, sizeof(*node));
+    node->parent = parent;
+    node->level = level;
+    trie->node_live++;
+    return n;
+}
+
+static int sub_push(topic_trie_t* trie, uint32_t* head, uint32_t id)
+{
+    uint32_t s = trie->sub_free;
+    if (s != NONE) {
+        trie->sub_free = trie->subs[s].next;
+    } else {
+        // head may point into the node arena, which is not touched here
+        if (grow((void**)&trie->subs, &trie->sub_cap, trie->sub_count + 1, sizeof(sub_t)) != 0) {
+            return -1;
+        }
+        s = trie->sub_count++;
+    }
+    trie->subs[s].id = id;
+    trie->subs[s].next = *head;
+    *head = s;
+    trie->sub_live++;
+    return 0;
+}
+
+static int sub_unlink(topic_trie_t* trie, uint32_t* head, uint32_t id)
+{
+    for (uint32_t* link = head; *link != NONE; link = &trie->subs[*link].next) {
+        uint32_t s = *link;
+        if (trie->subs[s].id == id) {
+            *link = trie->subs[s].next;
+            trie->subs[s].next = trie->sub_free;
+            trie->sub_free = s;
+            trie->sub_live--;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+// Releases n and its ancestors for as long as they carry nothing.
+static void node_prune(topic_trie_t* trie, uint32_t n)
+{
+    while (n != NONE) {
+        node_t* node = &trie->nodes[n];
+        if (node->subs != NONE || node->hash_subs != NONE || node->children != 0) {
+            return;
+        }
+        uint32_t parent = node->parent;
+        if (node->level == LEVEL_PLUS) {
+            trie->nodes[parent].plus = NONE;
+        } else {
+            edge_delete(trie, parent, node->level);
+        }
+        trie->nodes[parent].children--;
+        node->level = LEVEL_FREE;
+        node->parent = trie->node_free;
+        trie->node_free = n;
+        trie->node_live--;
+        n = parent;
+    }
+}
+
+// ---- public API -------------------------------------------------------------
+
+topic_trie_t* topic_trie_create(void)
+{
+    topic_trie_t* trie = calloc(1, sizeof(*trie));
+    if (!trie) {
+        return NULL;
+    }
+    trie->level_slot_mask = 15;
+    trie->edge_mask = 15;
+    trie->level_slots = calloc(trie->level_slot_mask + 1, sizeof(*trie->level_slots));
+    trie->edges = calloc(trie->edge_mask + 1, sizeof(*trie->edges));
+    // Slot 0 of the subscriber arena is the list terminator
+    if (!trie->level_slots || !trie->edges ||
+        grow((void**)&trie->subs, &trie->sub_cap, 1, sizeof(sub_t)) != 0 ||
+        grow((void**)&trie->nodes, &trie->node_cap, 1, sizeof(node_t)) != 0) {
+        topic_trie_destroy(trie);
+        return NULL;
+    }
+    trie->sub_count = 1;
+    node_alloc(trie, NONE, NONE);
+    return trie;
+}
+
+void topic_trie_destroy(topic_trie_t* trie)
+{
+    if (!trie) {
+        return;
+    }
+    free(trie->nodes);
+    free(trie->levels);
+    free(trie->level_chars);
+    free(trie->level_slots);
+    free(trie->edges);
+    free(trie->subs);
+    free(trie);
+}
+
+// Splits off the level starting at p; returns its length and sets *next to
+// the following level, or NULL when p was the last one.
+static size_t next_level(const char* p, const char** next)
+{
+    size_t len = strcspn(p, "/");
+    *next = p[len] == '/' ? p + len + 1 : NULL;
+    return len;
+}
+
+static int level_is_valid(const char* p, size_t len, int is_last)
+{
+    const char* wild = memchr(p, '+', len);
+    if (!wild) {
+        wild = memchr(p, '#', len);
+    }
+    if (!wild) {
+        return 1;
+    }
+    return len == 1 && (*p == '+' || is_last);
+}
+
+int topic_trie_add(topic_trie_t* trie, const char* filter, uint32_t subscriber)
+{
+    if (!trie || !filter || *filter == '\0') {
+        return -1;
+    }
+    for (const char* p = filter, *next; p; p = next) {
+        size_t len = next_level(p, &next);
+        if (!level_is_valid(p, len, next == NULL)) {
+            return -1;
+        }
+    }
+
+    uint32_t n = 0;
+    for (const char* p = filter, *next; p; p = next) {
+        size_t len = next_level(p, &next);
+        if (len == 1 && *p == '#') {
+            if (sub_push(trie, &trie->nodes[n].hash_subs, subscriber) != 0) {
+                node_prune(trie, n);
+                return -1;
+            }
+            return 0;
+        }
+        uint32_t child;
+        if (len == 1 && *p == '+') {
+            child = trie->nodes[n].plus;
+            if (child == NONE) {
+                child = node_alloc(trie, n, LEVEL_PLUS);
+                if (child == NONE) {
+                    node_prune(trie, n);
+                    return -1;
+                }
+                trie->nodes[n].plus = child;
+                trie->nodes[n].children++;
+            }
+        } else {
+            uint32_t level = level_intern(trie, p, len);
+            if (level == LEVEL_FREE) {
+                node_prune(trie, n);
+                return -1;
+            }
+            child = edge_find(trie, n, level);
+            if (child == NONE) {
+                child = node_alloc(trie, n, level);
+                if (child == NONE || edge_insert(trie, n, level, child) != 0) {
+                    if (child != NONE) {
+                        // Not linked yet; undo the allocation by hand
+                        trie->nodes[child].level = LEVEL_FREE;
+                        trie->nodes[child].parent = trie->node_free;
+                        trie->node_free = child;
+                        trie->node_live--;
+                    }
+                    node_prune(trie, n);
+                    return -1;
+                }
+                trie->nodes[n].children++;
+            }
+        }
+        n = child;
+    }
+    if (sub_push(trie, &trie->nodes[n].subs, subscriber) != 0) {
+        node_prune(trie, n);
+        return -1;
+    }
+    return 0;
+}
+
+int topic_trie_remove(topic_trie_t* trie, const char* filter, uint32_t subscriber)
+{
+    if (!trie || !filter || *filter == '\0') {
+        return -1;
+    }
+    uint32_t n = 0;
+    for (const char* p = filter, *next; p; p = next) {
+        size_t len = next_level(p, &next);
+        if (len == 1 && *p == '#') {
+            if (next != NULL || sub_unlink(trie, &trie->nodes[n].hash_subs, subscriber) != 0) {
+                return -1;
+            }
+            node_prune(trie, n);
+            return 0;
+        }
+        if (len == 1 && *p == '+') {
+            n = trie->nodes[n].plus;
+        } else {
+            uint32_t level = level_find(trie, p, len, hash_bytes(p, len));
+            n = level == LEVEL_FREE ? NONE : edge_find(trie, n, level);
+        }
+        if (n == NONE) {
+            return -1;
+        }
+    }
+    if (sub_unlink(trie, &trie->nodes[n].subs, subscriber) != 0) {
+        return -1;
+    }
+    node_prune(trie, n);
+    return 0;
+}
+
+// Level ids of the first topic levels are resolved once per lookup and shared
+// by every branch that reaches the same depth.
+#define MATCH_CACHED_LEVELS 16
+
+typedef struct {
+    uint32_t* out;
+    size_t max_out;
+    size_t count;
+    uint32_t level_ids[MATCH_CACHED_LEVELS];
+} match_ctx_t;
+
+static void emit(const topic_trie_t* trie, uint32_t s, match_ctx_t* ctx)
+{
+    for (; s != NONE; s = trie->subs[s].next) {
+        if (ctx->count < ctx->max_out) {
+            ctx->out[ctx->count] = trie->subs[s].id;
+        }
+        ctx->count++;
+    }
+}
+
+static void match_node(const topic_trie_t* trie, uint32_t n, const char* p, size_t depth,
+                       match_ctx_t* ctx)
+{
+    const node_t* node = &trie->nodes[n];
+    if (!p) {
+        // "a/#" also matches "a"
+        emit(trie, node->subs, ctx);
+        emit(trie, node->hash_subs, ctx);
+        return;
+    }
+    // Wildcards at the root never match "$SYS"-style topics
+    int wild = !(depth == 0 && *p == '$');
+    if (wild) {
+        emit(trie, node->hash_subs, ctx);
+    }
+    const char* next;
+    size_t len = next_level(p, &next);
+    uint32_t level;
+    if (depth < MATCH_CACHED_LEVELS && ctx->level_ids[depth] != LEVEL_PLUS) {
+        level = ctx->level_ids[depth];
+    } else {
+        level = level_find(trie, p, len, hash_bytes(p, len));
+        if (depth < MATCH_CACHED_LEVELS) {
+            ctx->level_ids[depth] = level;
+        }
+    }
+    if (level != LEVEL_FREE) {
+        uint32_t child = edge_find(trie, n, level);
+        if (child != NONE) {
+            match_node(trie, child, next, depth + 1, ctx);
+        }
+    }
+    if (wild && node->plus != NONE) {
+        match_node(trie, node->plus, next, depth + 1, ctx);
+    }
+}
+
+size_t topic_trie_match(const topic_trie_t* trie, const char* topic,
+                        uint32_t* out, size_t max_out)
+{
+    if (!trie || !topic || *topic == '\0' || strpbrk(topic, "+#")) {
+        return 0;
+    }
+    match_ctx_t ctx;
+    ctx.out = out;
+    ctx.max_out = out ? max_out : 0;
+    ctx.count = 0;
+    for (size_t i = 0; i < MATCH_CACHED_LEVELS; ++i) {
+        ctx.level_ids[i] = LEVEL_PLUS;
+    }
+    match_node(trie, 0, topic, 0, &ctx);
+    return ctx.count;
+}
+
+void topic_trie_get_stats(const topic_trie_t* trie, topic_trie_stats_t* stats)
+{
+    memset(stats, 0, sizeof(*stats));
+    if (!trie) {
+        return;
+    }
+    stats->filters = trie->sub_live;
+    stats->nodes = trie->node_live;
+    stats->levels = trie->level_count;
+    stats->level_bytes = trie->level_chars_len;
+    stats->bytes_used = sizeof(*trie) +
+                        trie->node_live * sizeof(node_t) +
+                        trie->level_count * (sizeof(level_t) + sizeof(uint32_t)) +
+                        trie->level_chars_len +
+                        trie->edge_count * sizeof(edge_t) +
+                        trie->sub_live * sizeof(sub_t);
+    stats->bytes_reserved = sizeof(*trie) +
+                            (size_t)trie->node_cap * sizeof(node_t) +
+                            (size_t)trie->level_cap * sizeof(level_t) +
+                            trie->level_chars_cap +
+                            (size_t)(trie->level_slot_mask + 1) * sizeof(uint32_t) +
+                            (size_t)(trie->edge_mask + 1) * sizeof(edge_t) +
+                            (size_t)trie->sub_cap * sizeof(sub_t);
+}
+
+int topic_filter_matches(const char* filter, const char* topic)
+{
+    if (!filter || !topic || *filter == '\0' || *topic == '\0' || strpbrk(topic, "+#")) {
+        return 0;
+    }
+    if (*topic == '$' && (*filter == '+' || *filter == '#')) {
+        return 0;
+    }
+    const char* f = filter;
+    const char* t = topic;
+    for (;;) {
+        size_t flen = strcspn(f, "/");
+        size_t tlen = strcspn(t, "/");
+        if (flen == 1 && *f == '#') {
+            return 1;
+        }
+        if (!(flen == 1 && *f == '+') && (flen != tlen || memcmp(f, t, flen) != 0)) {
+            return 0;
+        }
+        f += flen;
+        t += tlen;
+        if (*t == '\0') {
+            return *f == '\0' || strcmp(f, "/#") == 0;
+        }
+        if (*f == '\0') {
+            return 0;
+        }
+        f++;
+        t++;
+    }
+}
@@ -0,0 +1,64 @@
+#ifndef TOPIC_TRIE_H
+#define TOPIC_TRIE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// MQTT topic-filter trie used to dispatch parsed messages to subscribers.
+//
+// Filters use the usual MQTT wildcards: '+' matches exactly one level and '#'
+// (last level only) matches the parent level and everything below it. Topics
+// are matched as produced by parse_mqtt_topic(), i.e. "mqtt/home/temp" yields
+// the topic "/home/temp" whose first level is empty, so filters are written
+// the same way ("/home/+").
+//
+// All storage lives in a few flat arenas indexed by uint32_t: level strings
+// are interned once, exact children are found through a single (parent, level)
+// hash table, and '+'/'#' branches hang directly off each node. A lookup costs
+// one level-intern probe plus one edge probe per topic level, independent of
+// the number of subscriptions.
+
+typedef struct topic_trie topic_trie_t;
+
+typedef struct {
+    size_t filters;         // (filter, subscriber) pairs currently stored
+    size_t nodes;           // live trie nodes, including the root
+    size_t levels;          // distinct interned level strings
+    size_t level_bytes;     // bytes used by interned level strings
+    size_t bytes_used;      // bytes occupied by live entries
+    size_t bytes_reserved;  // bytes allocated for all arenas and tables
+} topic_trie_stats_t;
+
+topic_trie_t* topic_trie_create(void);
+void topic_trie_destroy(topic_trie_t* trie);
+
+// Returns 0 on success, -1 on an invalid filter or allocation failure.
+// Adding the same (filter, subscriber) pair twice stores it twice.
+int topic_trie_add(topic_trie_t* trie, const char* filter, uint32_t subscriber);
+
+// Removes one (filter, subscriber) pair. Returns 0 on success, -1 if the pair
+// is not present. Nodes left without subscribers or children are recycled;
+// interned level strings are kept and arenas never shrink until destroy.
+int topic_trie_remove(topic_trie_t* trie, const char* filter, uint32_t subscriber);
+
+// Writes up to max_out matching subscriber ids to out and returns the total
+// number of matches (which may exceed max_out). A subscriber appears once per
+// matching filter. Topics containing wildcards never match.
+size_t topic_trie_match(const topic_trie_t* trie, const char* topic,
+                        uint32_t* out, size_t max_out);
+
+void topic_trie_get_stats(const topic_trie_t* trie, topic_trie_stats_t* stats);
+
+// Reference matcher for a single filter, used for validation and as the
+// linear-scan baseline. Returns 1 if topic matches filter, 0 otherwise.
+int topic_filter_matches(const char* filter, const char* topic);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TOPIC_TRIE_H
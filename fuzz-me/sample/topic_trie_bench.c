@@ -0,0 +1,156 @@
+// Topic trie benchmark: 10k MQTT filters, trie lookup vs. linear matching,
+// add/remove churn and a memory report for sizing on ESP32.
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "topic_trie.h"
+
+#define NUM_FILTERS 10000
+#define NUM_TOPICS 10000
+#define NUM_LINEAR_TOPICS 1000
+#define MAX_NAME 64
+#define MAX_MATCHES 256
+
+static char filters[NUM_FILTERS][MAX_NAME];
+static char topics[NUM_TOPICS][MAX_NAME];
+
+static const char* const measurements[] = { "temperature", "humidity", "status", "battery" };
+
+static uint32_t rng_state = 12345;
+
+static uint32_t rng(void)
+{
+    rng_state = rng_state * 1103515245u + 12345u;
+    return rng_state >> 8;
+}
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Filter mix: 60% exact, 25% single-level '+', 15% multi-level '#'
+static void make_filter(char* out, uint32_t i)
+{
+    uint32_t site = rng() % 100;
+    uint32_t dev = rng() % 100;
+    const char* m = measurements[rng() % 4];
+    uint32_t kind = i % 20;
+    if (kind < 12) {
+        snprintf(out, MAX_NAME, "/site%u/dev%u/%s", site, dev, m);
+    } else if (kind < 15) {
+        snprintf(out, MAX_NAME, "/site%u/+/%s", site, m);
+    } else if (kind < 17) {
+        snprintf(out, MAX_NAME, "/+/dev%u/+", dev);
+    } else {
+        snprintf(out, MAX_NAME, "/site%u/dev%u/#", site, dev);
+    }
+}
+
+static void print_stats(const char* label, const topic_trie_t* trie)
+{
+    topic_trie_stats_t st;
+    topic_trie_get_stats(trie, &st);
+    printf("%s\n", label);
+    printf("  filters:        %zu\n", st.filters);
+    printf("  nodes:          %zu\n", st.nodes);
+    printf("  levels:         %zu (%zu bytes of text)\n", st.levels, st.level_bytes);
+    printf("  bytes used:     %zu (%.1f KiB, %.1f B/filter)\n",
+           st.bytes_used, st.bytes_used / 1024.0,
+           st.filters ? (double)st.bytes_used / st.filters : 0.0);
+    printf("  bytes reserved: %zu (%.1f KiB)\n", st.bytes_reserved, st.bytes_reserved / 1024.0);
+}
+
+int main(void)
+{
+    static uint32_t matches[MAX_MATCHES];
+    size_t filter_text = 0;
+
+    for (uint32_t i = 0; i < NUM_FILTERS; ++i) {
+        make_filter(filters[i], i);
+        filter_text += strlen(filters[i]) + 1;
+    }
+    for (uint32_t i = 0; i < NUM_TOPICS; ++i) {
+        snprintf(topics[i], MAX_NAME, "/site%u/dev%u/%s",
+                 rng() % 100, rng() % 100, measurements[rng() % 4]);
+    }
+
+    topic_trie_t* trie = topic_trie_create();
+    if (!trie) {
+        fprintf(stderr, "Error: allocation failed\n");
+        return 1;
+    }
+
+    double t0 = now_s();
+    for (uint32_t i = 0; i < NUM_FILTERS; ++i) {
+        if (topic_trie_add(trie, filters[i], i) != 0) {
+            fprintf(stderr, "Error: failed to add filter %s\n", filters[i]);
+            return 1;
+        }
+    }
+    double t1 = now_s();
+
+    size_t trie_hits = 0;
+    for (uint32_t i = 0; i < NUM_TOPICS; ++i) {
+        trie_hits += topic_trie_match(trie, topics[i], matches, MAX_MATCHES);
+    }
+    double t2 = now_s();
+
+    size_t linear_hits = 0;
+    for (uint32_t i = 0; i < NUM_LINEAR_TOPICS; ++i) {
+        for (uint32_t f = 0; f < NUM_FILTERS; ++f) {
+            linear_hits += topic_filter_matches(filters[f], topics[i]);
+        }
+    }
+    double t3 = now_s();
+
+    // Cross-check the trie against the reference matcher on the linear subset
+    size_t check_hits = 0;
+    for (uint32_t i = 0; i < NUM_LINEAR_TOPICS; ++i) {
+        check_hits += topic_trie_match(trie, topics[i], NULL, 0);
+    }
+    if (check_hits != linear_hits) {
+        fprintf(stderr, "Error: trie found %zu matches, linear scan %zu\n", check_hits, linear_hits);
+        return 1;
+    }
+
+    double trie_ns = (t2 - t1) / NUM_TOPICS * 1e9;
+    double linear_ns = (t3 - t2) / NUM_LINEAR_TOPICS * 1e9;
+    printf("=== Topic Trie Benchmark (%d filters) ===\n", NUM_FILTERS);
+    printf("add:            %.1f ns/filter\n", (t1 - t0) / NUM_FILTERS * 1e9);
+    printf("trie match:     %.1f ns/topic (%.2f matches/topic)\n",
+           trie_ns, (double)trie_hits / NUM_TOPICS);
+    printf("linear match:   %.1f ns/topic (%.1fx slower)\n", linear_ns, linear_ns / trie_ns);
+    print_stats("memory after add:", trie);
+    printf("  filter strings: %zu bytes (for comparison)\n", filter_text);
+
+    // Churn: drop every other filter and add it back
+    t0 = now_s();
+    for (uint32_t i = 0; i < NUM_FILTERS; i += 2) {
+        if (topic_trie_remove(trie, filters[i], i) != 0) {
+            fprintf(stderr, "Error: failed to remove filter %s\n", filters[i]);
+            return 1;
+        }
+    }
+    t1 = now_s();
+    print_stats("memory after removing half:", trie);
+    for (uint32_t i = 0; i < NUM_FILTERS; i += 2) {
+        topic_trie_add(trie, filters[i], i);
+    }
+    printf("remove:         %.1f ns/filter\n", (t1 - t0) / (NUM_FILTERS / 2) * 1e9);
+    print_stats("memory after re-adding:", trie);
+
+    for (uint32_t i = 0; i < NUM_FILTERS; ++i) {
+        topic_trie_remove(trie, filters[i], i);
+    }
+    print_stats("memory after removing all:", trie);
+
+    topic_trie_destroy(trie);
+    return 0;
+}
@@ -0,0 +1,191 @@
+// Compares an array of structs (std::vector<scan_record>) with
+// refl::soa_vector<scan_record> on filter and aggregate queries over 100k
+// records, the shape of Wi-Fi scan results and sensor sample logs.
+//
+// Build on the host with a compiler that implements P2996 (GCC 16 with
+// -freflection):
+//
+//   cmake -S reflection/host -B build-host -DCMAKE_CXX_COMPILER=g++-16
+//   cmake --build build-host && build-host/soa_bench
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "refl_soa.hpp"
+
+namespace {
+
+// 52 bytes, laid out like a trimmed wifi_ap_record_t
+struct scan_record {
+    uint8_t bssid[6];
+    char ssid[33];
+    uint8_t primary;
+    int8_t rssi;
+    uint8_t authmode;
+    uint16_t beacon_interval;
+    uint32_t timestamp;
+    float noise_floor;
+};
+
+constexpr std::size_t kRecords = 100000;
+constexpr int kRounds = 20;
+
+// Keeps results observable so the loops are not optimized away
+volatile double g_sink;
+
+// Best of kRounds, in ns per record
+template <typename Fn>
+double ns_per_record(Fn&& fn)
+{
+    double best = 0;
+    for (int r = 0; r < kRounds; ++r) {
+        auto t0 = std::chrono::steady_clock::now();
+        g_sink = fn();
+        auto t1 = std::chrono::steady_clock::now();
+        double ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / kRecords;
+        if (r == 0 || ns < best) {
+            best = ns;
+        }
+    }
+    return best;
+}
+
+void compare(const char* label, double aos, double soa)
+{
+    printf("%-34s AoS %6.2f ns/rec  SoA %6.2f ns/rec  (%.1fx)\n", label, aos, soa, aos / soa);
+}
+
+} // namespace
+
+int main()
+{
+    std::vector<scan_record> aos(kRecords);
+    std::mt19937 rng(1);
+    for (std::size_t i = 0; i < kRecords; ++i) {
+        scan_record& r = aos[i];
+        for (uint8_t& b : r.bssid) {
+            b = static_cast<uint8_t>(rng());
+        }
+        snprintf(r.ssid, sizeof(r.ssid), "ap-%06zu", i);
+        r.primary = static_cast<uint8_t>(1 + rng() % 13);
+        r.rssi = static_cast<int8_t>(-30 - static_cast<int>(rng() % 65));
+        r.authmode = static_cast<uint8_t>(rng() % 8);
+        r.beacon_interval = 100;
+        r.timestamp = static_cast<uint32_t>(i * 10);
+        r.noise_floor = -95.0f + static_cast<float>(rng() % 100) / 10.0f;
+    }
+
+    refl::soa_vector<scan_record> soa;
+    soa.reserve(kRecords);
+    for (const scan_record& r : aos) {
+        soa.push_back(r);
+    }
+    scan_record mid = soa.get(kRecords / 2);
+    if (std::memcmp(&aos[kRecords / 2], &mid, sizeof(mid)) != 0) {
+        printf("gather mismatch\n");
+        return 1;
+    }
+
+    printf("%zu records, %zu bytes each\n", kRecords, sizeof(scan_record));
+
+    // Filter: one byte column
+    compare("count(rssi >= -70)",
+        ns_per_record([&] {
+            std::size_t n = 0;
+            for (const scan_record& r : aos) {
+                n += r.rssi >= -70;
+            }
+            return static_cast<double>(n);
+        }),
+        ns_per_record([&] {
+            std::size_t n = 0;
+            for (int8_t rssi : soa.column<^^scan_record::rssi>()) {
+                n += rssi >= -70;
+            }
+            return static_cast<double>(n);
+        }));
+
+    // Aggregate: one float column
+    compare("mean(noise_floor)",
+        ns_per_record([&] {
+            float sum = 0;
+            for (const scan_record& r : aos) {
+                sum += r.noise_floor;
+            }
+            return static_cast<double>(sum) / kRecords;
+        }),
+        ns_per_record([&] {
+            float sum = 0;
+            for (float nf : soa.column<^^scan_record::noise_floor>()) {
+                sum += nf;
+            }
+            return static_cast<double>(sum) / kRecords;
+        }));
+
+    // Filter on two columns, aggregate a third
+    compare("max(rssi) where ch 6 && auth != 0",
+        ns_per_record([&] {
+            int best = -128;
+            for (const scan_record& r : aos) {
+                if (r.primary == 6 && r.authmode != 0 && r.rssi > best) {
+                    best = r.rssi;
+                }
+            }
+            return static_cast<double>(best);
+        }),
+        ns_per_record([&] {
+            auto primary = soa.column<^^scan_record::primary>();
+            auto authmode = soa.column<^^scan_record::authmode>();
+            auto rssi = soa.column<^^scan_record::rssi>();
+            int best = -128;
+            for (std::size_t i = 0; i < rssi.size(); ++i) {
+                int v = primary[i] == 6 && authmode[i] != 0 ? rssi[i] : -128;
+                best = v > best ? v : best;
+            }
+            return static_cast<double>(best);
+        }));
+
+    // Through the proxies: same query as above, written like the AoS loop
+    compare("  same, via soa_vector iterators",
+        ns_per_record([&] {
+            int best = -128;
+            for (const scan_record& r : aos) {
+                if (r.primary == 6 && r.authmode != 0 && r.rssi > best) {
+                    best = r.rssi;
+                }
+            }
+            return static_cast<double>(best);
+        }),
+        ns_per_record([&] {
+            int best = -128;
+            for (auto r : soa) {
+                if (r.primary == 6 && r.authmode != 0 && r.rssi > best) {
+                    best = r.rssi;
+                }
+            }
+            return static_cast<double>(best);
+        }));
+
+    // Whole records: SoA has to gather every member
+    compare("sum(timestamp) of gathered records",
+        ns_per_record([&] {
+            double sum = 0;
+            for (std::size_t i = 0; i < kRecords; ++i) {
+                scan_record r = aos[i];
+                sum += r.timestamp + r.ssid[3];
+            }
+            return sum;
+        }),
+        ns_per_record([&] {
+            double sum = 0;
+            for (std::size_t i = 0; i < kRecords; ++i) {
+                scan_record r = soa.get(i);
+                sum += r.timestamp + r.ssid[3];
+            }
+            return sum;
+        }));
+    return 0;
+}
@@ -0,0 +1,46 @@
+/* Shared helpers of the reflection utilities
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+#pragma once
+
+#include <meta>
+#include <cstddef>
+#include <type_traits>
+
+namespace refl {
+
+template <typename T>
+consteval std::size_t member_count()
+{
+    constexpr auto ctx = std::meta::access_context::current();
+    return std::meta::nonstatic_data_members_of(^^T, ctx).size();
+}
+
+namespace detail {
+
+// Position of m among the non-static data members of its class
+template <std::meta::info m>
+consteval std::size_t member_index()
+{
+    constexpr auto ctx = std::meta::access_context::current();
+    auto members = std::meta::nonstatic_data_members_of(std::meta::parent_of(m), ctx);
+    for (std::size_t i = 0; i < members.size(); ++i) {
+        if (members[i] == m) {
+            return i;
+        }
+    }
+    return members.size();
+}
+
+template <typename E>
+inline constexpr bool is_byte_element = std::is_same_v<E, char> || std::is_same_v<E, unsigned char> ||
+                                        std::is_same_v<E, signed char>;
+
+} // namespace detail
+
+} // namespace refl
@@ -0,0 +1,213 @@
+/* Reflection-driven field-level diff and delta encoding
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+#pragma once
+
+#include <meta>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <expected>
+#include <span>
+#include <type_traits>
+
+#include "refl_common.hpp"
+#include "refl_serialize.hpp"
+
+/*
+ * refl::diff() compares two instances member by member and returns a mask
+ * with bit i set when the i-th non-static data member differs. Nested structs
+ * count as one member. refl::apply() copies the masked members.
+ *
+ * For NVS or the telemetry link the delta is encoded as:
+ *
+ *   delta := format_version schema_id(2 bytes, LE) varint(mask) value*
+ *
+ * with one value per set bit, in member order, encoded like the value part of
+ * a refl::serialize() field (so members that became zero are sent too). A
+ * nested struct member is sent whole, as its length-prefixed field list. The
+ * mask indexes members by position, so a delta is only valid for the exact
+ * layout it was made from: schema_id<T>() hashes member names, types and
+ * order, and apply_delta() rejects deltas from any other layout with
+ * codec_error::bad_version. Use serialize() for data that has to survive
+ * firmware updates.
+ *
+ * Everything is unrolled at compile time and nothing is allocated.
+ */
+namespace refl {
+
+// Smallest unsigned type with one bit per member of T
+template <typename T>
+using field_mask = std::conditional_t<member_count<T>() <= 8, std::uint8_t,
+                   std::conditional_t<member_count<T>() <= 16, std::uint16_t,
+                   std::conditional_t<member_count<T>() <= 32, std::uint32_t, std::uint64_t>>>;
+
+namespace detail {
+
+template <typename T>
+consteval std::uint32_t schema_hash(std::uint32_t h)
+{
+    constexpr auto ctx = std::meta::access_context::current();
+    auto mix = [&h](std::uint64_t v) {
+        for (int i = 0; i < 8; ++i, v >>= 8) {
+            h ^= static_cast<std::uint8_t>(v);
+            h *= 16777619u;
+        }
+    };
+    template for (constexpr auto m :
+        [: std::meta::reflect_constant_array(
+            std::meta::nonstatic_data_members_of(^^T, ctx)) :])
+    {
+        using member_type = [: std::meta::type_of(m) :];
+        mix(field_id(std::meta::identifier_of(m)));
+        mix(sizeof(member_type));
+        mix(wire_of<member_type>());
+        if constexpr (is_struct_member<member_type>) {
+            h = schema_hash<member_type>(h);
+        }
+    }
+    return h;
+}
+
+// Bitwise for floats and arrays, so NaN equals itself and -0.0 differs from 0.0
+template <typename M>
+bool member_equal(const M& a, const M& b)
+{
+    if constexpr (std::is_array_v<M> || std::is_floating_point_v<M>) {
+        return std::memcmp(&a, &b, sizeof(M)) == 0;
+    } else if constexpr (is_scalar_member<M>) {
+        return a == b;
+    } else {
+        constexpr auto ctx = std::meta::access_context::current();
+        template for (constexpr auto m :
+            [: std::meta::reflect_constant_array(
+                std::meta::nonstatic_data_members_of(^^M, ctx)) :])
+        {
+            using member_type = [: std::meta::type_of(m) :];
+            if (!member_equal<member_type>(a.[:m:], b.[:m:])) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+} // namespace detail
+
+// Identifies the member layout of T in deltas
+template <typename T>
+consteval std::uint16_t schema_id()
+{
+    std::uint32_t h = detail::schema_hash<T>(2166136261u);
+    return static_cast<std::uint16_t>((h >> 16) ^ h);
+}
+
+// Bit i is set when member i differs between a and b
+template <typename T>
+field_mask<T> diff(const T& a, const T& b)
+{
+    static_assert(member_count<T>() <= 64, "refl::diff: more than 64 members");
+    constexpr auto ctx = std::meta::access_context::current();
+    field_mask<T> mask = 0;
+    template for (constexpr auto m :
+        [: std::meta::reflect_constant_array(
+            std::meta::nonstatic_data_members_of(^^T, ctx)) :])
+    {
+        using member_type = [: std::meta::type_of(m) :];
+        if (!detail::member_equal<member_type>(a.[:m:], b.[:m:])) {
+            mask |= field_mask<T>{1} << detail::member_index<m>();
+        }
+    }
+    return mask;
+}
+
+// Copies the members selected by mask from src to dst
+template <typename T>
+void apply(T& dst, const T& src, field_mask<T> mask)
+{
+    constexpr auto ctx = std::meta::access_context::current();
+    template for (constexpr auto m :
+        [: std::meta::reflect_constant_array(
+            std::meta::nonstatic_data_members_of(^^T, ctx)) :])
+    {
+        using member_type = [: std::meta::type_of(m) :];
+        if (mask >> detail::member_index<m>() & 1) {
+            if constexpr (std::is_array_v<member_type>) {
+                std::memcpy(&dst.[:m:], &src.[:m:], sizeof(dst.[:m:]));
+            } else {
+                dst.[:m:] = src.[:m:];
+            }
+        }
+    }
+}
+
+// Encodes the members in which now differs from old. An empty mask is still
+// a valid (4 byte) delta.
+template <typename T>
+std::expected<std::size_t, codec_error> encode_delta(const T& old, const T& now,
+                                                     std::span<std::uint8_t> out)
+{
+    constexpr auto ctx = std::meta::access_context::current();
+    field_mask<T> mask = diff(old, now);
+    detail::writer w{out};
+    w.byte(format_version);
+    w.fixed(schema_id<T>(), 2);
+    w.varint(mask);
+    template for (constexpr auto m :
+        [: std::meta::reflect_constant_array(
+            std::meta::nonstatic_data_members_of(^^T, ctx)) :])
+    {
+        if (mask >> detail::member_index<m>() & 1) {
+            using member_type = [: std::meta::type_of(m) :];
+            detail::encode_payload<member_type>(w, now.[:m:]);
+        }
+    }
+    if (w.overflowed()) {
+        return std::unexpected(codec_error::buffer_too_small);
+    }
+    return w.size();
+}
+
+// Applies a delta from encode_delta(). obj is only modified if the whole
+// delta is valid.
+template <typename T>
+std::expected<field_mask<T>, codec_error> apply_delta(T& obj, std::span<const std::uint8_t> in)
+{
+    constexpr auto ctx = std::meta::access_context::current();
+    detail::reader r{in};
+    std::uint64_t version, schema, mask;
+    if (!r.fixed(version, 1) || !r.fixed(schema, 2)) {
+        return std::unexpected(codec_error::truncated);
+    }
+    if (version != format_version || schema != schema_id<T>()) {
+        return std::unexpected(codec_error::bad_version);
+    }
+    constexpr std::uint64_t valid_bits = member_count<T>() == 64 ? ~std::uint64_t{0}
+                                       : (std::uint64_t{1} << member_count<T>()) - 1;
+    if (!r.varint(mask) || (mask & ~valid_bits)) {
+        return std::unexpected(codec_error::malformed);
+    }
+    T updated = obj;
+    bool ok = true;
+    template for (constexpr auto m :
+        [: std::meta::reflect_constant_array(
+            std::meta::nonstatic_data_members_of(^^T, ctx)) :])
+    {
+        if (ok && (mask >> detail::member_index<m>() & 1)) {
+            ok = detail::decode_payload<m>(r, updated);
+        }
+    }
+    if (!ok || !r.done()) {
+        return std::unexpected(codec_error::malformed);
+    }
+    obj = updated;
+    return static_cast<field_mask<T>>(mask);
+}
+
+} // namespace refl
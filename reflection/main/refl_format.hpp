@@ -0,0 +1,441 @@
+/* Reflection-driven text and JSON formatting into a fixed buffer
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+#pragma once
+
+#include <meta>
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "refl_common.hpp"
+
+/*
+ * refl::to_text() and refl::to_json() format a struct into a caller-provided
+ * buffer. Member names, separators and the struct header are built at compile
+ * time into static strings, so at run time each member costs one memcpy of
+ * its prefix plus the value. Numbers, MAC addresses and hex are formatted by
+ * hand: no iostreams, no printf, no heap and no locks, so the functions can
+ * be used from ISR-safe logging (as long as the code itself is reachable,
+ * i.e. in IRAM if the flash cache may be disabled).
+ *
+ * Value formatting:
+ *   bool                        true / false
+ *   integers                    decimal (uint8_t/int8_t as numbers, not chars)
+ *   enums                       text: enumerator name, or the number if the
+ *                               value has none; JSON: the number
+ *   float, double               up to 6 decimals; nan/inf as null in JSON
+ *   uint8_t[6]                  MAC address, aa:bb:cc:dd:ee:ff
+ *   other char/uint8_t arrays   string up to the first NUL (escaped in JSON)
+ *   other arrays                [a, b, ...]
+ *   nested structs              { a = 1, b = 2 } / {"a":1,"b":2}
+ *
+ * The output is always NUL-terminated (unless the buffer is empty). If it did
+ * not fit, the result reports truncated and the buffer holds a prefix.
+ * max_text_size<T>() and max_json_size<T>() are compile-time bounds, NUL
+ * included, for sizing a buffer that always fits.
+ */
+namespace refl {
+
+struct format_result {
+    std::size_t size;       // characters written, without the NUL
+    bool truncated;
+};
+
+namespace detail {
+
+enum class text_style {
+    text,           // top level of to_text(), one member per line
+    text_nested,    // structs inside a to_text() struct, one line
+    json,
+};
+
+class text_sink {
+public:
+    explicit text_sink(std::span<char> out) noexcept : out_(out) {}
+
+    void put(char c) noexcept
+    {
+        if (len_ + 1 < out_.size()) {
+            out_[len_++] = c;
+        } else {
+            truncated_ = true;
+        }
+    }
+
+    void put(std::string_view s) noexcept
+    {
+        std::size_t room = out_.empty() ? 0 : out_.size() - 1 - len_;
+        std::size_t n = std::min(room, s.size());
+        if (n) {
+            std::memcpy(out_.data() + len_, s.data(), n);
+        }
+        len_ += n;
+        if (n < s.size()) {
+            truncated_ = true;
+        }
+    }
+
+    format_result finish() noexcept
+    {
+        if (!out_.empty()) {
+            out_[len_] = '\0';
+        }
+        return { len_, truncated_ };
+    }
+
+private:
+    std::span<char> out_;
+    std::size_t len_ = 0;
+    bool truncated_ = false;
+};
+
+inline constexpr char hex_digits[] = "0123456789abcdef";
+
+inline constexpr auto digit_pairs = [] {
+    std::array<char, 200> table{};
+    for (int i = 0; i < 100; ++i) {
+        table[2 * i] = static_cast<char>('0' + i / 10);
+        table[2 * i + 1] = static_cast<char>('0' + i % 10);
+    }
+    return table;
+}();
+
+// Two digits per division
+inline void put_uint(text_sink& out, std::uint64_t v) noexcept
+{
+    char buf[20];
+    std::size_t pos = sizeof(buf);
+    while (v >= 100) {
+        std::size_t i = static_cast<std::size_t>(v % 100) * 2;
+        v /= 100;
+        buf[--pos] = digit_pairs[i + 1];
+        buf[--pos] = digit_pairs[i];
+    }
+    if (v >= 10) {
+        buf[--pos] = digit_pairs[v * 2 + 1];
+        buf[--pos] = digit_pairs[v * 2];
+    } else {
+        buf[--pos] = static_cast<char>('0' + v);
+    }
+    out.put(std::string_view(buf + pos, sizeof(buf) - pos));
+}
+
+inline void put_int(text_sink& out, std::int64_t v) noexcept
+{
+    if (v < 0) {
+        out.put('-');
+        put_uint(out, 0 - static_cast<std::uint64_t>(v));
+    } else {
+        put_uint(out, static_cast<std::uint64_t>(v));
+    }
+}
+
+inline void put_hex_byte(text_sink& out, std::uint8_t b) noexcept
+{
+    char hex[2] = { hex_digits[b >> 4], hex_digits[b & 0xf] };
+    out.put(std::string_view(hex, 2));
+}
+
+// Fixed notation with up to 6 decimals; exponent notation from 1e18 up
+inline void put_double(text_sink& out, double v, bool json) noexcept
+{
+    if (v != v || v - v != 0) {     // nan or inf
+        out.put(json ? "null" : v != v ? "nan" : v < 0 ? "-inf" : "inf");
+        return;
+    }
+    if (v < 0) {
+        out.put('-');
+        v = -v;
+    }
+    int exponent = 0;
+    if (v >= 1e18) {
+        while (v >= 10) {
+            v /= 10;
+            ++exponent;
+        }
+    }
+    auto whole = static_cast<std::uint64_t>(v);
+    auto frac = static_cast<std::uint64_t>((v - static_cast<double>(whole)) * 1e6 + 0.5);
+    if (frac >= 1000000) {
+        ++whole;
+        frac -= 1000000;
+    }
+    put_uint(out, whole);
+    if (frac) {
+        char digits[7] = { '.' };
+        int n = 6;
+        while (frac % 10 == 0) {
+            frac /= 10;
+            --n;
+        }
+        for (int i = n; i > 0; --i, frac /= 10) {
+            digits[i] = static_cast<char>('0' + frac % 10);
+        }
+        out.put(std::string_view(digits, static_cast<std::size_t>(n) + 1));
+    }
+    if (exponent) {
+        out.put('e');
+        put_uint(out, static_cast<std::uint64_t>(exponent));
+    }
+}
+
+inline void put_json_string(text_sink& out, const char* s, std::size_t n) noexcept
+{
+    out.put('"');
+    std::size_t run = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        auto c = static_cast<unsigned char>(s[i]);
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+        out.put(std::string_view(s + run, i - run));
+        run = i + 1;
+        if (c == '"' || c == '\\') {
+            out.put('\\');
+            out.put(static_cast<char>(c));
+        } else {
+            out.put("\\u00");
+            put_hex_byte(out, c);
+        }
+    }
+    out.put(std::string_view(s + run, n - run));
+    out.put('"');
+}
+
+template <typename E>
+std::string_view enum_name(E v) noexcept
+{
+    template for (constexpr auto e :
+        [: std::meta::reflect_constant_array(std::meta::enumerators_of(^^E)) :])
+    {
+        if (v == [:e:]) {
+            constexpr std::string_view name = std::meta::identifier_of(e);
+            return name;
+        }
+    }
+    return {};
+}
+
+// Member name with its separator, e.g. ", \n\tchannel = " or ",\"channel\":"
+template <text_style S, std::meta::info m>
+consteval std::string_view member_prefix()
+{
+    constexpr auto ctx = std::meta::access_context::current();
+    bool first = std::meta::nonstatic_data_members_of(std::meta::parent_of(m), ctx)[0] == m;
+    std::string s;
+    if (S == text_style::json) {
+        s = first ? "\"" : ",\"";
+        s += std::meta::identifier_of(m);
+        s += "\":";
+    } else {
+        s = first ? "" : S == text_style::text ? ", \n\t" : ", ";
+        s += std::meta::identifier_of(m);
+        s += " = ";
+    }
+    return std::string_view(std::define_static_string(s), s.size());
+}
+
+template <typename T>
+consteval std::string_view text_header()
+{
+    std::string s(std::meta::identifier_of(^^T));
+    s += " \n{\t";
+    return std::string_view(std::define_static_string(s), s.size());
+}
+
+template <text_style S, typename T>
+void format_fields(text_sink& out, const T& obj) noexcept;
+
+template <text_style S, typename M>
+void format_value(text_sink& out, const M& v) noexcept
+{
+    constexpr bool json = S == text_style::json;
+    if constexpr (std::is_same_v<M, bool>) {
+        out.put(v ? "true" : "false");
+    } else if constexpr (std::is_enum_v<M>) {
+        std::string_view name = json ? std::string_view{} : enum_name(v);
+        if (!name.empty()) {
+            out.put(name);
+        } else {
+            format_value<S>(out, static_cast<std::underlying_type_t<M>>(v));
+        }
+    } else if constexpr (std::is_floating_point_v<M>) {
+        put_double(out, static_cast<double>(v), json);
+    } else if constexpr (std::is_signed_v<M>) {
+        put_int(out, static_cast<std::int64_t>(v));
+    } else if constexpr (std::is_integral_v<M>) {
+        put_uint(out, static_cast<std::uint64_t>(v));
+    } else if constexpr (std::is_array_v<M>) {
+        using element_type = std::remove_extent_t<M>;
+        constexpr std::size_t n = std::extent_v<M>;
+        if constexpr (std::is_same_v<element_type, std::uint8_t> && n == 6) {
+            if (json) {
+                out.put('"');
+            }
+            for (std::size_t i = 0; i < n; ++i) {
+                if (i) {
+                    out.put(':');
+                }
+                put_hex_byte(out, v[i]);
+            }
+            if (json) {
+                out.put('"');
+            }
+        } else if constexpr (is_byte_element<element_type>) {
+            auto s = reinterpret_cast<const char*>(v);
+            std::size_t len = 0;
+            while (len < n && s[len] != '\0') {
+                ++len;
+            }
+            if (json) {
+                put_json_string(out, s, len);
+            } else {
+                out.put('"');
+                out.put(std::string_view(s, len));
+                out.put('"');
+            }
+        } else {
+            out.put('[');
+            for (std::size_t i = 0; i < n; ++i) {
+                if (i) {
+                    out.put(json ? "," : ", ");
+                }
+                format_value<S == text_style::text ? text_style::text_nested : S>(out, v[i]);
+            }
+            out.put(']');
+        }
+    } else {
+        static_assert(std::is_class_v<M>, "refl::to_text/to_json: unsupported member type");
+        out.put(json ? "{" : "{ ");
+        format_fields<json ? text_style::json : text_style::text_nested>(out, v);
+        out.put(json ? "}" : " }");
+    }
+}
+
+template <text_style S, typename T>
+void format_fields(text_sink& out, const T& obj) noexcept
+{
+    constexpr auto ctx = std::meta::access_context::current();
+    template for (constexpr auto m :
+        [: std::meta::reflect_constant_array(
+            std::meta::nonstatic_data_members_of(^^T, ctx)) :])
+    {
+        constexpr std::string_view prefix = member_prefix<S, m>();
+        using member_type = [: std::meta::type_of(m) :];
+        out.put(prefix);
+        format_value<S == text_style::text ? text_style::text_nested : S, member_type>(out, obj.[:m:]);
+    }
+}
+
+template <text_style S, typename T>
+consteval std::size_t max_formatted_fields();
+
+// Longest output of format_value<S, M>() for any value
+template <text_style S, typename M>
+consteval std::size_t max_formatted_size()
+{
+    constexpr bool json = S == text_style::json;
+    if constexpr (std::is_same_v<M, bool>) {
+        return 5;
+    } else if constexpr (std::is_enum_v<M>) {
+        std::size_t n = max_formatted_size<S, std::underlying_type_t<M>>();
+        if (!json) {
+            for (auto e : std::meta::enumerators_of(^^M)) {
+                n = std::max(n, std::meta::identifier_of(e).size());
+            }
+        }
+        return n;
+    } else if constexpr (std::is_floating_point_v<M>) {
+        // Sign, up to 19 integer digits (values below 1e18, rounded up) and
+        // 7 for the decimals; the exponent form is shorter
+        return 27;
+    } else if constexpr (std::is_integral_v<M>) {
+        return std::numeric_limits<M>::digits10 + 1 + (std::is_signed_v<M> ? 1 : 0);
+    } else if constexpr (std::is_array_v<M>) {
+        using element_type = std::remove_extent_t<M>;
+        constexpr std::size_t n = std::extent_v<M>;
+        if constexpr (std::is_same_v<element_type, std::uint8_t> && n == 6) {
+            return 17 + (json ? 2 : 0);
+        } else if constexpr (is_byte_element<element_type>) {
+            // Every byte may be a \u00XX escape in JSON
+            return 2 + n * (json ? 6 : 1);
+        } else {
+            constexpr text_style inner = S == text_style::text ? text_style::text_nested : S;
+            return 2 + n * max_formatted_size<inner, element_type>() + (n - 1) * (json ? 1 : 2);
+        }
+    } else {
+        constexpr text_style inner = json ? text_style::json : text_style::text_nested;
+        return (json ? 2 : 4) + max_formatted_fields<inner, M>();
+    }
+}
+
+template <text_style S, typename T>
+consteval std::size_t max_formatted_fields()
+{
+    constexpr auto ctx = std::meta::access_context::current();
+    std::size_t size = 0;
+    template for (constexpr auto m :
+        [: std::meta::reflect_constant_array(
+            std::meta::nonstatic_data_members_of(^^T, ctx)) :])
+    {
+        using member_type = [: std::meta::type_of(m) :];
+        constexpr text_style inner = S == text_style::text ? text_style::text_nested : S;
+        size += member_prefix<S, m>().size() + max_formatted_size<inner, member_type>();
+    }
+    return size;
+}
+
+} // namespace detail
+
+// Buffer size, NUL included, that to_text() output always fits
+template <typename T>
+consteval std::size_t max_text_size()
+{
+    return detail::text_header<T>().size() +
+           detail::max_formatted_fields<detail::text_style::text, T>() + 2 + 1;
+}
+
+// Same for to_json()
+template <typename T>
+consteval std::size_t max_json_size()
+{
+    return 2 + detail::max_formatted_fields<detail::text_style::json, T>() + 1;
+}
+
+// "wifi_sta_config_t \n{\tssid = "myssid", \n\tchannel = 0, ... }"
+template <typename T>
+format_result to_text(const T& obj, std::span<char> out) noexcept
+{
+    detail::text_sink sink{out};
+    constexpr std::string_view header = detail::text_header<T>();
+    sink.put(header);
+    detail::format_fields<detail::text_style::text>(sink, obj);
+    sink.put(" }");
+    return sink.finish();
+}
+
+// {"ssid":"myssid","channel":0,...}
+template <typename T>
+format_result to_json(const T& obj, std::span<char> out) noexcept
+{
+    detail::text_sink sink{out};
+    sink.put('{');
+    detail::format_fields<detail::text_style::json>(sink, obj);
+    sink.put('}');
+    return sink.finish();
+}
+
+} // namespace refl
@@ -0,0 +1,451 @@
+/* Reflection-driven JSON binding into a struct
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+#pragma once
+
+#include <meta>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string_view>
+#include <type_traits>
+
+#include "json_scan.h"
+#include "json_schema.hpp"
+#include "refl_common.hpp"
+
+/*
+ * refl::parse_into() reads a JSON object into a struct in one pass. It is the
+ * reflection counterpart of json_schema::make_schema() from the IoT parser
+ * sample: the key table is built at compile time from the member identifiers
+ * instead of hand-written bind() lists, and the payload is walked with the same
+ * json_scan_next() scanner and converted with the same json_number.h parsers.
+ *
+ * Each key is hashed once into the compile-time perfect hash of T's member
+ * names and compared with the one candidate; the value then goes straight into
+ * the member. No strings are built and nothing is allocated: strings are
+ * unescaped directly into the destination array.
+ *
+ * Value conversion (the inverse of refl::to_json()):
+ *   bool                        true / false
+ *   integers, bit-fields        JSON integers, range-checked (also against
+ *                               the bit-field width)
+ *   float, double               JSON numbers
+ *   enums                       the number, or the enumerator name as string
+ *   uint8_t[6]                  "aa:bb:cc:dd:ee:ff"
+ *   other char/uint8_t arrays   string; the rest of the array is zeroed. char
+ *                               arrays keep room for the NUL, uint8_t arrays
+ *                               (e.g. ssid) may be filled completely
+ *   other arrays                [a, b, ...] of scalars, at most the extent;
+ *                               missing elements are zeroed
+ *   nested structs              objects, bound recursively
+ *
+ * Members whose key is absent or null keep their value and are reported in
+ * missing; members with a value that does not fit are left unchanged and
+ * reported in invalid. Keys without a member are counted (and the first one
+ * is kept) but otherwise ignored.
+ */
+namespace refl {
+
+struct parse_result {
+    std::uint64_t seen = 0;         // bit i: member i was assigned
+    std::uint64_t invalid = 0;      // bit i: member i was present with an unusable value
+    std::uint64_t missing = 0;      // bit i: member i was not in the object
+    std::uint32_t unknown = 0;      // keys without a member, nested objects included
+    std::string_view first_unknown; // first of them, as in the payload
+    bool ok = false;                // false if the payload is not a well-formed object
+};
+
+namespace detail {
+
+template <typename T>
+consteval auto member_names()
+{
+    constexpr auto ctx = std::meta::access_context::current();
+    std::array<std::string_view, member_count<T>()> names{};
+    std::size_t i = 0;
+    template for (constexpr auto m :
+        [: std::meta::reflect_constant_array(
+            std::meta::nonstatic_data_members_of(^^T, ctx)) :])
+    {
+        names[i++] = std::meta::identifier_of(m);
+    }
+    return names;
+}
+
+template <typename T>
+inline constexpr auto member_names_v = member_names<T>();
+
+template <typename T>
+inline constexpr json_schema::perfect_hash<member_count<T>()> member_hash_v{member_names_v<T>};
+
+template <typename T>
+int member_lookup(std::string_view key) noexcept
+{
+    int i = member_hash_v<T>.candidate(key);
+    return i >= 0 && member_names_v<T>[static_cast<std::size_t>(i)] == key ? i : -1;
+}
+
+inline int hex_value(char c) noexcept
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    c = static_cast<char>(c | 0x20);
+    return c >= 'a' && c <= 'f' ? c - 'a' + 10 : -1;
+}
+
+inline int hex4(const char* p) noexcept
+{
+    int v = 0;
+    for (int i = 0; i < 4; ++i) {
+        int d = hex_value(p[i]);
+        if (d < 0) {
+            return -1;
+        }
+        v = v << 4 | d;
+    }
+    return v;
+}
+
+// Unescapes the string value of m into out[0, cap) and returns its length,
+// or -1 if it is malformed or longer than cap
+inline long unescape_into(const json_member_t& m, unsigned char* out, std::size_t cap) noexcept
+{
+    const char* p = m.value.ptr;
+    const char* end = p + m.value.len;
+    if (!m.escaped) {
+        if (m.value.len > cap) {
+            return -1;
+        }
+        if (m.value.len) {
+            std::memcpy(out, p, m.value.len);
+        }
+        return static_cast<long>(m.value.len);
+    }
+    std::size_t len = 0;
+    while (p < end) {
+        std::uint32_t cp = static_cast<unsigned char>(*p++);
+        bool raw = cp != '\\';
+        if (!raw) {
+            if (p == end) {
+                return -1;
+            }
+            switch (*p++) {
+            case '"':  cp = '"';  break;
+            case '\\': cp = '\\'; break;
+            case '/':  cp = '/';  break;
+            case 'b':  cp = '\b'; break;
+            case 'f':  cp = '\f'; break;
+            case 'n':  cp = '\n'; break;
+            case 'r':  cp = '\r'; break;
+            case 't':  cp = '\t'; break;
+            case 'u': {
+                int hi = end - p >= 4 ? hex4(p) : -1;
+                if (hi < 0) {
+                    return -1;
+                }
+                p += 4;
+                cp = static_cast<std::uint32_t>(hi);
+                if (cp >= 0xd800 && cp < 0xdc00) {
+                    int lo = end - p >= 6 && p[0] == '\\' && p[1] == 'u' ? hex4(p + 2) : -1;
+                    if (lo < 0xdc00 || lo >= 0xe000) {
+                        return -1;
+                    }
+                    p += 6;
+                    cp = 0x10000 + ((cp - 0xd800) << 10) + (static_cast<std::uint32_t>(lo) - 0xdc00);
+                } else if (cp >= 0xdc00 && cp < 0xe000) {
+                    return -1;
+                }
+                break;
+            }
+            default:
+                return -1;
+            }
+        }
+        // UTF-8 encode escaped code points; raw bytes are copied as they are
+        unsigned char utf8[4] = { static_cast<unsigned char>(cp) };
+        std::size_t n = 1;
+        if (!raw && cp >= 0x10000) {
+            utf8[0] = static_cast<unsigned char>(0xf0 | cp >> 18);
+            utf8[1] = static_cast<unsigned char>(0x80 | (cp >> 12 & 0x3f));
+            utf8[2] = static_cast<unsigned char>(0x80 | (cp >> 6 & 0x3f));
+            utf8[3] = static_cast<unsigned char>(0x80 | (cp & 0x3f));
+            n = 4;
+        } else if (!raw && cp >= 0x800) {
+            utf8[0] = static_cast<unsigned char>(0xe0 | cp >> 12);
+            utf8[1] = static_cast<unsigned char>(0x80 | (cp >> 6 & 0x3f));
+            utf8[2] = static_cast<unsigned char>(0x80 | (cp & 0x3f));
+            n = 3;
+        } else if (!raw && cp >= 0x80) {
+            utf8[0] = static_cast<unsigned char>(0xc0 | cp >> 6);
+            utf8[1] = static_cast<unsigned char>(0x80 | (cp & 0x3f));
+            n = 2;
+        }
+        if (cap - len < n) {
+            return -1;
+        }
+        std::memcpy(out + len, utf8, n);
+        len += n;
+    }
+    return static_cast<long>(len);
+}
+
+// "aa:bb:cc:dd:ee:ff", either case
+inline bool parse_mac(const json_member_t& m, std::uint8_t (&out)[6]) noexcept
+{
+    if (m.type != JSON_SCAN_STRING || m.escaped || m.value.len != 17) {
+        return false;
+    }
+    std::uint8_t mac[6];
+    for (std::size_t i = 0; i < 6; ++i) {
+        const char* p = m.value.ptr + 3 * i;
+        int hi = hex_value(p[0]);
+        int lo = hex_value(p[1]);
+        if (hi < 0 || lo < 0 || (i < 5 && p[2] != ':')) {
+            return false;
+        }
+        mac[i] = static_cast<std::uint8_t>(hi << 4 | lo);
+    }
+    std::memcpy(out, mac, sizeof(mac));
+    return true;
+}
+
+template <typename E>
+bool enum_from_name(std::string_view name, E& out) noexcept
+{
+    template for (constexpr auto e :
+        [: std::meta::reflect_constant_array(std::meta::enumerators_of(^^E)) :])
+    {
+        constexpr std::string_view id = std::meta::identifier_of(e);
+        if (name == id) {
+            out = [:e:];
+            return true;
+        }
+    }
+    return false;
+}
+
+template <typename T>
+void bind_fields(json_scanner_t& scanner, T& obj, parse_result& res) noexcept;
+
+template <typename M>
+bool bind_value(const json_member_t& m, M& out, parse_result& res) noexcept;
+
+// Scalar JSON values inside [...]: numbers and literals, as json_scan_next()
+// would classify them
+inline int scan_element(const char*& p, const char* end, json_member_t& elem) noexcept
+{
+    const char* v = p;
+    if (json_scan_literal(p, end, "true", 4)) {
+        elem.type = JSON_SCAN_TRUE;
+        p += 4;
+    } else if (json_scan_literal(p, end, "false", 5)) {
+        elem.type = JSON_SCAN_FALSE;
+        p += 5;
+    } else {
+        while (p < end && ((*p >= '0' && *p <= '9') || *p == '-' || *p == '+' ||
+                           *p == '.' || *p == 'e' || *p == 'E')) {
+            p++;
+        }
+        if (p == v) {
+            return -1;
+        }
+        elem.type = JSON_SCAN_NUMBER;
+    }
+    elem.value.ptr = v;
+    elem.value.len = static_cast<std::size_t>(p - v);
+    elem.escaped = 0;
+    return 1;
+}
+
+template <typename E, std::size_t N>
+bool bind_array(const json_member_t& m, E (&out)[N], parse_result& res) noexcept
+{
+    if (m.type != JSON_SCAN_ARRAY) {
+        return false;
+    }
+    E values[N] = {};
+    const char* end = m.value.ptr + m.value.len - 1;   // at the closing ']'
+    const char* p = json_scan_ws(m.value.ptr + 1, end);
+    std::size_t n = 0;
+    while (p < end) {
+        json_member_t elem;
+        if (n == N || (n && *p++ != ',')) {
+            return false;
+        }
+        p = json_scan_ws(p, end);
+        if (scan_element(p, end, elem) < 0 || !bind_value(elem, values[n], res)) {
+            return false;
+        }
+        ++n;
+        p = json_scan_ws(p, end);
+    }
+    std::memcpy(out, values, sizeof(values));
+    return true;
+}
+
+template <typename M>
+bool bind_value(const json_member_t& m, M& out, parse_result& res) noexcept
+{
+    if constexpr (std::is_enum_v<M>) {
+        if (m.type == JSON_SCAN_STRING) {
+            return !m.escaped && enum_from_name(std::string_view(m.value.ptr, m.value.len), out);
+        }
+        std::underlying_type_t<M> v;
+        if (!json_schema::assign(v, m)) {
+            return false;
+        }
+        out = static_cast<M>(v);
+        return true;
+    } else if constexpr (std::is_arithmetic_v<M>) {
+        return json_schema::assign(out, m);
+    } else if constexpr (std::is_array_v<M>) {
+        using element_type = std::remove_extent_t<M>;
+        constexpr std::size_t n = std::extent_v<M>;
+        if constexpr (std::is_same_v<element_type, std::uint8_t> && n == 6) {
+            return parse_mac(m, out);
+        } else if constexpr (is_byte_element<element_type>) {
+            // char arrays are C strings and keep their NUL
+            constexpr std::size_t cap = std::is_same_v<element_type, char> ? n - 1 : n;
+            unsigned char bytes[n];
+            long len = m.type == JSON_SCAN_STRING ? unescape_into(m, bytes, cap) : -1;
+            if (len < 0) {
+                return false;
+            }
+            std::memset(bytes + len, 0, n - static_cast<std::size_t>(len));
+            std::memcpy(out, bytes, n);
+            return true;
+        } else {
+            return bind_array(m, out, res);
+        }
+    } else {
+        static_assert(std::is_class_v<M>, "refl::parse_into: unsupported member type");
+        if (m.type != JSON_SCAN_OBJECT) {
+            return false;
+        }
+        // Bound into a copy so a bad nested member leaves out untouched
+        M nested = out;
+        parse_result inner;
+        json_scanner_t scanner;
+        json_scan_init(&scanner, m.value.ptr, m.value.len);
+        bind_fields(scanner, nested, inner);
+        res.unknown += inner.unknown;
+        if (res.first_unknown.empty()) {
+            res.first_unknown = inner.first_unknown;
+        }
+        if (!inner.ok || inner.invalid) {
+            return false;
+        }
+        out = nested;
+        return true;
+    }
+}
+
+// Bit-fields cannot be bound by reference: the value goes through a copy and
+// is checked against the field width
+template <std::meta::info m, typename T>
+bool bind_member(const json_member_t& jm, T& obj, parse_result& res) noexcept
+{
+    using member_type = [: std::meta::type_of(m) :];
+    if constexpr (std::meta::is_bit_field(m)) {
+        constexpr std::size_t bits = std::meta::bit_size_of(m);
+        member_type v = obj.[:m:];
+        if (!bind_value(jm, v, res)) {
+            return false;
+        }
+        if constexpr (std::is_integral_v<member_type> && !std::is_same_v<member_type, bool>) {
+            if constexpr (bits < std::numeric_limits<std::make_unsigned_t<member_type>>::digits) {
+                if constexpr (std::is_signed_v<member_type>) {
+                    constexpr auto limit = member_type{1} << (bits - 1);
+                    if (v < -limit || v >= limit) {
+                        return false;
+                    }
+                } else if (v >> bits) {
+                    return false;
+                }
+            }
+        }
+        obj.[:m:] = v;
+        return true;
+    } else {
+        return bind_value(jm, obj.[:m:], res);
+    }
+}
+
+// Compilers lower the unrolled index comparisons to a jump table
+template <typename T>
+bool dispatch(std::size_t index, const json_member_t& jm, T& obj, parse_result& res) noexcept
+{
+    constexpr auto ctx = std::meta::access_context::current();
+    template for (constexpr auto m :
+        [: std::meta::reflect_constant_array(
+            std::meta::nonstatic_data_members_of(^^T, ctx)) :])
+    {
+        if (index == member_index<m>()) {
+            return bind_member<m>(jm, obj, res);
+        }
+    }
+    return false;
+}
+
+template <typename T>
+void bind_fields(json_scanner_t& scanner, T& obj, parse_result& res) noexcept
+{
+    static_assert(member_count<T>() > 0 && member_count<T>() <= 64,
+                  "refl::parse_into: 1 to 64 members");
+    json_member_t m;
+    int rc;
+    while ((rc = json_scan_next(&scanner, &m)) == 1) {
+        int i = member_lookup<T>(std::string_view(m.key.ptr, m.key.len));
+        if (i < 0) {
+            if (res.unknown++ == 0) {
+                res.first_unknown = std::string_view(m.key.ptr, m.key.len);
+            }
+            continue;
+        }
+        std::uint64_t bit = std::uint64_t{1} << i;
+        if (m.type == JSON_SCAN_NULL) {
+            continue;
+        }
+        if (dispatch(static_cast<std::size_t>(i), m, obj, res)) {
+            res.seen |= bit;
+            res.invalid &= ~bit;
+        } else {
+            res.invalid |= bit;
+        }
+    }
+    res.ok = rc == 0;
+}
+
+} // namespace detail
+
+// Binds the members of the JSON object in json to obj
+template <typename T>
+parse_result parse_into(json_span_t json, T& obj) noexcept
+{
+    parse_result res;
+    json_scanner_t scanner;
+    json_scan_init(&scanner, json.ptr, json.len);
+    detail::bind_fields(scanner, obj, res);
+
+    constexpr std::size_t n = member_count<T>();
+    constexpr std::uint64_t all = n == 64 ? ~std::uint64_t{0} : (std::uint64_t{1} << n) - 1;
+    res.missing = all & ~(res.seen | res.invalid);
+    return res;
+}
+
+template <typename T>
+parse_result parse_into(std::string_view json, T& obj) noexcept
+{
+    return parse_into(json_span_t{ json.data(), json.size() }, obj);
+}
+
+} // namespace refl
@@ -0,0 +1,651 @@
+/* Reflection-driven binary encoding of plain config structs
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+#pragma once
+
+#include <meta>
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <expected>
+#include <iterator>
+#include <span>
+#include <string_view>
+#include <type_traits>
+
+/*
+ * Encoding (all integers are LEB128 varints unless noted):
+ *
+ *   message := format_version field*
+ *   field   := tag value              tag = field_id << 3 | wire type
+ *
+ *   wire 0 (varint)   bool, enums, integers and bit-fields; signed values are
+ *                     zigzag-encoded
+ *   wire 1 (fixed64)  double, little-endian
+ *   wire 2 (bytes)    length + data: fixed arrays are written raw (native
+ *                     layout, little-endian on all ESP32 targets) with trailing
+ *                     zero bytes dropped; nested structs are a field list
+ *   wire 5 (fixed32)  float, little-endian
+ *
+ * The field ID is a 16-bit hash of the member name, so members can be
+ * reordered, added or removed without breaking stored data: unknown IDs and
+ * IDs whose wire type changed are skipped, missing members stay
+ * zero-initialized. Members that are zero are not written at all (-0.0 is
+ * not zero here: floats compare bitwise). Renaming a member changes its ID.
+ *
+ * Supported member types: arithmetic types, enums, bit-fields, arrays of
+ * those and nested structs of the same. Nothing is allocated; the encoder
+ * writes straight into the caller's buffer and max_encoded_size<T>() gives a
+ * compile-time bound for sizing it. The decoder converts bool and enum values
+ * instead of copying bytes, and rejects enum values the type cannot hold.
+ */
+namespace refl {
+
+inline constexpr std::uint8_t format_version = 1;
+
+enum class codec_error {
+    buffer_too_small,
+    truncated,
+    bad_version,
+    malformed,
+};
+
+namespace detail {
+
+enum wire_type : std::uint8_t {
+    wire_varint = 0,
+    wire_fixed64 = 1,
+    wire_bytes = 2,
+    wire_fixed32 = 5,
+};
+
+consteval std::uint32_t field_id(std::string_view name)
+{
+    std::uint32_t h = 2166136261u;      // FNV-1a
+    for (char c : name) {
+        h ^= static_cast<unsigned char>(c);
+        h *= 16777619u;
+    }
+    h = (h >> 16) ^ (h & 0xffff);
+    return h ? h : 1;
+}
+
+template <typename T>
+consteval bool field_ids_unique()
+{
+    constexpr auto ctx = std::meta::access_context::current();
+    auto members = std::meta::nonstatic_data_members_of(^^T, ctx);
+    for (std::size_t i = 0; i < members.size(); ++i) {
+        for (std::size_t j = i + 1; j < members.size(); ++j) {
+            if (field_id(std::meta::identifier_of(members[i])) ==
+                field_id(std::meta::identifier_of(members[j]))) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+template <typename M>
+inline constexpr bool is_scalar_member = std::is_arithmetic_v<M> || std::is_enum_v<M>;
+
+template <typename M>
+inline constexpr bool is_struct_member = std::is_class_v<M> && std::is_aggregate_v<M>;
+
+template <typename M>
+consteval std::uint8_t wire_of()
+{
+    if constexpr (std::is_same_v<M, float>) {
+        return wire_fixed32;
+    } else if constexpr (std::is_same_v<M, double>) {
+        return wire_fixed64;
+    } else if constexpr (is_scalar_member<M>) {
+        return wire_varint;
+    } else {
+        return wire_bytes;
+    }
+}
+
+constexpr std::size_t varint_size(std::uint64_t v)
+{
+    std::size_t n = 1;
+    for (; v >= 0x80; v >>= 7) {
+        ++n;
+    }
+    return n;
+}
+
+template <typename T>
+consteval std::size_t max_fields_size();
+
+template <typename M>
+consteval std::size_t max_value_size()
+{
+    if constexpr (std::is_same_v<M, float>) {
+        return 4;
+    } else if constexpr (std::is_same_v<M, double>) {
+        return 8;
+    } else if constexpr (is_scalar_member<M>) {
+        return (sizeof(M) * 8 + 6) / 7;
+    } else if constexpr (std::is_array_v<M>) {
+        return varint_size(sizeof(M)) + sizeof(M);
+    } else {
+        return varint_size(max_fields_size<M>()) + max_fields_size<M>();
+    }
+}
+
+template <typename T>
+consteval std::size_t max_fields_size()
+{
+    constexpr auto ctx = std::meta::access_context::current();
+    std::size_t size = 0;
+    template for (constexpr auto m :
+        [: std::meta::reflect_constant_array(
+            std::meta::nonstatic_data_members_of(^^T, ctx)) :])
+    {
+        using member_type = [: std::meta::type_of(m) :];
+        size += varint_size(std::uint64_t{field_id(std::meta::identifier_of(m))} << 3);
+        size += max_value_size<member_type>();
+    }
+    return size;
+}
+
+// Writes into out while it fits and counts the bytes either way, so an empty
+// span gives the encoded size
+class writer {
+public:
+    constexpr explicit writer(std::span<std::uint8_t> out) : out_(out) {}
+
+    constexpr void byte(std::uint8_t b)
+    {
+        if (pos_ < out_.size()) {
+            out_[pos_] = b;
+        }
+        ++pos_;
+    }
+
+    constexpr void varint(std::uint64_t v)
+    {
+        for (; v >= 0x80; v >>= 7) {
+            byte(static_cast<std::uint8_t>(v) | 0x80);
+        }
+        byte(static_cast<std::uint8_t>(v));
+    }
+
+    constexpr void fixed(std::uint64_t v, std::size_t bytes)
+    {
+        for (std::size_t i = 0; i < bytes; ++i, v >>= 8) {
+            byte(static_cast<std::uint8_t>(v));
+        }
+    }
+
+    void raw(const void* data, std::size_t n)
+    {
+        if (pos_ + n <= out_.size()) {
+            std::memcpy(out_.data() + pos_, data, n);
+        }
+        pos_ += n;
+    }
+
+    constexpr std::size_t size() const { return pos_; }
+    constexpr bool overflowed() const { return pos_ > out_.size(); }
+
+private:
+    std::span<std::uint8_t> out_;
+    std::size_t pos_ = 0;
+};
+
+class reader {
+public:
+    constexpr explicit reader(std::span<const std::uint8_t> in) : in_(in) {}
+
+    constexpr bool done() const { return pos_ == in_.size(); }
+
+    constexpr bool varint(std::uint64_t& v)
+    {
+        v = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7) {
+            if (pos_ == in_.size()) {
+                return false;
+            }
+            std::uint8_t b = in_[pos_++];
+            v |= std::uint64_t{b & 0x7fu} << shift;
+            if (!(b & 0x80)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    constexpr bool fixed(std::uint64_t& v, std::size_t bytes)
+    {
+        if (in_.size() - pos_ < bytes) {
+            return false;
+        }
+        v = 0;
+        for (std::size_t i = 0; i < bytes; ++i) {
+            v |= std::uint64_t{in_[pos_++]} << (8 * i);
+        }
+        return true;
+    }
+
+    constexpr bool bytes(std::span<const std::uint8_t>& out)
+    {
+        std::uint64_t len;
+        if (!varint(len) || len > in_.size() - pos_) {
+            return false;
+        }
+        out = in_.subspan(pos_, static_cast<std::size_t>(len));
+        pos_ += static_cast<std::size_t>(len);
+        return true;
+    }
+
+    constexpr bool skip(std::uint8_t wire)
+    {
+        std::uint64_t v;
+        std::span<const std::uint8_t> b;
+        switch (wire) {
+        case wire_varint:
+            return varint(v);
+        case wire_fixed64:
+            return fixed(v, 8);
+        case wire_fixed32:
+            return fixed(v, 4);
+        case wire_bytes:
+            return bytes(b);
+        default:
+            return false;
+        }
+    }
+
+private:
+    std::span<const std::uint8_t> in_;
+    std::size_t pos_ = 0;
+};
+
+template <typename M>
+constexpr std::uint64_t to_varint(M v)
+{
+    if constexpr (std::is_enum_v<M>) {
+        return to_varint(static_cast<std::underlying_type_t<M>>(v));
+    } else if constexpr (std::is_signed_v<M>) {
+        auto s = static_cast<std::int64_t>(v);
+        return (static_cast<std::uint64_t>(s) << 1) ^ static_cast<std::uint64_t>(s >> 63);
+    } else {
+        return static_cast<std::uint64_t>(v);
+    }
+}
+
+template <typename M>
+constexpr M from_varint(std::uint64_t v)
+{
+    if constexpr (std::is_enum_v<M>) {
+        return static_cast<M>(from_varint<std::underlying_type_t<M>>(v));
+    } else if constexpr (std::is_same_v<M, bool>) {
+        return v != 0;
+    } else if constexpr (std::is_signed_v<M>) {
+        return static_cast<M>(static_cast<std::int64_t>(v >> 1) ^ -static_cast<std::int64_t>(v & 1));
+    } else {
+        return static_cast<M>(v);
+    }
+}
+
+// Number of bytes of an array up to and including the last non-zero one
+template <typename M>
+std::size_t trimmed_size(const M& arr)
+{
+    auto bytes = reinterpret_cast<const unsigned char*>(&arr);
+    std::size_t n = sizeof(M);
+    while (n > 0 && bytes[n - 1] == 0) {
+        --n;
+    }
+    return n;
+}
+
+// Zero values are left out of a message. Floats compare bitwise so -0.0
+// keeps its sign. Nested structs are zero when fields_size() is 0.
+template <typename M>
+bool is_zero(const M& v)
+{
+    if constexpr (std::is_same_v<M, float>) {
+        return std::bit_cast<std::uint32_t>(v) == 0;
+    } else if constexpr (std::is_same_v<M, double>) {
+        return std::bit_cast<std::uint64_t>(v) == 0;
+    } else if constexpr (is_scalar_member<M>) {
+        return v == M{};
+    } else {
+        return trimmed_size(v) == 0;
+    }
+}
+
+// Encoded size of the value part of a non-zero scalar or array member,
+// without the tag
+template <typename M>
+std::size_t payload_size(const M& v)
+{
+    static_assert(is_scalar_member<M> || std::is_array_v<M>,
+                  "refl::serialize: unsupported member type (pointer, union or non-aggregate)");
+    if constexpr (std::is_same_v<M, float>) {
+        return 4;
+    } else if constexpr (std::is_same_v<M, double>) {
+        return 8;
+    } else if constexpr (is_scalar_member<M>) {
+        return varint_size(to_varint(v));
+    } else {
+        std::size_t n = trimmed_size(v);
+        return varint_size(n) + n;
+    }
+}
+
+// Encoded size of the field list of obj, 0 if every member is zero. Visits
+// each nested member once.
+template <typename T>
+std::size_t fields_size(const T& obj)
+{
+    constexpr auto ctx = std::meta::access_context::current();
+    std::size_t size = 0;
+    template for (constexpr auto m :
+        [: std::meta::reflect_constant_array(
+            std::meta::nonstatic_data_members_of(^^T, ctx)) :])
+    {
+        constexpr std::size_t tag_size =
+            varint_size(std::uint64_t{field_id(std::meta::identifier_of(m))} << 3);
+        using member_type = [: std::meta::type_of(m) :];
+        const member_type& v = obj.[:m:];
+        if constexpr (is_struct_member<member_type>) {
+            std::size_t n = fields_size(v);
+            if (n) {
+                size += tag_size + varint_size(n) + n;
+            }
+        } else if (!is_zero(v)) {
+            size += tag_size + payload_size(v);
+        }
+    }
+    return size;
+}
+
+template <typename T>
+void encode_fields(writer& w, const T& obj);
+
+// The value part of a field, without the tag. A nested struct is its field
+// list behind a length prefix, which is 0 for an all-zero struct (deltas send
+// those; encode_value() leaves them out).
+template <typename M>
+void encode_payload(writer& w, const M& v)
+{
+    if constexpr (std::is_same_v<M, float>) {
+        w.fixed(std::bit_cast<std::uint32_t>(v), 4);
+    } else if constexpr (std::is_same_v<M, double>) {
+        w.fixed(std::bit_cast<std::uint64_t>(v), 8);
+    } else if constexpr (is_scalar_member<M>) {
+        w.varint(to_varint(v));
+    } else if constexpr (std::is_array_v<M>) {
+        using element_type = std::remove_all_extents_t<M>;
+        static_assert(is_scalar_member<element_type>,
+                      "refl::serialize: arrays must hold arithmetic or enum elements");
+        std::size_t n = trimmed_size(v);
+        w.varint(n);
+        w.raw(&v, n);
+    } else {
+        static_assert(is_struct_member<M>,
+                      "refl::serialize: unsupported member type (pointer, union or non-aggregate)");
+        w.varint(fields_size(v));
+        encode_fields(w, v);
+    }
+}
+
+template <typename M>
+void encode_value(writer& w, std::uint32_t id, const M& v)
+{
+    if constexpr (is_struct_member<M>) {
+        // Sized once: the size is both the zero test and the length prefix
+        std::size_t n = fields_size(v);
+        if (n) {
+            w.varint(std::uint64_t{id} << 3 | wire_bytes);
+            w.varint(n);
+            encode_fields(w, v);
+        }
+    } else if (!is_zero(v)) {
+        w.varint(std::uint64_t{id} << 3 | wire_of<M>());
+        encode_payload(w, v);
+    }
+}
+
+template <typename T>
+void encode_fields(writer& w, const T& obj)
+{
+    static_assert(field_ids_unique<T>(),
+                  "refl::serialize: two member names hash to the same field ID");
+    constexpr auto ctx = std::meta::access_context::current();
+    template for (constexpr auto m :
+        [: std::meta::reflect_constant_array(
+            std::meta::nonstatic_data_members_of(^^T, ctx)) :])
+    {
+        constexpr std::uint32_t id = field_id(std::meta::identifier_of(m));
+        using member_type = [: std::meta::type_of(m) :];
+        // Bit-fields bind to the reference as a temporary copy
+        encode_value<member_type>(w, id, obj.[:m:]);
+    }
+}
+
+// Values a decoded enum may take: those that fit the bits its enumerators
+// need, which is the whole range of an enum without a fixed underlying type
+// ([dcl.enum]) and holds any OR of flag enumerators. Converting anything else
+// to such an enum is undefined; enums with a fixed underlying type get the
+// same check and treat other values as corrupt input.
+struct enum_range {
+    std::int64_t lo;
+    std::int64_t hi;
+};
+
+template <typename E>
+consteval enum_range enum_range_of()
+{
+    std::uint64_t bits = 0;
+    bool negative = false;
+    for (auto e : std::meta::enumerators_of(^^E)) {
+        auto v = static_cast<std::int64_t>(std::meta::extract<E>(e));
+        negative |= v < 0;
+        bits |= static_cast<std::uint64_t>(v < 0 ? ~v : v);
+    }
+    std::uint64_t mask = 0;
+    while (mask < bits) {
+        mask = mask << 1 | 1;
+    }
+    auto hi = static_cast<std::int64_t>(std::min<std::uint64_t>(mask, INT64_MAX));
+    return { negative ? -hi - 1 : 0, hi };
+}
+
+template <typename E>
+constexpr bool enum_in_range(std::underlying_type_t<E> raw)
+{
+    constexpr enum_range range = enum_range_of<E>();
+    if constexpr (std::is_signed_v<std::underlying_type_t<E>>) {
+        return raw >= range.lo && raw <= range.hi;
+    } else {
+        return raw <= static_cast<std::uint64_t>(range.hi);
+    }
+}
+
+// Bool and enum array elements are converted one at a time rather than
+// copied: the input is untrusted and not every byte pattern is a valid value
+// of those types. A trailing element cut short by zero trimming is
+// zero-extended.
+template <typename E>
+bool decode_elements(std::span<const std::uint8_t> data, E* out)
+{
+    for (std::size_t i = 0; i * sizeof(E) < data.size(); ++i) {
+        std::uint8_t bytes[sizeof(E)] = {};
+        std::size_t off = i * sizeof(E);
+        std::memcpy(bytes, data.data() + off, std::min(sizeof(E), data.size() - off));
+        if constexpr (std::is_same_v<E, bool>) {
+            out[i] = std::any_of(std::begin(bytes), std::end(bytes), [](std::uint8_t b) { return b != 0; });
+        } else {
+            auto raw = std::bit_cast<std::underlying_type_t<E>>(bytes);
+            if (!enum_in_range<E>(raw)) {
+                return false;
+            }
+            out[i] = static_cast<E>(raw);
+        }
+    }
+    return true;
+}
+
+template <typename T>
+bool decode_fields(reader& r, T& obj);
+
+// Reads the value part of member m and assigns the whole member: arrays and
+// nested structs are reset first, so bytes or fields left out by the encoder
+// end up zero. Returns false on malformed input.
+template <std::meta::info m, typename T>
+bool decode_payload(reader& r, T& obj)
+{
+    using member_type = [: std::meta::type_of(m) :];
+    std::uint64_t v;
+    if constexpr (std::is_same_v<member_type, float>) {
+        if (!r.fixed(v, 4)) {
+            return false;
+        }
+        obj.[:m:] = std::bit_cast<float>(static_cast<std::uint32_t>(v));
+    } else if constexpr (std::is_same_v<member_type, double>) {
+        if (!r.fixed(v, 8)) {
+            return false;
+        }
+        obj.[:m:] = std::bit_cast<double>(v);
+    } else if constexpr (is_scalar_member<member_type>) {
+        if (!r.varint(v)) {
+            return false;
+        }
+        if constexpr (std::is_enum_v<member_type>) {
+            if (!enum_in_range<member_type>(from_varint<std::underlying_type_t<member_type>>(v))) {
+                return false;
+            }
+        }
+        obj.[:m:] = from_varint<member_type>(v);
+    } else if constexpr (std::is_array_v<member_type>) {
+        std::span<const std::uint8_t> data;
+        if (!r.bytes(data)) {
+            return false;
+        }
+        using element_type = std::remove_all_extents_t<member_type>;
+        std::size_t n = std::min(data.size(), sizeof(member_type));
+        std::memset(&obj.[:m:], 0, sizeof(member_type));
+        if constexpr (std::is_same_v<element_type, bool> || std::is_enum_v<element_type>) {
+            if (!decode_elements(data.first(n), reinterpret_cast<element_type*>(&obj.[:m:]))) {
+                return false;
+            }
+        } else {
+            std::memcpy(&obj.[:m:], data.data(), n);
+        }
+    } else {
+        std::span<const std::uint8_t> data;
+        if (!r.bytes(data)) {
+            return false;
+        }
+        reader nested{data};
+        member_type value{};
+        if (!decode_fields(nested, value)) {
+            return false;
+        }
+        obj.[:m:] = value;
+    }
+    return true;
+}
+
+// A wire type that does not match the member is skipped like an unknown field
+template <std::meta::info m, typename T>
+bool decode_member(reader& r, std::uint8_t wire, T& obj)
+{
+    using member_type = [: std::meta::type_of(m) :];
+    if (wire != wire_of<member_type>()) {
+        return r.skip(wire);
+    }
+    return decode_payload<m>(r, obj);
+}
+
+template <typename T>
+bool decode_fields(reader& r, T& obj)
+{
+    constexpr auto ctx = std::meta::access_context::current();
+    while (!r.done()) {
+        std::uint64_t tag;
+        if (!r.varint(tag)) {
+            return false;
+        }
+        auto id = static_cast<std::uint32_t>(tag >> 3);
+        auto wire = static_cast<std::uint8_t>(tag & 7);
+        bool known = false;
+        bool ok = true;
+        template for (constexpr auto m :
+            [: std::meta::reflect_constant_array(
+                std::meta::nonstatic_data_members_of(^^T, ctx)) :])
+        {
+            constexpr std::uint32_t member_id = field_id(std::meta::identifier_of(m));
+            if (id == member_id) {
+                known = true;
+                ok = decode_member<m>(r, wire, obj);
+            }
+        }
+        if (!ok || (!known && !r.skip(wire))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace detail
+
+// Upper bound of serialize() output for any value of T
+template <typename T>
+consteval std::size_t max_encoded_size()
+{
+    return 1 + detail::max_fields_size<T>();
+}
+
+// Exact serialize() output size for obj
+template <typename T>
+std::size_t encoded_size(const T& obj)
+{
+    return 1 + detail::fields_size(obj);
+}
+
+// Encodes obj into out and returns the number of bytes written
+template <typename T>
+std::expected<std::size_t, codec_error> serialize(const T& obj, std::span<std::uint8_t> out)
+{
+    detail::writer w{out};
+    w.byte(format_version);
+    detail::encode_fields(w, obj);
+    if (w.overflowed()) {
+        return std::unexpected(codec_error::buffer_too_small);
+    }
+    return w.size();
+}
+
+// Decodes a value written by serialize(), possibly by an older or newer
+// layout of T
+template <typename T>
+std::expected<T, codec_error> deserialize(std::span<const std::uint8_t> in)
+{
+    if (in.empty()) {
+        return std::unexpected(codec_error::truncated);
+    }
+    if (in[0] != format_version) {
+        return std::unexpected(codec_error::bad_version);
+    }
+    T obj{};
+    detail::reader r{in.subspan(1)};
+    if (!detail::decode_fields(r, obj)) {
+        return std::unexpected(codec_error::malformed);
+    }
+    return obj;
+}
+
+} // namespace refl
@@ -0,0 +1,328 @@
+/* Reflection-generated struct-of-arrays container
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+#pragma once
+
+#include <meta>
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <new>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "refl_common.hpp"
+
+/*
+ * refl::soa_vector<T> stores a sequence of T as one contiguous array per
+ * member of T ("columns") instead of one array of T. A loop that reads only
+ * rssi out of a 60 byte scan record then streams 1 byte per record through
+ * the cache instead of 60, and the column is a plain array the compiler can
+ * vectorize.
+ *
+ *   refl::soa_vector<wifi_ap_record_t> aps;
+ *   aps.push_back(record);
+ *   for (auto ap : aps) {                  // ap.rssi is an int8_t&
+ *       ap.rssi -= 3;
+ *   }
+ *   std::span<int8_t> rssi = aps.column<^^wifi_ap_record_t::rssi>();
+ *   wifi_ap_record_t copy = aps.get(0);
+ *
+ * operator[] and the iterators return proxies: aggregates generated with
+ * define_aggregate() that hold one reference per member, named like the
+ * members of T. Whole records are moved with get(i), which gathers the
+ * columns into a T, and set(i, value), which scatters one. Bit-fields of T
+ * are stored as their declared type, so they can be referenced like any other
+ * member.
+ *
+ * All columns live in one allocation, each aligned to column_alignment.
+ * Members must be trivially copyable; new elements are zero-filled.
+ */
+namespace refl {
+
+template <typename T>
+class soa_vector {
+    static constexpr auto members = std::define_static_array(
+        std::meta::nonstatic_data_members_of(^^T, std::meta::access_context::current()));
+    static constexpr std::size_t N = members.size();
+
+    template <bool Const>
+    static consteval std::vector<std::meta::info> proxy_members()
+    {
+        std::vector<std::meta::info> specs;
+        for (std::meta::info m : members) {
+            std::meta::info type = std::meta::type_of(m);
+            if (Const) {
+                type = std::meta::add_const(type);
+            }
+            specs.push_back(std::meta::data_member_spec(std::meta::add_lvalue_reference(type),
+                                                        { .name = std::meta::identifier_of(m) }));
+        }
+        return specs;
+    }
+
+    static consteval std::array<std::size_t, N> member_sizes()
+    {
+        std::array<std::size_t, N> sizes{};
+        for (std::size_t i = 0; i < N; ++i) {
+            sizes[i] = std::meta::size_of(std::meta::type_of(members[i]));
+        }
+        return sizes;
+    }
+
+    static constexpr std::array<std::size_t, N> sizes = member_sizes();
+
+public:
+    static constexpr std::size_t column_alignment = 64;
+
+    struct reference;
+    struct const_reference;
+    consteval {
+        std::meta::define_aggregate(^^reference, proxy_members<false>());
+        std::meta::define_aggregate(^^const_reference, proxy_members<true>());
+    }
+
+    template <bool Const>
+    class basic_iterator {
+    public:
+        using owner_type = std::conditional_t<Const, const soa_vector, soa_vector>;
+        using iterator_concept = std::random_access_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using reference = std::conditional_t<Const, soa_vector::const_reference, soa_vector::reference>;
+
+        basic_iterator() = default;
+        basic_iterator(owner_type* v, std::size_t i) : v_(v), i_(i) {}
+        operator basic_iterator<true>() const requires (!Const) { return { v_, i_ }; }
+
+        reference operator*() const { return (*v_)[i_]; }
+        reference operator[](difference_type n) const { return (*v_)[i_ + n]; }
+
+        basic_iterator& operator++() { ++i_; return *this; }
+        basic_iterator operator++(int) { auto it = *this; ++i_; return it; }
+        basic_iterator& operator--() { --i_; return *this; }
+        basic_iterator operator--(int) { auto it = *this; --i_; return it; }
+        basic_iterator& operator+=(difference_type n) { i_ += n; return *this; }
+        basic_iterator& operator-=(difference_type n) { i_ -= n; return *this; }
+        friend basic_iterator operator+(basic_iterator it, difference_type n) { return it += n; }
+        friend basic_iterator operator+(difference_type n, basic_iterator it) { return it += n; }
+        friend basic_iterator operator-(basic_iterator it, difference_type n) { return it -= n; }
+        friend difference_type operator-(const basic_iterator& a, const basic_iterator& b)
+        {
+            return static_cast<difference_type>(a.i_) - static_cast<difference_type>(b.i_);
+        }
+        friend bool operator==(const basic_iterator& a, const basic_iterator& b) { return a.i_ == b.i_; }
+        friend auto operator<=>(const basic_iterator& a, const basic_iterator& b) { return a.i_ <=> b.i_; }
+
+    private:
+        owner_type* v_ = nullptr;
+        std::size_t i_ = 0;
+    };
+
+    using value_type = T;
+    using size_type = std::size_t;
+    using iterator = basic_iterator<false>;
+    using const_iterator = basic_iterator<true>;
+
+    soa_vector() = default;
+
+    soa_vector(const soa_vector& other)
+    {
+        reserve(other.size_);
+        copy_columns(other, other.size_);
+        size_ = other.size_;
+    }
+
+    soa_vector(soa_vector&& other) noexcept
+        : block_(std::exchange(other.block_, nullptr)),
+          columns_(std::exchange(other.columns_, {})),
+          size_(std::exchange(other.size_, 0)),
+          capacity_(std::exchange(other.capacity_, 0)) {}
+
+    soa_vector& operator=(soa_vector other) noexcept
+    {
+        std::swap(block_, other.block_);
+        std::swap(columns_, other.columns_);
+        std::swap(size_, other.size_);
+        std::swap(capacity_, other.capacity_);
+        return *this;
+    }
+
+    ~soa_vector()
+    {
+        if (block_) {
+            ::operator delete(block_, std::align_val_t{column_alignment});
+        }
+    }
+
+    std::size_t size() const noexcept { return size_; }
+    std::size_t capacity() const noexcept { return capacity_; }
+    bool empty() const noexcept { return size_ == 0; }
+
+    void reserve(std::size_t n)
+    {
+        if (n <= capacity_) {
+            return;
+        }
+        soa_vector grown;
+        grown.allocate(n);
+        grown.copy_columns(*this, size_);
+        grown.size_ = size_;
+        *this = std::move(grown);
+    }
+
+    // New elements are zero-filled
+    void resize(std::size_t n)
+    {
+        if (n > capacity_) {
+            reserve(n);
+        }
+        if (n > size_) {
+            for (std::size_t i = 0; i < N; ++i) {
+                std::memset(columns_[i] + size_ * sizes[i], 0, (n - size_) * sizes[i]);
+            }
+        }
+        size_ = n;
+    }
+
+    void clear() noexcept { size_ = 0; }
+
+    void push_back(const T& value)
+    {
+        if (size_ == capacity_) {
+            reserve(capacity_ ? 2 * capacity_ : 16);
+        }
+        ++size_;
+        set(size_ - 1, value);
+    }
+
+    void pop_back() noexcept { --size_; }
+
+    // Gathers element i into a T
+    T get(std::size_t i) const
+    {
+        T out{};
+        template for (constexpr auto m : members) {
+            using member_type = [: std::meta::type_of(m) :];
+            const member_type& src = column<m>()[i];
+            if constexpr (std::is_array_v<member_type>) {
+                std::memcpy(&out.[:m:], &src, sizeof(member_type));
+            } else {
+                out.[:m:] = src;
+            }
+        }
+        return out;
+    }
+
+    // Scatters value into the columns at i
+    void set(std::size_t i, const T& value)
+    {
+        template for (constexpr auto m : members) {
+            using member_type = [: std::meta::type_of(m) :];
+            member_type& dst = column<m>()[i];
+            if constexpr (std::is_array_v<member_type>) {
+                std::memcpy(&dst, &value.[:m:], sizeof(member_type));
+            } else {
+                dst = value.[:m:];
+            }
+        }
+    }
+
+    reference operator[](std::size_t i) noexcept
+    {
+        return make_proxy<reference>(*this, i, std::make_index_sequence<N>{});
+    }
+
+    const_reference operator[](std::size_t i) const noexcept
+    {
+        return make_proxy<const_reference>(*this, i, std::make_index_sequence<N>{});
+    }
+
+    iterator begin() noexcept { return { this, 0 }; }
+    iterator end() noexcept { return { this, size_ }; }
+    const_iterator begin() const noexcept { return { this, 0 }; }
+    const_iterator end() const noexcept { return { this, size_ }; }
+
+    // The column of member M, e.g. column<^^T::rssi>(). The data is aligned
+    // to column_alignment.
+    template <std::meta::info M>
+    std::span<[: std::meta::type_of(M) :]> column() noexcept
+    {
+        static_assert(std::meta::parent_of(M) == ^^T, "refl::soa_vector: not a member of T");
+        constexpr std::size_t i = detail::member_index<M>();
+        using member_type = [: std::meta::type_of(M) :];
+        return { std::launder(reinterpret_cast<member_type*>(columns_[i])), size_ };
+    }
+
+    template <std::meta::info M>
+    std::span<const [: std::meta::type_of(M) :]> column() const noexcept
+    {
+        static_assert(std::meta::parent_of(M) == ^^T, "refl::soa_vector: not a member of T");
+        constexpr std::size_t i = detail::member_index<M>();
+        using member_type = [: std::meta::type_of(M) :];
+        return { std::launder(reinterpret_cast<const member_type*>(columns_[i])), size_ };
+    }
+
+private:
+    static_assert(N > 0, "refl::soa_vector: T has no members");
+
+    static constexpr bool trivial_members = [] {
+        bool ok = true;
+        for (std::meta::info m : members) {
+            ok = ok && std::meta::is_trivially_copyable_type(std::meta::type_of(m));
+        }
+        return ok;
+    }();
+    static_assert(trivial_members, "refl::soa_vector: members must be trivially copyable");
+
+    static constexpr std::size_t round_up(std::size_t n)
+    {
+        return (n + column_alignment - 1) & ~(column_alignment - 1);
+    }
+
+    template <typename Proxy, typename Self, std::size_t... I>
+    static Proxy make_proxy(Self& self, std::size_t i, std::index_sequence<I...>)
+    {
+        return Proxy{ self.template column<members[I]>()[i]... };
+    }
+
+    void allocate(std::size_t n)
+    {
+        std::size_t bytes = 0;
+        for (std::size_t i = 0; i < N; ++i) {
+            bytes += round_up(sizes[i] * n);
+        }
+        block_ = static_cast<std::byte*>(::operator new(bytes, std::align_val_t{column_alignment}));
+        std::byte* p = block_;
+        for (std::size_t i = 0; i < N; ++i) {
+            columns_[i] = p;
+            p += round_up(sizes[i] * n);
+        }
+        capacity_ = n;
+    }
+
+    void copy_columns(const soa_vector& from, std::size_t n)
+    {
+        if (n == 0) {
+            return;
+        }
+        for (std::size_t i = 0; i < N; ++i) {
+            std::memcpy(columns_[i], from.columns_[i], n * sizes[i]);
+        }
+    }
+
+    std::byte* block_ = nullptr;
+    std::array<std::byte*, N> columns_{};
+    std::size_t size_ = 0;
+    std::size_t capacity_ = 0;
+};
+
+} // namespace refl
@@ -7,12 +7,19 @@
    CONDITIONS OF ANY KIND, either express or implied.
 */
 #include <meta>
+#include <array>
+#include <bit>
+#include <span>
+
+#include <string.h>
+#include <inttypes.h>
+#include "sdkconfig.h"
+#if CONFIG_ESP_STATION_EXAMPLE_IOSTREAM_FORMAT
 #include <iostream>
 #include <sstream>
 #include <string>
 #include <iomanip>
-
-#include <string.h>
+#endif
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/event_groups.h"
@@ -20,11 +27,19 @@
 #include "esp_wifi.h"
 #include "esp_event.h"
 #include "esp_log.h"
+#include "esp_cpu.h"
 #include "nvs_flash.h"
 
 #include "lwip/err.h"
 #include "lwip/sys.h"
 
+#include "refl_diff.hpp"
+#include "refl_format.hpp"
+#include "refl_json.hpp"
+#include "refl_serialize.hpp"
+
+#if CONFIG_ESP_STATION_EXAMPLE_IOSTREAM_FORMAT
+/* iostream formatter, kept to compare flash size and cycles with refl::to_text() */
 template <std::size_t N>
 void append_uint8_array(std::ostringstream &os, const uint8_t (&arr)[N])
 {
@@ -73,6 +88,7 @@ std::string to_string(const T& obj) {
     os << " }";
     return os.str();
 }
+#endif
 
 
 
@@ -149,6 +165,91 @@ static void event_handler(void* arg, esp_event_base_t event_base,
     }
 }
 
+/* A delta in which only a field of a nested struct changed must carry that
+   struct and restore it exactly, leaving the following members intact */
+static bool check_nested_delta(const wifi_sta_config_t& sta)
+{
+    wifi_sta_config_t changed = sta;
+    changed.threshold.rssi = static_cast<int8_t>(sta.threshold.rssi - 10);
+    auto mask = refl::diff(sta, changed);
+    if (std::popcount(mask) != 1) {
+        return false;
+    }
+    static std::array<uint8_t, refl::max_encoded_size<wifi_sta_config_t>() + 12> delta;
+    auto size = refl::encode_delta(sta, changed, delta);
+    if (!size) {
+        return false;
+    }
+    wifi_sta_config_t patched = sta;
+    auto applied = refl::apply_delta(patched, std::span(delta.data(), *size));
+    return applied && *applied == mask && refl::diff(patched, changed) == 0;
+}
+
+/* Stores the station config in NVS using the reflection-driven encoding.
+   Zero members are not written, so the blob is much smaller than the struct.
+   The scratch buffers (about 1.5 KB) are static so they stay off the main
+   task stack; this runs once, from wifi_init_sta(). */
+static void store_sta_config(const wifi_sta_config_t& sta)
+{
+    static std::array<uint8_t, refl::max_encoded_size<wifi_sta_config_t>()> blob;
+    auto size = refl::serialize(sta, blob);
+    if (!size) {
+        ESP_LOGE(TAG, "failed to encode wifi_sta_config_t");
+        return;
+    }
+    ESP_LOGI(TAG, "wifi_sta_config_t: %u bytes encoded, %u bytes in memory",
+             (unsigned)*size, (unsigned)sizeof(sta));
+
+    /* Round trip: decoding and encoding again must give the same bytes */
+    static std::array<uint8_t, refl::max_encoded_size<wifi_sta_config_t>()> check;
+    auto decoded = refl::deserialize<wifi_sta_config_t>(std::span(blob.data(), *size));
+    if (!decoded) {
+        ESP_LOGE(TAG, "failed to decode wifi_sta_config_t");
+        return;
+    }
+    auto check_size = refl::serialize(*decoded, check);
+    if (!check_size || *check_size != *size || memcmp(blob.data(), check.data(), *size) != 0) {
+        ESP_LOGE(TAG, "wifi_sta_config_t round trip mismatch");
+        return;
+    }
+
+    if (!check_nested_delta(sta)) {
+        ESP_LOGE(TAG, "wifi_sta_config_t nested struct delta mismatch");
+    }
+
+    nvs_handle_t nvs;
+    ESP_ERROR_CHECK(nvs_open("wifi_refl", NVS_READWRITE, &nvs));
+
+    /* Only rewrite the blob if a member changed since the last boot */
+    static std::array<uint8_t, refl::max_encoded_size<wifi_sta_config_t>()> stored_blob;
+    size_t stored_size = stored_blob.size();
+    if (nvs_get_blob(nvs, "sta", stored_blob.data(), &stored_size) == ESP_OK) {
+        auto stored = refl::deserialize<wifi_sta_config_t>(std::span(stored_blob.data(), stored_size));
+        if (stored) {
+            static std::array<uint8_t, refl::max_encoded_size<wifi_sta_config_t>() + 12> delta;
+            auto mask = refl::diff(*stored, sta);
+            auto delta_size = refl::encode_delta(*stored, sta, delta);
+            ESP_LOGI(TAG, "wifi_sta_config_t: %d members changed, delta %u bytes",
+                     std::popcount(mask), delta_size ? (unsigned)*delta_size : 0u);
+
+            /* The delta must turn the stored config into the current one */
+            wifi_sta_config_t patched = *stored;
+            if (!delta_size ||
+                !refl::apply_delta(patched, std::span(delta.data(), *delta_size)) ||
+                refl::diff(patched, sta) != 0) {
+                ESP_LOGE(TAG, "wifi_sta_config_t delta round trip mismatch");
+            }
+            if (mask == 0) {
+                nvs_close(nvs);
+                return;
+            }
+        }
+    }
+    ESP_ERROR_CHECK(nvs_set_blob(nvs, "sta", blob.data(), *size));
+    ESP_ERROR_CHECK(nvs_commit(nvs));
+    nvs_close(nvs);
+}
+
 void wifi_init_sta(void)
 {
     s_wifi_event_group = xEventGroupCreate();
@@ -189,7 +290,42 @@ void wifi_init_sta(void)
     ESP_ERROR_CHECK(esp_wifi_start() );
 
     ESP_LOGI(TAG, "wifi_init_sta finished.");
-    std::cout << to_string(wifi_config.sta) << std::endl;
+    uint32_t start = esp_cpu_get_cycle_count();
+#if CONFIG_ESP_STATION_EXAMPLE_IOSTREAM_FORMAT
+    std::string text = to_string(wifi_config.sta);
+    uint32_t cycles = esp_cpu_get_cycle_count() - start;
+    std::cout << text << std::endl;
+#else
+    /* Sized for any wifi_sta_config_t; static to keep it off the main task stack */
+    static char text[refl::max_text_size<wifi_sta_config_t>()];
+    refl::format_result res = refl::to_text(wifi_config.sta, text);
+    uint32_t cycles = esp_cpu_get_cycle_count() - start;
+    if (res.truncated) {
+        ESP_LOGE(TAG, "wifi_sta_config_t text truncated at %u bytes", (unsigned)res.size);
+    }
+    ESP_LOGI(TAG, "%s", text);
+    static char json[refl::max_json_size<wifi_sta_config_t>()];
+    refl::format_result json_res = refl::to_json(wifi_config.sta, json);
+    if (json_res.truncated) {
+        ESP_LOGE(TAG, "wifi_sta_config_t JSON truncated at %u bytes", (unsigned)json_res.size);
+    } else {
+        ESP_LOGI(TAG, "%s", json);
+
+        /* Bind the JSON back: every member must be found and equal */
+        wifi_sta_config_t parsed = {};
+        uint32_t parse_start = esp_cpu_get_cycle_count();
+        refl::parse_result parsed_res = refl::parse_into(std::string_view(json, json_res.size), parsed);
+        uint32_t parse_cycles = esp_cpu_get_cycle_count() - parse_start;
+        if (!parsed_res.ok || parsed_res.invalid || parsed_res.missing || parsed_res.unknown ||
+            refl::diff(parsed, wifi_config.sta) != 0) {
+            ESP_LOGE(TAG, "wifi_sta_config_t JSON round trip mismatch");
+        } else {
+            ESP_LOGI(TAG, "wifi_sta_config_t parsed from JSON in %" PRIu32 " cycles", parse_cycles);
+        }
+    }
+#endif
+    ESP_LOGI(TAG, "wifi_sta_config_t formatted in %" PRIu32 " cycles", cycles);
+    store_sta_config(wifi_config.sta);
 
     /* Waiting until either the connection is established (WIFI_CONNECTED_BIT) or connection failed for the maximum
      * number of re-tries (WIFI_FAIL_BIT). The bits are set by event_handler() (see above) */